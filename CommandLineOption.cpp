@@ -0,0 +1,6 @@
+﻿// COMMAND_LINE_OPTION_EXTERN_TEMPLATEを定義して利用する場合に1度だけリンクする明示的インスタンス化の定義
+#include "CommandLineOption.hpp"
+
+#define COMMAND_LINE_OPTION_DEFINE_INSTANTIATE(T) COMMAND_LINE_OPTION_INSTANTIATE(, T)
+COMMAND_LINE_OPTION_VALUE_TYPES(COMMAND_LINE_OPTION_DEFINE_INSTANTIATE)
+#undef COMMAND_LINE_OPTION_DEFINE_INSTANTIATE
@@ -1,14 +1,45 @@
 ﻿#pragma once
 
 #include <string>
+#include <array>
 #include <sstream>
 #include <vector>
 #include <algorithm>
 #include <functional>
 #include <memory>
-#include <format>
+#include <cstdint>
+#include <limits>
+#include <string_view>
+#include <type_traits>
+#include <mutex>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <cmath>
+#include <charconv>
+#include <bit>
+#include <span>
+#include <cctype>
+#include <clocale>
 
-namespace option {
+// モジュール(CommandLineOption.ixx)から取り込むときはexportに置き換えられる
+#ifndef COMMAND_LINE_OPTION_EXPORT
+#define COMMAND_LINE_OPTION_EXPORT
+#endif
+
+// 型名を宣言する引数の型の一覧(Xには型を受け取るマクロを指定する)
+#define COMMAND_LINE_OPTION_VALUE_TYPES(X)\
+    X(std::string)\
+    X(int)\
+    X(long)\
+    X(long long)\
+    X(unsigned long long)\
+    X(float)\
+    X(double)\
+    X(long double)
+
+COMMAND_LINE_OPTION_EXPORT namespace option {
 
     /// <summary>
     /// 型名を示す文字列を取得するためのメタ関数
@@ -16,581 +47,772 @@ namespace option {
     template <class T> struct type_name { static constexpr std::string_view value = "Unknwon"; };
 #define DECLARE_TYPE_NAME(name)\
     template <> struct type_name<name> { static constexpr std::string_view value = #name; };
-    DECLARE_TYPE_NAME(std::string)
-    DECLARE_TYPE_NAME(int)
-    DECLARE_TYPE_NAME(long)
-    DECLARE_TYPE_NAME(long long)
-    DECLARE_TYPE_NAME(unsigned long long)
-    DECLARE_TYPE_NAME(float)
-    DECLARE_TYPE_NAME(double)
-    DECLARE_TYPE_NAME(long double)
+    COMMAND_LINE_OPTION_VALUE_TYPES(DECLARE_TYPE_NAME)
 #undef DECLARE_TYPE_NAME
 
     /// <summary>
-    /// optionなどの基底
+    /// 型の番号(COMMAND_LINE_OPTION_VALUE_TYPESに列挙した順であり、それ以外の型は0xFF)
     /// </summary>
-    class OptionBase {
-    protected:
+    template <class T>
+    constexpr std::uint8_t value_type_id() noexcept {
+#define DECLARE_TYPE_ID(name) std::is_same_v<T, name>,
+        constexpr bool matches[] = { COMMAND_LINE_OPTION_VALUE_TYPES(DECLARE_TYPE_ID) };
+#undef DECLARE_TYPE_ID
+        for (std::size_t i = 0; i < std::size(matches); ++i) {
+            if (matches[i]) return static_cast<std::uint8_t>(i);
+        }
+        return 0xFF;
+    }
+
+    /// <summary>
+    /// 複製せずに保持する文字列
+    /// </summary>
+    /// <remarks>
+    /// 文字列はプロセス全体で共有するプールに1度だけ複製して参照する。
+    /// literalで構築した定数式の文字列のみは静的記憶域にあることが保証されるため複製せずにそのまま参照する
+    /// </remarks>
+    class InternedString {
         /// <summary>
-        /// オプション名
+        /// 参照する文字列
         /// </summary>
-        std::string _name;
+        std::string_view _view;
+
         /// <summary>
-        /// オプションの説明
+        /// 参照先の寿命が保証された文字列からの構築
         /// </summary>
-        std::string _description;
+        struct stable_tag {};
+        constexpr InternedString(std::string_view view, stable_tag) noexcept : _view(view) {}
+
         /// <summary>
-        /// オプションが利用されているときにtrue
+        /// 格納した文字列の領域と索引
         /// </summary>
-        bool _use = false;
+        class Pool {
+            /// <summary>
+            /// ブロックの大きさ(これの1/4を超える文字列は専用のブロックに置く)
+            /// </summary>
+            static constexpr std::size_t block_size = 4096;
 
-    public:
-        OptionBase() = delete;
-        OptionBase(const std::string& name, const std::string& description) : _name(name), _description(description) {
-            if (name[0] == '-') {
-                throw std::invalid_argument("option名の1文字目は'-'にすることはできません");
+            std::vector<std::unique_ptr<char[]>> _blocks;
+            char* _cursor = nullptr;
+            std::size_t _left = 0;
+            /// <summary>
+            /// 格納した文字列のハッシュ表(空きはdataがnullptr、大きさは2の冪)
+            /// </summary>
+            std::vector<std::string_view> _slots;
+            std::size_t _size = 0;
+
+            std::size_t slot_of(std::string_view str) const noexcept {
+                const std::size_t mask = this->_slots.size() - 1;
+                for (std::size_t i = std::hash<std::string_view>{}(str) & mask;; i = (i + 1) & mask) {
+                    if (this->_slots[i].data() == nullptr || this->_slots[i] == str) return i;
+                }
             }
-            if (name.find('=') != std::string::npos) {
-                throw std::invalid_argument("optionに等号を含めることはできません");
+
+            /// <summary>
+            /// 文字列を複製する領域の確保
+            /// </summary>
+            char* allocate(std::size_t size) {
+                if (size > block_size / 4) {
+                    return this->_blocks.emplace_back(new char[size]).get();
+                }
+                if (size > this->_left) {
+                    this->_cursor = this->_blocks.emplace_back(new char[block_size]).get();
+                    this->_left = block_size;
+                }
+                char* p = this->_cursor;
+                this->_cursor += size;
+                this->_left -= size;
+                return p;
             }
-            if (name.find(' ') != std::string::npos) {
-                throw std::invalid_argument("optionに空白スペースを含めることはできません");
+
+        public:
+            std::string_view intern(std::string_view str) {
+                if ((this->_size + 1) * 2 > this->_slots.size()) {
+                    std::vector<std::string_view> slots(std::max<std::size_t>(64, this->_slots.size() * 2));
+                    std::swap(this->_slots, slots);
+                    for (auto s : slots) {
+                        if (s.data() != nullptr) this->_slots[this->slot_of(s)] = s;
+                    }
+                }
+                auto& slot = this->_slots[this->slot_of(str)];
+                if (slot.data() == nullptr) {
+                    // ブロックを登録できずに解放されないことが無いよう、一覧を先に伸長しておく
+                    if (this->_blocks.size() == this->_blocks.capacity()) this->_blocks.reserve(std::max<std::size_t>(8, this->_blocks.size() * 2));
+                    // 空の文字列もdataがnullptrとならないよう1バイトを確保する
+                    char* p = this->allocate(std::max<std::size_t>(str.size(), 1));
+                    if (!str.empty()) std::memcpy(p, str.data(), str.size());
+                    slot = std::string_view(p, str.size());
+                    ++this->_size;
+                }
+                return slot;
             }
+        };
+
+    public:
+        constexpr InternedString() noexcept {}
+        template <class S, typename std::enable_if<std::is_convertible_v<S, std::string_view> && !std::is_same_v<std::remove_cvref_t<S>, InternedString>, std::nullptr_t>::type = nullptr>
+        InternedString(S&& str) : _view(intern(std::string_view(str))) {}
+
+        /// <summary>
+        /// 定数式の文字列を複製せずに参照する
+        /// </summary>
+        /// <param name="str">静的記憶域にあるナル終端文字列</param>
+        /// <returns></returns>
+        /// <remarks>
+        /// 定数式として評価されるため自動変数の配列を指定するとコンパイルエラーとなり、長さは最初のナル文字までとなる
+        /// </remarks>
+        static consteval InternedString literal(const char* str) {
+            return InternedString(std::string_view(str, std::char_traits<char>::length(str)), stable_tag{});
         }
-        virtual ~OptionBase() {}
 
         /// <summary>
-        /// クローンを作成する
+        /// 文字列をプールに格納する
         /// </summary>
-        /// <returns>クローン</returns>
-        virtual OptionBase* clone() const = 0;
+        /// <param name="str">格納する文字列</param>
+        /// <returns>プール内の文字列(プロセスの終了まで有効)</returns>
+        /// <remarks>
+        /// 文字列は固定長のブロックへ詰めて置き、索引はオープンアドレス法のハッシュ表とするため、
+        /// 文字列ごとの確保は行わずブロックと索引を伸長するときのみ確保する
+        /// </remarks>
+        static std::string_view intern(std::string_view str) {
+            static std::mutex mutex;
+            static Pool pool;
+
+            std::lock_guard<std::mutex> lock(mutex);
+            return pool.intern(str);
+        }
 
         /// <summary>
-        /// コマンドライン引数のオプションを解析する
+        /// 部分文字列の取得(参照先は複製しない)
         /// </summary>
-        /// <param name="offset">コマンドライン引数のオフセット</param>
-        /// <param name="argc">コマンドライン引数の数</param>
-        /// <param name="argv">コマンドライン引数を示す配列</param>
-        /// <returns>解析を実行したときにtrue</returns>
-        virtual bool parse(int& offset, int& argc, const char* argv[]) = 0;
+        /// <param name="pos">開始位置</param>
+        /// <param name="n">文字数</param>
+        /// <returns></returns>
+        constexpr InternedString substr(std::size_t pos, std::size_t n = std::string_view::npos) const {
+            return InternedString(this->_view.substr(pos, n), stable_tag{});
+        }
 
         /// <summary>
-        /// オプション名の取得
+        /// 文字列の取得
         /// </summary>
-        /// <returns>オプション名</returns>
-        const std::string& name() const noexcept { return this->_name; }
+        /// <returns></returns>
+        constexpr std::string_view view() const noexcept { return this->_view; }
+        constexpr operator std::string_view() const noexcept { return this->_view; }
+    };
 
+    /// <summary>
+    /// メッセージの書式に引数を埋め込む
+    /// </summary>
+    /// <remarks>
+    /// 置換フィールドは位置の自動採番の{}と引数の番号を指定する{n}のみであり、書式指定は扱わない。
+    /// &lt;format&gt;を読み込まないことで、このヘッダのみを用いる翻訳単位の構築時間を抑える
+    /// </remarks>
+    class MessageFormat {
+    public:
         /// <summary>
-        /// 接頭辞付きのオプション名の取得
+        /// 引数を文字列に変換する
         /// </summary>
-        /// <returns>接頭辞付きのオプション名</returns>
-        virtual std::string full_name() const { return this->name(); }
+        /// <typeparam name="T">引数の型</typeparam>
+        /// <param name="x">引数</param>
+        /// <returns>std::formatの{}と同じ表記の文字列</returns>
+        template <class T>
+        static std::string to_string(const T& x) {
+            if constexpr (std::is_same_v<T, bool>) return x ? "true" : "false";
+            else if constexpr (std::is_same_v<T, char>) return std::string(1, x);
+            else if constexpr (std::is_convertible_v<const T&, std::string_view>) return std::string(std::string_view(x));
+            else if constexpr (std::is_arithmetic_v<T>) {
+                char buf[64];
+                const auto [ptr, ec] = std::to_chars(buf, buf + sizeof(buf), x);
+                return std::string(buf, ec == std::errc() ? ptr : buf);
+            }
+            else {
+                std::ostringstream ss;
+                ss << x;
+                return std::move(ss).str();
+            }
+        }
 
         /// <summary>
-        /// メモリの確保なしにオプション名がマッチするかの判定
+        /// 書式の置換フィールドを文字列に置き換える
         /// </summary>
-        /// <returns>接頭辞付きのオプション名</returns>
-        virtual bool match_name(std::string_view str) const { return this->_name == str; }
+        /// <param name="out">出力先</param>
+        /// <param name="fmt">書式</param>
+        /// <param name="args">文字列に変換済みの引数</param>
+        /// <returns>書式が正しいときにtrue(falseのときoutは不定)</returns>
+        static bool substitute(std::string& out, std::string_view fmt, std::span<const std::string> args) {
+            // 自動採番と番号の指定は混在させない
+            enum class NUMBERING { NONE, AUTO, MANUAL } numbering = NUMBERING::NONE;
+            std::size_t next = 0;
+            out.clear();
+            out.reserve(fmt.size());
+            for (std::size_t i = 0; i < fmt.size(); ++i) {
+                const char c = fmt[i];
+                if (c == '}') {
+                    if (i + 1 >= fmt.size() || fmt[i + 1] != '}') return false;
+                    out.push_back('}');
+                    ++i;
+                    continue;
+                }
+                if (c != '{') {
+                    out.push_back(c);
+                    continue;
+                }
+                if (i + 1 < fmt.size() && fmt[i + 1] == '{') {
+                    out.push_back('{');
+                    ++i;
+                    continue;
+                }
+                const auto close = fmt.find('}', i + 1);
+                if (close == std::string_view::npos) return false;
+                const auto field = fmt.substr(i + 1, close - i - 1);
+                std::size_t index = 0;
+                if (field.empty()) {
+                    if (numbering == NUMBERING::MANUAL) return false;
+                    numbering = NUMBERING::AUTO;
+                    index = next++;
+                }
+                else {
+                    if (numbering == NUMBERING::AUTO) return false;
+                    numbering = NUMBERING::MANUAL;
+                    const auto [ptr, ec] = std::from_chars(field.data(), field.data() + field.size(), index);
+                    if (ec != std::errc() || ptr != field.data() + field.size()) return false;
+                }
+                if (index >= args.size()) return false;
+                out.append(args[index]);
+                i = close;
+            }
+            return true;
+        }
 
         /// <summary>
-        /// オプションの説明の取得
+        /// 書式に引数を埋め込んだ文字列を構築する
         /// </summary>
-        /// <returns>オプションの説明</returns>
-        const std::string& description() const noexcept { return this->_description; }
+        /// <param name="fmt">書式</param>
+        /// <param name="args">引数</param>
+        /// <returns>書式が不正なときは書式そのもの</returns>
+        template <class... Args>
+        static std::string format(std::string_view fmt, const Args&... args) {
+            const std::array<std::string, sizeof...(Args)> strs = { to_string(args)... };
+            std::string result;
+            if (!substitute(result, fmt, strs)) result.assign(fmt);
+            return result;
+        }
+    };
 
+    /// <summary>
+    /// optionの説明とエラーメッセージの書式を保持するカタログ
+    /// </summary>
+    /// <remarks>
+    /// 説明としてキーを指定しておけば説明を表示するときにカタログの文字列に置き換えられるため、
+    /// 説明の文字列そのものを常駐させる必要がない。
+    /// ファイルから読み込むカタログはCommandLineOptionCatalog.hppのFileDescriptionCatalogである
+    /// </remarks>
+    class DescriptionCatalog {
         /// <summary>
-        /// オプション名についての説明
+        /// プロセス全体で用いるカタログ
         /// </summary>
         /// <returns></returns>
-        virtual std::string name_description() const { return this->full_name(); }
+        static std::shared_ptr<DescriptionCatalog>& global(std::unique_lock<std::mutex>& lock) {
+            static std::mutex mutex;
+            static std::shared_ptr<DescriptionCatalog> catalog;
+            lock = std::unique_lock<std::mutex>(mutex);
+            return catalog;
+        }
+
+    public:
+        virtual ~DescriptionCatalog() {}
 
         /// <summary>
-        /// オプションが利用されているかの取得
+        /// キーに対応する文字列を取得する
         /// </summary>
-        /// <returns></returns>
-        bool use() const noexcept { return this->_use; }
+        /// <param name="key">キー</param>
+        /// <param name="fallback">該当しないときの文字列</param>
+        /// <returns>カタログ内の文字列(カタログの破棄まで有効)</returns>
+        virtual std::string_view find(std::string_view key, std::string_view fallback) = 0;
 
         /// <summary>
-        /// コマンドライン解析前の状態へ初期化
+        /// プロセス全体で用いるカタログを設定する
         /// </summary>
-        virtual void init() {}
+        /// <param name="catalog">カタログ(nullptrのときはカタログを用いない)</param>
+        static void use(std::shared_ptr<DescriptionCatalog> catalog) {
+            std::unique_lock<std::mutex> lock;
+            global(lock) = std::move(catalog);
+        }
 
         /// <summary>
-        /// 与えられた引数のチェック
+        /// プロセス全体で用いるカタログを取得する
         /// </summary>
-        virtual void validate() {}
+        /// <returns></returns>
+        static std::shared_ptr<DescriptionCatalog> current() {
+            std::unique_lock<std::mutex> lock;
+            return global(lock);
+        }
 
         /// <summary>
-        /// 引数がハイフンのみで構成されるかの判定
+        /// カタログの書式によりメッセージを構築する
         /// </summary>
-        /// <param name="str">判定対象の文字列</param>
+        /// <param name="key">書式のキー</param>
+        /// <param name="fmt">カタログに該当する書式がないもしくは書式が不正なときの書式</param>
+        /// <param name="args">書式の引数</param>
         /// <returns></returns>
-        static constexpr bool is_dash(const char* str) noexcept {
-            if (str == nullptr) return false;
-            for (const char* str2 = str; *str2 != '\0'; ++str2) {
-                if (*str2 != '-') {
-                    return false;
-                }
-            }
-            return *str != '\0';
+        template <class... Args>
+        static std::string message(std::string_view key, std::string_view fmt, const Args&... args) {
+            const std::array<std::string, sizeof...(Args)> strs = { MessageFormat::to_string(args)... };
+            std::string result;
+            if (auto catalog = current(); catalog && MessageFormat::substitute(result, catalog->find(key, fmt), strs)) return result;
+            if (!MessageFormat::substitute(result, fmt, strs)) result.assign(fmt);
+            return result;
         }
     };
 
     /// <summary>
-    /// 引数付きoptionもしくはlong optionの基底
+    /// 解析結果やoptionの定義をJSONの構造として受け取る出力先
     /// </summary>
-    class OptionHasValueBase {
-    public:
-        /// <summary>
-         /// optionの入力パターン
-         /// </summary>
-        struct ARG_PATTERN {
-            /// <summary>
-            /// なし
-            /// </summary>
-            static constexpr std::size_t NONE = 0;
-            /// <summary>
-            /// --a=1のような等号による引数から記述が始まることを示すフラグ
-            /// </summary>
-            static constexpr std::size_t ASSIGN = 0b1;
-            /// <summary>
-            /// --a 1のようなスペースによる引数から記述が始まることを示すフラグ
-            /// </summary>
-            static constexpr std::size_t SPACE = 0b10;
-        };
+    /// <remarks>
+    /// 各optionはこのクラスの操作のみで自身を出力する。文字列への書き込みはCommandLineOptionJson.hppのJsonWriterである
+    /// </remarks>
+    class JsonSink {
     protected:
+        virtual void write_null() = 0;
+        virtual void write_bool(bool x) = 0;
+        virtual void write_integer(long long x) = 0;
+        virtual void write_unsigned(unsigned long long x) = 0;
+        virtual void write_number(float x) = 0;
+        virtual void write_number(double x) = 0;
+        virtual void write_number(long double x) = 0;
+        virtual void write_string(std::string_view str) = 0;
+
+    public:
+        virtual ~JsonSink() {}
+
+        virtual JsonSink& begin_object() = 0;
+        virtual JsonSink& end_object() = 0;
+        virtual JsonSink& begin_array() = 0;
+        virtual JsonSink& end_array() = 0;
+
         /// <summary>
-         /// 引数の記載パターン
-         /// </summary>
-        std::size_t _arg_pattern = ARG_PATTERN::NONE;
+        /// オブジェクトのキーを出力する
+        /// </summary>
+        /// <param name="k">キー</param>
+        /// <returns></returns>
+        virtual JsonSink& key(std::string_view k) = 0;
 
         /// <summary>
-        /// 引数の記載パターンに関する説明の取得
+        /// 値を出力する(数値と文字列以外の型はストリームによる文字列表現を文字列として出力する)
         /// </summary>
+        /// <param name="x">出力する値</param>
         /// <returns></returns>
-        std::string arg_pattern_description() const {
-            switch (this->_arg_pattern) {
-            case ARG_PATTERN::NONE:
-                return "";
-            case ARG_PATTERN::ASSIGN:
-                return "=";
-            case ARG_PATTERN::SPACE:
-                return " ";
-            default:
-                if (this->_arg_pattern == (ARG_PATTERN::SPACE | ARG_PATTERN::ASSIGN)) {
-                    return "[ |=]";
-                }
+        template <class T>
+        JsonSink& value(const T& x) {
+            if constexpr (std::is_same_v<T, bool>) {
+                this->write_bool(x);
             }
-            throw std::logic_error("ここに来ることはない");
+            else if constexpr (std::is_same_v<T, std::nullptr_t>) {
+                this->write_null();
+            }
+            else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+                this->write_integer(x);
+            }
+            else if constexpr (std::is_integral_v<T>) {
+                this->write_unsigned(x);
+            }
+            else if constexpr (std::is_floating_point_v<T>) {
+                this->write_number(x);
+            }
+            else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+                this->write_string(std::string_view(x));
+            }
+            else {
+                std::ostringstream stream;
+                stream << x;
+                this->write_string(stream.str());
+            }
+            return *this;
         }
 
-    public:
-        OptionHasValueBase(std::size_t arg_pattern) : _arg_pattern(arg_pattern) {}
-
         /// <summary>
-        /// 引数の入力パターン
+        /// オブジェクトのメンバを出力する
         /// </summary>
+        /// <param name="k">キー</param>
+        /// <param name="x">値</param>
         /// <returns></returns>
-        std::size_t arg_pattern() const noexcept { return this->_arg_pattern; }
+        template <class T>
+        JsonSink& member(std::string_view k, const T& x) {
+            this->key(k);
+            return this->value(x);
+        }
     };
 
+    // CommandLineOptionJson.hppで定義する
+    class JsonWriter;
+
     /// <summary>
-    /// option
+    /// 検証済みのoption名
     /// </summary>
-    class Option : public OptionBase {
-    public:
-        using OptionBase::OptionBase;
-        virtual ~Option() {}
-
+    /// <remarks>
+    /// 文字列からの構築は実行時に検証され、不正な名前はstd::invalid_argumentを投げる。
+    /// literalによる構築はコンパイル時に検証され、不正な名前はコンパイルエラーとなる
+    /// </remarks>
+    class OptionName {
+        friend class LongOptionName;
         /// <summary>
-        /// クローンを作成する
+        /// option名
         /// </summary>
-        /// <returns>クローン</returns>
-        virtual OptionBase* clone() const { return new Option(*this); }
+        InternedString _name;
 
         /// <summary>
-        /// コマンドライン引数のオプションを解析する
+        /// 検証済みの名前からの構築
         /// </summary>
-        /// <param name="offset">コマンドライン引数のオフセット</param>
-        /// <param name="argc">コマンドライン引数の数</param>
-        /// <param name="argv">コマンドライン引数を示す配列</param>
-        /// <returns>解析を実行したときにtrue</returns>
-        virtual bool parse(int& offset, int& argc, const char* argv[]) {
-            if (this->match_name(argv[offset])) {
-                this->_use = true;
-                ++offset;
-                return true;
-            }
-            return false;
-        }
+        struct validated_tag {};
+        constexpr OptionName(InternedString name, validated_tag) noexcept : _name(name) {}
+
+    public:
+        template <class S, typename std::enable_if<std::is_convertible_v<S, std::string_view> && !std::is_same_v<std::remove_cvref_t<S>, OptionName>, std::nullptr_t>::type = nullptr>
+        OptionName(S&& name) : _name(check(std::string_view(name))) {}
 
         /// <summary>
-        /// 接頭辞付きのオプション名の取得
+        /// 定数式の名前をコンパイル時に検証し、複製せずに参照する
         /// </summary>
-        /// <returns>接頭辞付きのオプション名</returns>
-        virtual std::string full_name() const { return "-" + this->name(); }
+        /// <param name="name">静的記憶域にあるナル終端文字列</param>
+        /// <returns></returns>
+        static consteval OptionName literal(const char* name) {
+            const auto str = InternedString::literal(name);
+            check(str);
+            return OptionName(str, validated_tag{});
+        }
 
         /// <summary>
-        /// メモリの確保なしにオプション名がマッチするかの判定
+        /// option名として利用可能かの検証
         /// </summary>
-        /// <returns>接頭辞付きのオプション名</returns>
-        virtual bool match_name(std::string_view str) const {
-            return str.size() >= 2 && str[0] == '-' && this->_name == str.substr(1);
+        /// <param name="name">検証対象の名前</param>
+        /// <returns>検証対象の名前</returns>
+        static constexpr std::string_view check(std::string_view name) {
+            if (name.empty()) {
+                throw std::invalid_argument("option名を空にすることはできません");
+            }
+            if (name[0] == '-') {
+                throw std::invalid_argument("option名の1文字目は'-'にすることはできません");
+            }
+            if (name.find('=') != std::string_view::npos) {
+                throw std::invalid_argument("optionに等号を含めることはできません");
+            }
+            if (name.find(' ') != std::string_view::npos) {
+                throw std::invalid_argument("optionに空白スペースを含めることはできません");
+            }
+            return name;
         }
 
         /// <summary>
-        /// optionであることの判定
+        /// option名の取得
         /// </summary>
-        /// <param name="str">判定対象の文字列</param>
-        /// <returns>optionならtrue</returns>
-        static constexpr bool is_option(const char* str) {
-            if (str == nullptr) return false;
-            return *str == '-' && *(str + 1) != '-' && *(str + 1) != '\0';
-        }
+        /// <returns></returns>
+        constexpr const InternedString& str() const noexcept { return this->_name; }
     };
 
     /// <summary>
-    /// long option
+    /// optionの説明
     /// </summary>
-    class LongOption : public OptionBase {
-    public:
-        using OptionBase::OptionBase;
-        virtual ~LongOption() {}
-
+    /// <remarks>
+    /// 文字列からの構築はInternedStringのプールに複製する。literalによる構築は複製せずに定数式の文字列を参照する
+    /// </remarks>
+    class OptionDescription {
         /// <summary>
-        /// クローンを作成する
+        /// optionの説明
         /// </summary>
-        /// <returns>クローン</returns>
-        virtual OptionBase* clone() const { return new LongOption(*this); }
+        InternedString _description;
+
+    public:
+        template <class S, typename std::enable_if<std::is_convertible_v<S, std::string_view> && !std::is_same_v<std::remove_cvref_t<S>, InternedString> && !std::is_same_v<std::remove_cvref_t<S>, OptionDescription>, std::nullptr_t>::type = nullptr>
+        OptionDescription(S&& description) : _description(std::string_view(description)) {}
+        constexpr OptionDescription(InternedString description) noexcept : _description(description) {}
 
         /// <summary>
-        /// コマンドライン引数のオプションを解析する
+        /// 定数式の説明を複製せずに参照する
         /// </summary>
-        /// <param name="offset">コマンドライン引数のオフセット</param>
-        /// <param name="argc">コマンドライン引数の数</param>
-        /// <param name="argv">コマンドライン引数を示す配列</param>
-        /// <returns>解析を実行したときにtrue</returns>
-        virtual bool parse(int& offset, int& argc, const char* argv[]) {
-            if (this->match_name(argv[offset])) {
-                this->_use = true;
-                ++offset;
-                return true;
-            }
-            return false;
+        /// <param name="description">静的記憶域にあるナル終端文字列</param>
+        /// <returns></returns>
+        static consteval OptionDescription literal(const char* description) {
+            return OptionDescription(InternedString::literal(description));
         }
 
         /// <summary>
-        /// 接頭辞付きのオプション名の取得
+        /// optionの説明の取得
         /// </summary>
-        /// <returns>接頭辞付きのオプション名</returns>
-        virtual std::string full_name() const { return "--" + this->name(); }
+        /// <returns></returns>
+        constexpr const InternedString& str() const noexcept { return this->_description; }
+    };
 
+    /// <summary>
+    /// 解析を巻き戻すために記録するoptionの状態
+    /// </summary>
+    struct OptionMark {
         /// <summary>
-        /// メモリの確保なしにオプション名がマッチするかの判定
+        /// オプションが利用されているか
         /// </summary>
-        /// <returns>接頭辞付きのオプション名</returns>
-        virtual bool match_name(std::string_view str) const {
-            return str.size() >= 3 && str[0] == '-' && str[1] == '-' && this->_name == str.substr(2);
-        }
-
+        bool use = false;
         /// <summary>
-        /// long optionであることの判定
+        /// 引数の数
         /// </summary>
-        /// <param name="str">判定対象の文字列</param>
-        /// <returns>long optionならtrue</returns>
-        static constexpr bool is_long_option(const char* str) {
-            if (str == nullptr) return false;
-            return *str == '-' && *(str + 1) == '-' && *(str + 2) != '-' && *(str + 2) != '\0';
-        }
+        std::size_t values = 0;
+        /// <summary>
+        /// 計数optionの出現回数もしくは否定可能なoptionの真偽値
+        /// </summary>
+        std::uint64_t state = 0;
     };
 
+    class OptionBase;
+    class OptionValueBase;
+
     /// <summary>
-    /// optionに与える引数
+    /// optionの定義を定義順に項目ごとの配列として保持する表
     /// </summary>
-    /// <typeparam name="T">引数の型</typeparam>
-    template <class T>
-    class Value {
-        template <class U> friend class OptionValue;
+    /// <remarks>
+    /// option名、接頭辞、種類、引数の記載パターン、引数の数の上限、必須の件数、引数の型の番号はこの表のみが保持し、
+    /// optionのオブジェクトは表と定義順のインデックスからそれらを読む。validate、init、descriptionはこれらの項目を配列から読み、
+    /// オブジェクトは引数の値や別名などの項目を読むときにのみ参照する。
+    /// 名前はInternedStringのプールもしくはリテラルを参照して複製しないため、表の大きさは64ビット環境ではoptionあたり52バイトとなる
+    /// </remarks>
+    class SchemaTable {
+    public:
+        /// <summary>
+        /// optionの種類
+        /// </summary>
+        struct KIND {
+            // 引数を持たないoption
+            static constexpr std::uint8_t FLAG = 0;
+            // 計数option
+            static constexpr std::uint8_t COUNT = 1;
+            // 否定可能なoption
+            static constexpr std::uint8_t NEGATABLE = 2;
+            // 引数付きのoption
+            static constexpr std::uint8_t VALUE = 3;
+            // 名前なしオプション
+            static constexpr std::uint8_t UNNAMED = 4;
+        };
 
         /// <summary>
-        /// デフォルト引数
+        /// 上限のない件数
         /// </summary>
-        std::vector<T> _default_value;
+        static constexpr std::size_t UNLIMITED = std::numeric_limits<std::size_t>::max();
+
         /// <summary>
-        /// 引数の制約条件
+        /// 表の1行に置くoptionの定義
         /// </summary>
-        std::function<bool(T)> _constraint;
+        struct Row {
+            /// <summary>
+            /// 接頭辞を除いたoption名(名前なしオプションは空文字列)
+            /// </summary>
+            InternedString name;
+            /// <summary>
+            /// optionの種類(KIND)
+            /// </summary>
+            std::uint8_t kind = KIND::FLAG;
+            /// <summary>
+            /// 引数の記載パターン(OptionHasValueBase::ARG_PATTERN)
+            /// </summary>
+            std::uint8_t arg_pattern = 0;
+            /// <summary>
+            /// 引数の型の番号(value_type_id、引数を持たないoptionは0xFF)
+            /// </summary>
+            std::uint8_t type_id = 0xFF;
+            /// <summary>
+            /// 引数の数の上限(引数を持たないoptionは0)
+            /// </summary>
+            std::size_t limit = 0;
+            /// <summary>
+            /// 必須の引数の数(上限を超えない)
+            /// </summary>
+            std::size_t required = 0;
+        };
+
+    private:
         /// <summary>
-        /// 引数の数の上限
+        /// 接頭辞を除いたoption名
         /// </summary>
-        std::size_t _limit = 1;
+        std::vector<InternedString> _names;
         /// <summary>
-        /// 引数の表示名(helpで<_name...[1-_limit]>のように表示される)
+        /// 接頭辞の長さ(名前なしオプションは0、optionは1、long optionは2)
         /// </summary>
-        std::string _name = "arg";
+        std::vector<std::uint8_t> _prefixes;
         /// <summary>
-        /// 必須項目となる件数
+        /// optionの種類(KIND)
         /// </summary>
-        std::size_t _required = 0;
+        std::vector<std::uint8_t> _kinds;
+        /// <summary>
+        /// 引数の記載パターン(OptionHasValueBase::ARG_PATTERN)
+        /// </summary>
+        std::vector<std::uint8_t> _arg_patterns;
+        /// <summary>
+        /// 引数の型の番号(value_type_id)
+        /// </summary>
+        std::vector<std::uint8_t> _type_ids;
+        /// <summary>
+        /// 引数の数の上限(引数を持たないoptionは0)
+        /// </summary>
+        std::vector<std::size_t> _limits;
+        /// <summary>
+        /// 必須の引数の数
+        /// </summary>
+        std::vector<std::size_t> _required;
+        /// <summary>
+        /// optionのオブジェクト(所有権はOptionMapが保持する)
+        /// </summary>
+        std::vector<OptionBase*> _options;
+        /// <summary>
+        /// 引数に関する部分オブジェクト(引数を持たないoptionはnullptr)
+        /// </summary>
+        std::vector<OptionValueBase*> _values;
 
     public:
-        Value() {}
-        Value(const T& x) : _default_value(1, x) {}
-        Value(std::initializer_list<T> x) : _default_value(x) {}
+        /// <summary>
+        /// optionの数の予約
+        /// </summary>
+        /// <param name="n">optionの数</param>
+        void reserve(std::size_t n) {
+            this->_names.reserve(n);
+            this->_prefixes.reserve(n);
+            this->_kinds.reserve(n);
+            this->_arg_patterns.reserve(n);
+            this->_type_ids.reserve(n);
+            this->_limits.reserve(n);
+            this->_required.reserve(n);
+            this->_options.reserve(n);
+            this->_values.reserve(n);
+        }
 
         /// <summary>
-        /// 引数の制約条件の設定
+        /// optionの定義を末尾に追加する
         /// </summary>
-        /// <typeparam name="F">引数の制約式の型</typeparam>
-        /// <param name="f">引数の制約式</param>
-        /// <returns></returns>
-        template <class F>
-        Value& constraint(F f) {
-            // デフォルト引数が制約条件を満たしているかのチェック
-            for (const auto& value : this->_default_value) {
-                if (!f(value)) {
-                    throw std::logic_error("デフォルト引数が満たさない制約条件を設定することはできません");
-                }
+        /// <param name="row">optionの定義</param>
+        /// <param name="prefix">接頭辞の長さ</param>
+        /// <param name="option">optionのオブジェクト</param>
+        /// <param name="value">引数に関する部分オブジェクト(引数を持たないoptionはnullptr)</param>
+        /// <returns>追加した定義のインデックス</returns>
+        std::size_t add(const Row& row, std::uint8_t prefix, OptionBase* option, OptionValueBase* value) {
+            if (this->_options.size() == this->_options.capacity()) {
+                // 各列を個別に少しずつ伸長しないよう、まとめて倍に伸長する
+                this->reserve(std::max<std::size_t>(16, this->_options.size() * 2));
             }
-            this->_constraint = f;
-            return *this;
+            this->_names.push_back(row.name);
+            this->_prefixes.push_back(prefix);
+            this->_kinds.push_back(row.kind);
+            this->_arg_patterns.push_back(row.arg_pattern);
+            this->_type_ids.push_back(row.type_id);
+            this->_limits.push_back(row.limit);
+            this->_required.push_back(std::min(row.limit, row.required));
+            this->_options.push_back(option);
+            this->_values.push_back(value);
+            return this->_options.size() - 1;
         }
 
         /// <summary>
-        /// 引数の数の上限の設定
+        /// optionの数の取得
         /// </summary>
-        /// <param name="l">引数の数の上限</param>
         /// <returns></returns>
-        Value& limit(std::size_t l) {
-            if (l == 0) throw std::logic_error("保持する引数の数は0に設定することはできません");
-            if (l < this->_default_value.size()) throw std::logic_error("デフォルト引数の数が引数の数の制限を超過しています");
-            this->_limit = l;
-            return *this;
-        }
+        std::size_t size() const noexcept { return this->_options.size(); }
 
         /// <summary>
-        /// 引数の数の上限をなしにする
+        /// 接頭辞を除いたoption名の取得(名前なしオプションは空文字列)
         /// </summary>
+        /// <param name="i">定義順のインデックス</param>
         /// <returns></returns>
-        Value& unlimited() {
-            this->_limit = std::numeric_limits<std::size_t>::max();
-            return *this;
-        }
+        std::string_view name(std::size_t i) const noexcept { return this->_names[i]; }
 
         /// <summary>
-        /// 引数の表示名の設定
+        /// option名の接頭辞の取得
         /// </summary>
-        /// <param name="n">引数の表示名</param>
-        /// <returns></returns>
-        Value& name(const std::string& n) {
-            this->_name = n;
-            return *this;
-        }
+        /// <param name="i">定義順のインデックス</param>
+        /// <returns>「-」もしくは「--」(名前なしオプションは空文字列)</returns>
+        std::string_view prefix(std::size_t i) const noexcept { return std::string_view("--", this->_prefixes[i]); }
 
         /// <summary>
-        /// 必須項目として設定する
+        /// 定義順のインデックスの行の取得
         /// </summary>
-        /// <param name="n">必須項目となる件数</param>
+        /// <param name="i">定義順のインデックス</param>
         /// <returns></returns>
-        Value& required(std::size_t n = std::numeric_limits<std::size_t>::max()) {
-            this->_required = n;
-            return *this;
+        Row row(std::size_t i) const noexcept {
+            return { this->_names[i], this->_kinds[i], this->_arg_patterns[i], this->_type_ids[i], this->_limits[i], this->_required[i] };
         }
 
+        std::uint8_t prefix_size(std::size_t i) const noexcept { return this->_prefixes[i]; }
+        std::uint8_t kind(std::size_t i) const noexcept { return this->_kinds[i]; }
+        std::uint8_t arg_pattern(std::size_t i) const noexcept { return this->_arg_patterns[i]; }
+        std::uint8_t type_id(std::size_t i) const noexcept { return this->_type_ids[i]; }
+        std::size_t limit(std::size_t i) const noexcept { return this->_limits[i]; }
+        std::size_t required(std::size_t i) const noexcept { return this->_required[i]; }
+        OptionBase* option(std::size_t i) const noexcept { return this->_options[i]; }
+        OptionValueBase* value(std::size_t i) const noexcept { return this->_values[i]; }
+
         /// <summary>
-        /// デフォルト引数を持つかの判定
+        /// 定義順のoptionの一覧の取得
         /// </summary>
-        /// <returns>デフォルト引数を持つ場合にtrue</returns>
-        bool has_default() const { return !this->_default_value.empty(); }
+        /// <returns></returns>
+        std::span<OptionBase* const> options() const noexcept { return this->_options; }
 
         /// <summary>
-        /// 文字列をValueとして利用可能な型に変換する
+        /// 定義順の引数に関する部分オブジェクトの一覧の取得(引数を持たないoptionはnullptr)
         /// </summary>
-        /// <param name="str_view">変換対象の文字列</param>
-        /// <returns>変換結果</returns>
-        T transform(std::string_view str_view) {
-            std::string str(str_view.data(), str_view.size());
-            if constexpr (!std::is_same_v<T, std::string>) {
-                std::istringstream stream(str);
-                T result;
-                stream >> result;
-                // 変換できなかった場合は例外を投げる
-                if (!(bool(stream) && (stream.eof() || stream.get() == std::char_traits<char>::eof()))) {
-                    throw std::runtime_error(std::format("{0} は型 {1} に変換することはできません", str, type_name<T>::value));
-                }
+        /// <returns></returns>
+        std::span<OptionValueBase* const> values() const noexcept { return this->_values; }
 
-                return result;
-            }
-            else {
-                return str;
-            }
-        }
+        /// <summary>
+        /// 定義順のoptionの種類の一覧の取得
+        /// </summary>
+        /// <returns></returns>
+        std::span<const std::uint8_t> kinds() const noexcept { return this->_kinds; }
     };
 
     /// <summary>
-    /// option引数に関する型
+    /// optionなどの基底
     /// </summary>
-    template <class T>
-    class OptionValue {
+    class OptionBase {
+        friend class OptionMap;
         /// <summary>
-        /// 引数の設定
+        /// 名前などの定義を保持する表(OptionMapに追加されるまではnullptr)
         /// </summary>
-        Value<T> _value_info;
+        const SchemaTable* _schema = nullptr;
         /// <summary>
-        /// optionに対する引数
+        /// 表における定義順のインデックス(使用回数の計測にも用いる)
         /// </summary>
-        std::vector<T> _value;
+        std::uint32_t _order = 0;
 
     protected:
         /// <summary>
-        /// option引数に関する説明の取得
-        /// </summary>
-        /// <returns></returns>
-        std::string option_value_description() const {
-            // 引数の形式の取得
-            std::string arg = "<";
-            arg += this->_value_info._name;
-            std::size_t limit = this->_value_info._limit;
-            if (limit == std::numeric_limits<std::size_t>::max()) {
-                arg += "...";
-            }
-            else if (limit > 1) {
-                arg += "...[1-" + std::to_string(limit) + "]";
-            }
-            arg += ">";
-            if (this->_value_info.has_default()) {
-                // デフォルト引数をカンマつなぎにする
-                std::stringstream stream;
-                auto& default_value = this->_value_info._default_value;
-                stream << default_value[0];
-                for (std::size_t i = 1; i < default_value.size(); ++i) {
-                    stream << "," << default_value[i];
-                }
-                arg += "(=" + stream.str() + ")";
-            }
-            return arg;
-        }
-
-        /// <summary>
-        /// 引数の追加
-        /// </summary>
-        /// <param name="val">引数を示す文字列</param>
-        void append(std::string_view val) {
-            this->_value.push_back(this->_value_info.transform(val));
-        }
-
-        /// <summary>
-        /// 引数の検査
+        /// オプションが利用されているときにtrue
         /// </summary>
-        void validateArg() {
-            // チェック対象の引数
-            const auto& targets = this->_value.size() != 0 ? this->_value : this->_value_info._default_value;
-
-            // 引数の数のチェック
-            if (targets.size() > this->_value_info._limit) {
-                throw std::runtime_error("引数の数が多すぎます");
-            }
-            if (this->_value_info._limit == std::numeric_limits<std::size_t>::max() && this->_value_info._required == std::numeric_limits<std::size_t>::max()) {
-                // 任意の数の引数を取ることができる場合かつデフォルトの必須の場合は1つのみ必須とする
-                if (this->_value_info._default_value.size() == 0 && targets.size() == 0) {
-                    throw std::runtime_error("引数の数が少なすぎます");
-                }
-            }
-            else {
-                std::size_t required = std::min(this->_value_info._limit, this->_value_info._required);
-                if (targets.size() < required) {
-                    throw std::runtime_error("引数の数が少なすぎます");
-                }
-            }
-
-            // 引数の制約条件のチェック
-            if (this->_value_info._constraint) {
-                for (const auto& target : targets) {
-                    if (!this->_value_info._constraint(target)) {
-                        throw std::runtime_error(std::format("{0} は制約条件を満たしていません", target));
-                    }
-                }
-            }
-        }
-
+        bool _use = false;
         /// <summary>
-        /// 設定された引数のクリア
+        /// オプションの説明
         /// </summary>
-        void clearArg() {
-            this->_value.clear();
-        }
-
+        InternedString _description;
         /// <summary>
-        /// 引数の数の取得
+        /// 接頭辞付きの別名
         /// </summary>
-        std::size_t argNum() {
-            return this->_value.size();
-        }
+        std::vector<std::string_view> _aliases;
 
         /// <summary>
-        /// 引数の数の上限の取得
+        /// 接頭辞付きの名前が別名に一致するかの判定
         /// </summary>
-        std::size_t argLimit() {
-            return this->_value_info._limit;
+        /// <param name="str">判定対象の文字列</param>
+        /// <returns>一致する別名が存在するときにtrue</returns>
+        bool match_alias(std::string_view str) const {
+            return std::find(this->_aliases.begin(), this->_aliases.end(), str) != this->_aliases.end();
         }
 
     public:
-        OptionValue(const Value<T>& value_info) : _value_info(value_info) {}
-
-        /// <summary>
-        /// 保持している値の取得
-        /// </summary>
-        /// <typeparam name="U">std::vector<T></typeparam>
-        /// <typeparam name="type"></typeparam>
-        /// <returns></returns>
-        template <class U, typename std::enable_if<!std::is_same<T, U>::value, std::nullptr_t>::type = nullptr>
-        U as() const {
-            if (this->_value.size() == 0) {
-                // デフォルト引数の検査
-                if (this->_value_info.has_default()) {
-                    return this->_value_info._default_value;
-                }
-                throw std::runtime_error("引数が設定されていません");
-            }
-            return  this->_value;
-        };
-
+        OptionBase() = delete;
         /// <summary>
-        /// 保持している値の取得
+        /// 名前などの定義はOptionMapへの追加時に表に置く
         /// </summary>
-        /// <typeparam name="U">T</typeparam>
-        /// <typeparam name="type"></typeparam>
-        /// <returns></returns>
-        template <class U, typename std::enable_if<std::is_same<T, U>::value, std::nullptr_t>::type = nullptr>
-        U as() const {
-            if (this->_value.size() == 0) {
-                // デフォルト引数の検査
-                if (this->_value_info.has_default()) {
-                    return this->_value_info._default_value[0];
-                }
-                throw std::runtime_error("引数が設定されていません");
-            }
-            return this->_value[0];
-        };
-    };
-
-    /// <summary>
-    /// 引数付きのoption
-    /// </summary>
-    template <class T>
-    class OptionHasValue : public Option, public OptionValue<T>, public OptionHasValueBase {
-    public:
-        OptionHasValue(const Value<T>& value_info, const std::string& name, const std::string& description) : OptionValue<T>(value_info), Option(name, description), OptionHasValueBase(OptionHasValueBase::ARG_PATTERN::SPACE) {
-            if (value_info.has_default()) {
-                this->_use = true;
-            }
-        }
+        /// <param name="description">オプションの説明</param>
+        explicit OptionBase(InternedString description) : _description(description) {}
+        virtual ~OptionBase() {}
 
         /// <summary>
         /// クローンを作成する
         /// </summary>
         /// <returns>クローン</returns>
-        virtual OptionBase* clone() const { return new OptionHasValue(*this); }
+        virtual OptionBase* clone() const = 0;
 
         /// <summary>
         /// コマンドライン引数のオプションを解析する
@@ -599,218 +821,279 @@ namespace option {
         /// <param name="argc">コマンドライン引数の数</param>
         /// <param name="argv">コマンドライン引数を示す配列</param>
         /// <returns>解析を実行したときにtrue</returns>
-        virtual bool parse(int& offset, int& argc, const char* argv[]) {
-            if (this->match_name(argv[offset])) {
-                int offset2 = offset + 1;
-
-                std::size_t i = this->argNum();
-                std::size_t limit = std::min(i + 1, this->argLimit());
-                if (limit > 0 && this->argNum() == limit) {
-                    throw std::runtime_error(std::format("option {0} でこれ以上の引数を指定することはできません", this->full_name()));
-                }
-
-                for (std::size_t j = i; j < limit && offset2 < argc; ++j, ++offset2) {
-                    const char* token = argv[offset2];
-                    if (Option::is_option(token) || LongOption::is_long_option(token)) {
-                        // 次のトークンがoptionかlong optionの時は中断
-                        break;
-                    }
-                    if (OptionBase::is_dash(token)) {
-                        // 先読みを行ってそれが「-」から始まるならそれをパラメータとして扱う
-                        if (++offset2 < argc && argv[offset2][0] == '-') {
-                            token = argv[offset2];
-                        }
-                        else {
-                            // long optionの解析を中断
-                            break;
-                        }
-                    }
-                    try {
-                        // 引数に追加
-                        this->append(token);
-                    }
-                    catch (const std::runtime_error& e) {
-                        throw std::runtime_error(std::format("option {0} に対する引数 {1}", this->full_name(), e.what()));
-                    }
-                }
-
-                if (i == this->argNum() && limit > 0) {
-                    throw std::runtime_error(std::format("option {0} には引数を指定する必要があります", this->full_name()));
-                }
-                this->_use = true;
-                offset = offset2;
-                return true;
-            }
-            return false;
-        }
+        virtual bool parse(int& offset, int& argc, const char* argv[]) = 0;
 
         /// <summary>
-        /// オプション名についての説明
+        /// トークンを解析するかと後続のトークンから受け取る引数の数の上限を判定する(状態は変更しない)
         /// </summary>
-        /// <returns></returns>
-        virtual std::string name_description() const {
-            return this->full_name() + this->arg_pattern_description() + this->option_value_description();
+        /// <param name="token">optionもしくはlong optionを示すトークン</param>
+        /// <param name="n">後続のトークンから受け取る引数の数の上限</param>
+        /// <returns>parseがトークンを解析するときにtrue</returns>
+        virtual bool following_values(std::string_view token, std::size_t& n) const {
+            n = 0;
+            return this->match_name(token);
         }
 
         /// <summary>
-        /// コマンドライン解析前の状態へ初期化
+        /// オプション名の取得
         /// </summary>
-        virtual void init() {
-            this->clearArg();
-        }
+        /// <returns>オプション名(OptionMapに追加されるまでは空文字列)</returns>
+        std::string_view name() const noexcept { return this->_schema != nullptr ? this->_schema->name(this->_order) : std::string_view(); }
 
         /// <summary>
-        /// 与えられた引数のチェック
+        /// オプション名の接頭辞の取得
         /// </summary>
-        virtual void validate() {
-            this->validateArg();
-        }
-    };
+        /// <returns>「-」もしくは「--」(名前なしオプションは空文字列)</returns>
+        std::string_view prefix() const noexcept { return this->_schema != nullptr ? this->_schema->prefix(this->_order) : std::string_view(); }
 
-    /// <summary>
-    /// 引数付きのlong option
-    /// </summary>
-    template <class T>
-    class LongOptionHasValue : public LongOption, public OptionValue<T>, public OptionHasValueBase {
-    public:
-        LongOptionHasValue(const Value<T>& value_info, const std::string& name, const std::string& description, std::size_t arg_pattern) : OptionValue<T>(value_info), LongOption(name, description), OptionHasValueBase(arg_pattern) {
-            if (value_info.has_default()) {
-                this->_use = true;
-            }
-        }
+        /// <summary>
+        /// 接頭辞付きのオプション名の取得
+        /// </summary>
+        /// <returns>接頭辞付きのオプション名</returns>
+        std::string full_name() const { return std::string(this->prefix()).append(this->name()); }
 
         /// <summary>
-        /// クローンを作成する
+        /// エラーメッセージにおける名前なしオプションの表記の取得
         /// </summary>
-        /// <returns>クローン</returns>
-        virtual OptionBase* clone() const { return new LongOptionHasValue(*this); }
+        /// <returns>名前なしオプションの位置と引数の表示名(名前付きのoptionは空文字列)</returns>
+        virtual std::string unnamed_label() const { return std::string(); }
 
         /// <summary>
-        /// コマンドライン引数のオプションを解析する
+        /// メモリの確保なしにオプション名がマッチするかの判定
         /// </summary>
-        /// <param name="offset">コマンドライン引数のオフセット</param>
-        /// <param name="argc">コマンドライン引数の数</param>
-        /// <param name="argv">コマンドライン引数を示す配列</param>
-        /// <returns>解析を実行したときにtrue</returns>
-        virtual bool parse(int& offset, int& argc, const char* argv[]) {
-            const auto str = std::string_view{ argv[offset] };
-            std::size_t i = str.find('=');
-            if (this->match_name(str.substr(0, i))) {
-                int offset2 = offset + 1;
-                std::size_t limit = this->argLimit();
+        /// <returns>接頭辞付きのオプション名</returns>
+        virtual bool match_name(std::string_view str) const { return this->name() == str; }
 
-                if (i != std::string::npos) {
-                    if ((this->_arg_pattern & ARG_PATTERN::ASSIGN) != ARG_PATTERN::ASSIGN) {
-                        // 解析は不可のためスルー
-                        return false;
-                    }
-                    else {
-                        // 「=」による指定では1つのみ指定可能
-                        if (limit > 0 && this->argNum() == limit) {
-                            throw std::runtime_error(std::format("option {0} でこれ以上の引数を指定することはできません", this->full_name()));
-                        }
-                        try {
-                            // 引数に追加
-                            this->append(str.substr(i + 1));
-                        }
-                        catch (const std::runtime_error& e) {
-                            throw std::runtime_error(std::format("option {0} に対する引数 {1}", this->full_name(), e.what()));
-                        }
+        /// <summary>
+        /// オプションの説明の取得
+        /// </summary>
+        /// <returns>オプションの説明</returns>
+        std::string_view description() const noexcept { return this->_description; }
 
-                        this->_use = true;
-                        offset = offset2;
-                        return true;
-                    }
-                }
-                else {
-                    if ((this->_arg_pattern & ARG_PATTERN::SPACE) != ARG_PATTERN::SPACE) {
-                        // 解析は不可のためスルー
-                        return false;
-                    }
-                }
+        /// <summary>
+        /// 接頭辞付きの別名の取得
+        /// </summary>
+        /// <returns>接頭辞付きの別名</returns>
+        const std::vector<std::string_view>& aliases() const noexcept { return this->_aliases; }
 
-                std::size_t j = this->argNum();
-                if (limit > 0 && j == limit) {
-                    throw std::runtime_error(std::format("option {0} でこれ以上の引数を指定することはできません", this->full_name()));
-                }
+        /// <summary>
+        /// 接頭辞付きの別名の追加
+        /// </summary>
+        /// <param name="alias">接頭辞付きの別名</param>
+        void add_alias(InternedString alias) { this->_aliases.push_back(alias); }
 
-                for (; j < limit && offset2 < argc; ++j, ++offset2) {
-                    const char* token = argv[offset2];
-                    if (Option::is_option(token) || LongOption::is_long_option(token)) {
-                        // 次のトークンがoptionかlong optionの時は中断
-                        break;
-                    }
-                    if (OptionBase::is_dash(token)) {
-                        // 先読みを行ってそれが「-」から始まるならそれをパラメータとして扱う
-                        if (++offset2 < argc && argv[offset2][0] == '-') {
-                            token = argv[offset2];
-                        }
-                        else {
-                            // long optionの解析を中断
-                            break;
-                        }
-                    }
-                    try {
-                        // 引数に追加
-                        this->append(token);
-                    }
-                    catch (const std::runtime_error& e) {
-                        throw std::runtime_error(std::format("option {0} に対する引数 {1}", this->full_name(), e.what()));
-                    }
-                }
+        /// <summary>
+        /// 引数の記載パターンの取得
+        /// </summary>
+        /// <returns>OptionHasValueBase::ARG_PATTERNの論理和(引数付きのoption以外はNONE)</returns>
+        std::size_t arg_pattern() const noexcept { return this->_schema != nullptr ? this->_schema->arg_pattern(this->_order) : 0; }
 
-                if (j == 0 && limit > 0) {
-                    throw std::runtime_error(std::format("option {0} には引数を指定する必要があります", this->full_name()));
-                }
-                this->_use = true;
-                offset = offset2;
-                return true;
-            }
-            return false;
-        }
+        /// <summary>
+        /// 引数の数の上限の取得
+        /// </summary>
+        /// <returns>引数を持たないoptionは0</returns>
+        std::size_t value_limit() const noexcept { return this->_schema != nullptr ? this->_schema->limit(this->_order) : 0; }
+
+        /// <summary>
+        /// 必須の引数の数の取得
+        /// </summary>
+        /// <returns>上限を超えない件数</returns>
+        std::size_t value_required() const noexcept { return this->_schema != nullptr ? this->_schema->required(this->_order) : 0; }
+
+        /// <summary>
+        /// 解析結果の値をJSONとして出力する
+        /// </summary>
+        /// <param name="json">出力先</param>
+        virtual void write_json(JsonSink& json) const { json.value(this->use()); }
+
+        /// <summary>
+        /// optionの種類と引数の定義をJSONのメンバとして出力する
+        /// </summary>
+        /// <param name="json">出力先</param>
+        virtual void write_json_schema(JsonSink& json) const { json.member("kind", "flag"); }
 
         /// <summary>
-        /// オプション名についての説明
+        /// オプションが利用されているかの取得
         /// </summary>
         /// <returns></returns>
-        virtual std::string name_description() const {
-            return this->full_name() + this->arg_pattern_description() + this->option_value_description();
-        }
+        virtual bool use() const noexcept { return this->_use; }
+
+        /// <summary>
+        /// 解析を巻き戻すために現在の状態を記録する
+        /// </summary>
+        /// <returns></returns>
+        virtual OptionMark mark() const { return { this->_use }; }
+
+        /// <summary>
+        /// 記録した状態へ巻き戻す
+        /// </summary>
+        /// <param name="m">markで記録した状態</param>
+        virtual void rewind(const OptionMark& m) { this->_use = m.use; }
+
+        /// <summary>
+        /// OptionMapにおける定義順のインデックスの取得
+        /// </summary>
+        /// <returns></returns>
+        std::size_t order() const noexcept { return this->_order; }
 
         /// <summary>
         /// コマンドライン解析前の状態へ初期化
         /// </summary>
-        virtual void init() {
-            this->clearArg();
-        }
+        virtual void init() {}
 
         /// <summary>
         /// 与えられた引数のチェック
         /// </summary>
-        virtual void validate() {
-            this->validateArg();
+        virtual void validate() {}
+
+        /// <summary>
+        /// 引数がハイフンのみで構成されるかの判定
+        /// </summary>
+        /// <param name="str">判定対象の文字列</param>
+        /// <returns></returns>
+        static constexpr bool is_dash(const char* str) noexcept {
+            if (str == nullptr) return false;
+            for (const char* str2 = str; *str2 != '\0'; ++str2) {
+                if (*str2 != '-') {
+                    return false;
+                }
+            }
+            return *str != '\0';
         }
     };
 
     /// <summary>
-    /// 名前なしオプション
+    /// 引数付きoptionもしくはlong optionの基底(引数の記載パターンそのものはSchemaTableが保持する)
     /// </summary>
-    template <class T>
-    class UnnamedOption : public OptionBase, public OptionValue<T> {
-        friend class AddOptions;
+    class OptionHasValueBase {
+    public:
         /// <summary>
-        /// trueなら後続の解析を中断する
+         /// optionの入力パターン
+         /// </summary>
+        struct ARG_PATTERN {
+            /// <summary>
+            /// なし
+            /// </summary>
+            static constexpr std::size_t NONE = 0;
+            /// <summary>
+            /// --a=1のような等号による引数から記述が始まることを示すフラグ
+            /// </summary>
+            static constexpr std::size_t ASSIGN = 0b1;
+            /// <summary>
+            /// --a 1のようなスペースによる引数から記述が始まることを示すフラグ
+            /// </summary>
+            static constexpr std::size_t SPACE = 0b10;
+        };
+
+        /// <summary>
+        /// 引数の記載パターンに関する説明の取得
         /// </summary>
-        bool _pause = false;
+        /// <param name="arg_pattern">引数の記載パターン</param>
+        /// <returns></returns>
+        static std::string arg_pattern_description(std::size_t arg_pattern) {
+            switch (arg_pattern) {
+            case ARG_PATTERN::NONE:
+                return "";
+            case ARG_PATTERN::ASSIGN:
+                return "=";
+            case ARG_PATTERN::SPACE:
+                return " ";
+            default:
+                if (arg_pattern == (ARG_PATTERN::SPACE | ARG_PATTERN::ASSIGN)) {
+                    return "[ |=]";
+                }
+            }
+            throw std::logic_error("ここに来ることはない");
+        }
+
+        /// <summary>
+        /// 引数の記載パターンをJSONのメンバとして出力する
+        /// </summary>
+        /// <param name="json">出力先</param>
+        /// <param name="arg_pattern">引数の記載パターン</param>
+        static void write_json_arg_pattern(JsonSink& json, std::size_t arg_pattern) {
+            json.key("arg_pattern").begin_array();
+            if ((arg_pattern & ARG_PATTERN::SPACE) == ARG_PATTERN::SPACE) json.value("space");
+            if ((arg_pattern & ARG_PATTERN::ASSIGN) == ARG_PATTERN::ASSIGN) json.value("assign");
+            json.end_array();
+        }
+    };
+
+    /// <summary>
+    /// 末尾の等号「=」もしくはスペース「 」により引数の記載パターンを指定できる検証済みのlong option名
+    /// </summary>
+    class LongOptionName {
+        /// <summary>
+        /// 引数の記載パターン
+        /// </summary>
+        std::size_t _arg_pattern = OptionHasValueBase::ARG_PATTERN::ASSIGN | OptionHasValueBase::ARG_PATTERN::SPACE;
+        /// <summary>
+        /// 末尾の記号を除いたoption名
+        /// </summary>
+        OptionName _name;
+
+        /// <summary>
+        /// 末尾の記号から引数の記載パターンを設定して記号を除いた名前を検証する
+        /// </summary>
+        /// <param name="name">末尾の記号を含む名前</param>
+        /// <returns>末尾の記号を除いた名前の長さ</returns>
+        constexpr std::size_t split(std::string_view name) {
+            if (name.ends_with('=')) {
+                this->_arg_pattern = OptionHasValueBase::ARG_PATTERN::ASSIGN;
+                name.remove_suffix(1);
+            }
+            else if (name.ends_with(' ')) {
+                this->_arg_pattern = OptionHasValueBase::ARG_PATTERN::SPACE;
+                name.remove_suffix(1);
+            }
+            return OptionName::check(name).size();
+        }
+
+        /// <summary>
+        /// 定数式の名前からの構築
+        /// </summary>
+        struct literal_tag {};
+        constexpr LongOptionName(InternedString name, literal_tag) : _name(name.substr(0, split(name)), OptionName::validated_tag{}) {}
+
+    public:
+        template <class S, typename std::enable_if<std::is_convertible_v<S, std::string_view> && !std::is_same_v<std::remove_cvref_t<S>, LongOptionName>, std::nullptr_t>::type = nullptr>
+        LongOptionName(S&& name) : _name(InternedString(std::string_view(name).substr(0, split(std::string_view(name)))), OptionName::validated_tag{}) {}
+
+        /// <summary>
+        /// 定数式の名前(末尾の記号を含む)をコンパイル時に検証し、複製せずに参照する
+        /// </summary>
+        /// <param name="name">静的記憶域にあるナル終端文字列</param>
+        /// <returns></returns>
+        static consteval LongOptionName literal(const char* name) {
+            return LongOptionName(InternedString::literal(name), literal_tag{});
+        }
+
+        /// <summary>
+        /// 末尾の記号を除いたoption名の取得
+        /// </summary>
+        /// <returns></returns>
+        constexpr const OptionName& name() const noexcept { return this->_name; }
 
+        /// <summary>
+        /// 引数の記載パターンの取得
+        /// </summary>
+        /// <returns></returns>
+        constexpr std::size_t arg_pattern() const noexcept { return this->_arg_pattern; }
+    };
+
+    /// <summary>
+    /// option
+    /// </summary>
+    class Option : public OptionBase {
     public:
-        UnnamedOption(const Value<T>& value_info, const std::string& description) : OptionValue<T>(value_info), OptionBase("", description) {}
+        using OptionBase::OptionBase;
+        virtual ~Option() {}
 
         /// <summary>
         /// クローンを作成する
         /// </summary>
         /// <returns>クローン</returns>
-        virtual OptionBase* clone() const { return new UnnamedOption(*this); }
+        virtual OptionBase* clone() const { return new Option(*this); }
 
         /// <summary>
         /// コマンドライン引数のオプションを解析する
@@ -819,144 +1102,2759 @@ namespace option {
         /// <param name="argc">コマンドライン引数の数</param>
         /// <param name="argv">コマンドライン引数を示す配列</param>
         /// <returns>解析を実行したときにtrue</returns>
-        virtual bool parse(int& offset, int& argc, const char* argv[]) {
-            if (this->argNum() < this->argLimit()) {
-                try {
-                    // 引数に追加
-                    this->append(argv[offset]);
-                }
-                catch (const std::runtime_error& e) {
-                    throw std::runtime_error(std::format("option {0} に対する引数 {1}", this->full_name(), e.what()));
-                }
-                ++offset;
+        virtual bool parse(int& offset, [[maybe_unused]] int& argc, const char* argv[]) {
+            if (this->match_name(argv[offset])) {
                 this->_use = true;
-                if (this->argNum() == this->argLimit() && this->_pause) {
-                    // 中断をする場合はその旨を設定する
-                    argc = offset;
-                }
+                ++offset;
                 return true;
             }
             return false;
         }
 
         /// <summary>
-        /// オプション名についての説明
-        /// </summary>
-        /// <returns></returns>
-        virtual std::string name_description() const {
-            return this->option_value_description();
-        }
-
-        /// <summary>
-        /// コマンドライン解析前の状態へ初期化
+        /// メモリの確保なしにオプション名がマッチするかの判定
         /// </summary>
-        virtual void init() {
-            this->clearArg();
+        /// <returns>接頭辞付きのオプション名</returns>
+        virtual bool match_name(std::string_view str) const {
+            return (str.size() >= 2 && str[0] == '-' && this->name() == str.substr(1)) || this->match_alias(str);
         }
 
         /// <summary>
-        /// 与えられた引数のチェック
+        /// optionであることの判定
         /// </summary>
-        virtual void validate() {
-            this->validateArg();
+        /// <param name="str">判定対象の文字列</param>
+        /// <returns>optionならtrue</returns>
+        static constexpr bool is_option(const char* str) {
+            if (str == nullptr) return false;
+            return *str == '-' && *(str + 1) != '-' && *(str + 1) != '\0';
         }
     };
 
     /// <summary>
-    /// コマンドラインオプションの解析結果を取得するためのクラス
+    /// long option
     /// </summary>
-    class OptionWrapper {
-        std::shared_ptr<OptionBase> _option;
-
-        // 型Tがvalue_typeをもつならその型に変換
-        template <class T, class = void>
-        struct to_value_type {
-            using type = T;
-        };
-        template <class T>
-        struct to_value_type<T, std::void_t<typename T::value_type>> {
-            using type = typename T::value_type;
-        };
-        // std::stringは例外
-        template <>
-        struct to_value_type<std::string> {
-            using type = std::string;
-        };
+    class LongOption : public OptionBase {
     public:
-        OptionWrapper(const std::shared_ptr<OptionBase>& option) : _option(option) {}
-
-        explicit operator bool() const noexcept { return this->_option->use(); }
+        using OptionBase::OptionBase;
+        virtual ~LongOption() {}
 
-        // optionの引数を型Tとして取得する(Tがコンテナであるときはpush_backで要素を追加可能なものであるとする)
-        template <class T>
-        T as() const {
-            using value_type = typename to_value_type<T>::type;
-            OptionValue<value_type>* p = dynamic_cast<OptionValue<value_type>*>(this->_option.get());
+        /// <summary>
+        /// クローンを作成する
+        /// </summary>
+        /// <returns>クローン</returns>
+        virtual OptionBase* clone() const { return new LongOption(*this); }
+
+        /// <summary>
+        /// コマンドライン引数のオプションを解析する
+        /// </summary>
+        /// <param name="offset">コマンドライン引数のオフセット</param>
+        /// <param name="argc">コマンドライン引数の数</param>
+        /// <param name="argv">コマンドライン引数を示す配列</param>
+        /// <returns>解析を実行したときにtrue</returns>
+        virtual bool parse(int& offset, [[maybe_unused]] int& argc, const char* argv[]) {
+            if (this->match_name(argv[offset])) {
+                this->_use = true;
+                ++offset;
+                return true;
+            }
+            return false;
+        }
+
+        /// <summary>
+        /// メモリの確保なしにオプション名がマッチするかの判定
+        /// </summary>
+        /// <returns>接頭辞付きのオプション名</returns>
+        virtual bool match_name(std::string_view str) const {
+            return (str.size() >= 3 && str[0] == '-' && str[1] == '-' && this->name() == str.substr(2)) || this->match_alias(str);
+        }
+
+        /// <summary>
+        /// long optionであることの判定
+        /// </summary>
+        /// <param name="str">判定対象の文字列</param>
+        /// <returns>long optionならtrue</returns>
+        static constexpr bool is_long_option(const char* str) {
+            if (str == nullptr) return false;
+            return *str == '-' && *(str + 1) == '-' && *(str + 2) != '-' && *(str + 2) != '\0';
+        }
+    };
+
+    /// <summary>
+    /// ファイルパスである引数の検査
+    /// </summary>
+    /// <remarks>
+    /// OptionMap::validateは全optionの検査要求をまとめてValue::pathで指定した実行方法に渡す。
+    /// 呼び出しごとにスレッドを作成して並行に発行する実行方法はCommandLineOptionPath.hppのPathCheckPoolである
+    /// </remarks>
+    class PathCheck {
+    public:
+        /// <summary>
+        /// 検査の種類(論理和で組み合わせる)
+        /// </summary>
+        struct CHECK {
+            // 存在する
+            static constexpr std::uint32_t EXISTS = 0b0001;
+            // ディレクトリである(存在することを含む)
+            static constexpr std::uint32_t DIRECTORY = 0b0010;
+            // 読み込むことができる(存在することを含む)
+            static constexpr std::uint32_t READABLE = 0b0100;
+            // 書き込むことができる(存在しないときは親ディレクトリに書き込むことができる)
+            static constexpr std::uint32_t WRITABLE = 0b1000;
+        };
+
+        /// <summary>
+        /// 検査要求
+        /// </summary>
+        struct Request {
+            /// <summary>
+            /// 検査対象のパス(検査が完了するまで有効であること)
+            /// </summary>
+            std::string_view path;
+            /// <summary>
+            /// 実施する検査
+            /// </summary>
+            std::uint32_t checks;
+            /// <summary>
+            /// 満たさなかった検査(満たしたときは0)
+            /// </summary>
+            std::uint32_t failed = 0;
+        };
+
+        /// <summary>
+        /// 検査要求を実行して結果をfailedに格納する関数
+        /// </summary>
+        using Runner = void (*)(std::vector<Request>& requests);
+
+        /// <summary>
+        /// 実行済みの検査要求の結果を確認する
+        /// </summary>
+        /// <param name="requests">実行済みの検査要求</param>
+        static void verify(std::span<const Request> requests) {
+            for (const auto& request : requests) {
+                switch (request.failed) {
+                case 0:
+                    break;
+                case CHECK::EXISTS:
+                    throw std::runtime_error(DescriptionCatalog::message("error.path_not_found", "{0} は存在しません", request.path));
+                case CHECK::DIRECTORY:
+                    throw std::runtime_error(DescriptionCatalog::message("error.path_not_directory", "{0} はディレクトリではありません", request.path));
+                case CHECK::READABLE:
+                    throw std::runtime_error(DescriptionCatalog::message("error.path_not_readable", "{0} は読み込むことができません", request.path));
+                default:
+                    throw std::runtime_error(DescriptionCatalog::message("error.path_not_writable", "{0} は書き込むことができません", request.path));
+                }
+            }
+        }
+    };
+
+    // CommandLineOptionPath.hppで定義する
+    class PathCheckPool;
+
+    /// <summary>
+    /// 信頼できない入力を解析するときの資源の上限(既定は無制限)
+    /// </summary>
+    struct ParseLimits {
+        static constexpr std::size_t UNLIMITED = std::numeric_limits<std::size_t>::max();
+        /// <summary>
+        /// コマンドライン引数の数
+        /// </summary>
+        std::size_t tokens = UNLIMITED;
+        /// <summary>
+        /// コマンドライン引数の合計バイト数
+        /// </summary>
+        std::size_t bytes = UNLIMITED;
+        /// <summary>
+        /// 1つのoptionが保持する引数の数
+        /// </summary>
+        std::size_t values_per_option = UNLIMITED;
+        /// <summary>
+        /// 全optionが1回の解析で保持する引数の合計数
+        /// </summary>
+        std::size_t values = UNLIMITED;
+    };
+
+    /// <summary>
+    /// 1回の解析におけるParseLimitsに対する消費量
+    /// </summary>
+    /// <remarks>
+    /// トークンと引数を受け付けるたびに加算して上限と比較し、超過した時点で例外を投げて解析を打ち切る。
+    /// 引数は保持する前に検査するため、上限を超えてメモリを確保することはない
+    /// </remarks>
+    class ParseBudget {
+    public:
+        /// <summary>
+        /// 消費量
+        /// </summary>
+        struct Usage {
+            std::size_t tokens = 0;
+            std::size_t bytes = 0;
+            std::size_t values = 0;
+        };
+
+    private:
+        ParseLimits _limits;
+        Usage _usage;
+
+    public:
+        /// <summary>
+        /// 上限の取得
+        /// </summary>
+        /// <returns></returns>
+        const ParseLimits& limits() const noexcept { return this->_limits; }
+
+        /// <summary>
+        /// 上限の設定
+        /// </summary>
+        /// <param name="limits">上限</param>
+        void set_limits(const ParseLimits& limits) noexcept { this->_limits = limits; }
+
+        /// <summary>
+        /// 消費量の取得
+        /// </summary>
+        /// <returns></returns>
+        const Usage& usage() const noexcept { return this->_usage; }
+
+        /// <summary>
+        /// 消費量を設定する(解析を巻き戻したときに用いる)
+        /// </summary>
+        /// <param name="usage">消費量</param>
+        void restore(const Usage& usage) noexcept { this->_usage = usage; }
+
+        /// <summary>
+        /// 消費量を0にする(解析の開始時に呼び出す)
+        /// </summary>
+        void reset() noexcept { this->_usage = Usage(); }
+
+        /// <summary>
+        /// トークンを1つ受け付ける
+        /// </summary>
+        /// <param name="token">コマンドライン引数</param>
+        void consume_token(std::string_view token) {
+            if (++this->_usage.tokens > this->_limits.tokens) {
+                throw std::runtime_error(DescriptionCatalog::message("error.too_many_tokens", "コマンドライン引数の数が上限 {0} を超えています", this->_limits.tokens));
+            }
+            this->_usage.bytes += token.size();
+            if (this->_usage.bytes > this->_limits.bytes) {
+                throw std::runtime_error(DescriptionCatalog::message("error.too_many_bytes", "コマンドライン引数の合計バイト数が上限 {0} を超えています", this->_limits.bytes));
+            }
+        }
+
+        /// <summary>
+        /// 引数の列のうち上限を超えずに受け付けられる先頭の引数を受け付ける
+        /// </summary>
+        /// <param name="held">optionが既に保持している引数の数</param>
+        /// <param name="n">引数の列の長さ</param>
+        /// <returns>受け付けた引数の数(nより小さいときは続く引数に対するconsume_valueが例外を投げる)</returns>
+        std::size_t consume_values(std::size_t held, std::size_t n) noexcept {
+            const std::size_t per_option = held < this->_limits.values_per_option ? this->_limits.values_per_option - held : 0;
+            const std::size_t total = this->_usage.values < this->_limits.values ? this->_limits.values - this->_usage.values : 0;
+            const std::size_t accepted = std::min({ n, per_option, total });
+            this->_usage.values += accepted;
+            return accepted;
+        }
+
+        /// <summary>
+        /// 引数を1つ受け付ける
+        /// </summary>
+        /// <param name="self">引数を保持するoption</param>
+        /// <param name="held">optionが既に保持している引数の数</param>
+        void consume_value(const OptionBase& self, std::size_t held) {
+            if (held >= this->_limits.values_per_option) {
+                if (auto label = self.unnamed_label(); !label.empty()) {
+                    throw std::runtime_error(DescriptionCatalog::message("error.too_many_unnamed_option_values", "名前なしオプション {0} の引数の数が上限 {1} を超えています", label, this->_limits.values_per_option));
+                }
+                throw std::runtime_error(DescriptionCatalog::message("error.too_many_option_values", "option {0} の引数の数が上限 {1} を超えています", self.full_name(), this->_limits.values_per_option));
+            }
+            if (++this->_usage.values > this->_limits.values) {
+                throw std::runtime_error(DescriptionCatalog::message("error.too_many_values", "引数の合計数が上限 {0} を超えています", this->_limits.values));
+            }
+        }
+    };
+
+    /// <summary>
+    /// option引数に関する型の基底(引数の型に依存しない解析処理を実装する)
+    /// </summary>
+    class OptionValueBase {
+        friend class OptionMap;
+    protected:
+        /// <summary>
+        /// 解析における資源の消費量(optionの定義に追加されるまではnullptr)
+        /// </summary>
+        ParseBudget* _budget = nullptr;
+
+        /// <summary>
+        /// 受け取った最大run_size個の引数を変換して追加する(append_following_valuesが区切った列ごとに呼ばれる型ごとの処理)
+        /// </summary>
+        /// <param name="values">引数を示す文字列の列</param>
+        virtual void append_values(std::span<const std::string_view> values) = 0;
+
+        /// <summary>
+        /// 引数の数の取得
+        /// </summary>
+        virtual std::size_t value_num() const = 0;
+
+        /// <summary>
+        /// 設定された引数のクリア
+        /// </summary>
+        virtual void clear_values() = 0;
+
+        /// <summary>
+        /// 引数の数と値の検査
+        /// </summary>
+        /// <param name="limit">引数の数の上限(SchemaTable::limit)</param>
+        /// <param name="required">必須の引数の数(SchemaTable::required)</param>
+        virtual void validate_values(std::size_t limit, std::size_t required) const = 0;
+
+        /// <summary>
+        /// 引数の形式とデフォルト引数の説明を追加する
+        /// </summary>
+        /// <param name="out">追加先</param>
+        /// <param name="limit">引数の数の上限(SchemaTable::limit)</param>
+        virtual void append_value_description(std::string& out, std::size_t limit) const = 0;
+
+        /// <summary>
+        /// 引数の列の追加を行い、変換に失敗したときはoption名を付与した例外を投げる
+        /// </summary>
+        /// <param name="self">解析対象のoption</param>
+        /// <param name="values">引数を示す文字列の列</param>
+        /// <remarks>
+        /// 資源の上限の範囲で受け付けられる先頭の引数を変換した後に、上限を超える引数があればそのエラーを投げる
+        /// (引数ごとに上限の検査と変換を交互に行ったときと同じエラーとなる)
+        /// </remarks>
+        void append_values_of(const OptionBase& self, std::span<const std::string_view> values) {
+            const std::size_t held = this->value_num();
+            const std::size_t accepted = this->_budget != nullptr ? this->_budget->consume_values(held, values.size()) : values.size();
+            try {
+                // 引数に追加
+                this->append_values(values.first(accepted));
+            }
+            catch (const std::runtime_error& e) {
+                if (auto label = self.unnamed_label(); !label.empty()) {
+                    throw std::runtime_error(DescriptionCatalog::message("error.unnamed_option_argument_at", "名前なしオプション {0} に対する引数 {1}", label, e.what()));
+                }
+                throw std::runtime_error(DescriptionCatalog::message("error.option_argument", "option {0} に対する引数 {1}", self.full_name(), e.what()));
+            }
+            if (accepted != values.size()) {
+                this->_budget->consume_value(self, held + accepted);
+            }
+        }
+
+        /// <summary>
+        /// 引数の追加を行い、変換に失敗したときはoption名を付与した例外を投げる
+        /// </summary>
+        /// <param name="self">解析対象のoption</param>
+        /// <param name="val">引数を示す文字列</param>
+        void append_value_of(const OptionBase& self, std::string_view val) {
+            this->append_values_of(self, std::span<const std::string_view>(&val, 1));
+        }
+
+        /// <summary>
+        /// optionに続くトークンを引数として読み込む
+        /// </summary>
+        /// <param name="self">解析対象のoption</param>
+        /// <param name="offset">読み込みを開始するコマンドライン引数のオフセット</param>
+        /// <param name="argc">コマンドライン引数の数</param>
+        /// <param name="argv">コマンドライン引数を示す配列</param>
+        /// <param name="j">現在の引数の数</param>
+        /// <param name="limit">読み込み後の引数の数の上限</param>
+        /// <returns>読み込み後の引数の数</returns>
+        /// <remarks>
+        /// 引数の列は全体を1回で渡すのではなく、最大run_size個ずつ区切って型ごとの処理(append_values)に渡す。
+        /// 仮想呼び出しは引数run_size個につき1回となり、作業領域はスタック上の固定長の配列で済む
+        /// </remarks>
+        std::size_t append_following_values(const OptionBase& self, int& offset, int argc, const char* argv[], std::size_t j, std::size_t limit) {
+            constexpr std::size_t run_size = 16;
+            std::array<std::string_view, run_size> run;
+            std::size_t n = 0;
+            for (; j < limit && offset < argc; ++j, ++offset) {
+                const char* token = argv[offset];
+                if (Option::is_option(token) || LongOption::is_long_option(token)) {
+                    // 次のトークンがoptionかlong optionの時は中断
+                    break;
+                }
+                if (OptionBase::is_dash(token)) {
+                    // 先読みを行ってそれが「-」から始まるならそれをパラメータとして扱う
+                    if (++offset < argc && argv[offset][0] == '-') {
+                        token = argv[offset];
+                    }
+                    else {
+                        // long optionの解析を中断
+                        break;
+                    }
+                }
+                run[n++] = token;
+                if (n == run.size()) {
+                    this->append_values_of(self, run);
+                    n = 0;
+                }
+            }
+            if (n != 0) {
+                this->append_values_of(self, std::span<const std::string_view>(run.data(), n));
+            }
+            return j;
+        }
+
+        /// <summary>
+        /// 引数付きのoptionとしてコマンドライン引数を解析する
+        /// </summary>
+        /// <param name="self">解析対象のoption</param>
+        /// <param name="offset">コマンドライン引数のオフセット</param>
+        /// <param name="argc">コマンドライン引数の数</param>
+        /// <param name="argv">コマンドライン引数を示す配列</param>
+        /// <returns>解析を実行したときにtrue</returns>
+        bool parse_option(const OptionBase& self, int& offset, int& argc, const char* argv[]) {
+            if (self.match_name(argv[offset])) {
+                int offset2 = offset + 1;
+
+                // optionの1回の指定につき引数は1つまで
+                std::size_t i = this->value_num();
+                std::size_t limit = std::min(i + 1, self.value_limit());
+                if (limit > 0 && i == limit) {
+                    throw std::runtime_error(DescriptionCatalog::message("error.too_many_option_arguments", "option {0} でこれ以上の引数を指定することはできません", self.full_name()));
+                }
+
+                if (i == this->append_following_values(self, offset2, argc, argv, i, limit) && limit > 0) {
+                    throw std::runtime_error(DescriptionCatalog::message("error.option_argument_required", "option {0} には引数を指定する必要があります", self.full_name()));
+                }
+                offset = offset2;
+                return true;
+            }
+            return false;
+        }
+
+        /// <summary>
+        /// 引数付きのlong optionとしてコマンドライン引数を解析する
+        /// </summary>
+        /// <param name="self">解析対象のoption</param>
+        /// <param name="offset">コマンドライン引数のオフセット</param>
+        /// <param name="argc">コマンドライン引数の数</param>
+        /// <param name="argv">コマンドライン引数を示す配列</param>
+        /// <returns>解析を実行したときにtrue</returns>
+        bool parse_long_option(const OptionBase& self, int& offset, int& argc, const char* argv[]) {
+            using ARG_PATTERN = OptionHasValueBase::ARG_PATTERN;
+            const std::size_t arg_pattern = self.arg_pattern();
+            const auto str = std::string_view{ argv[offset] };
+            std::size_t i = str.find('=');
+            if (self.match_name(str.substr(0, i))) {
+                int offset2 = offset + 1;
+                std::size_t limit = self.value_limit();
+
+                if (i != std::string::npos) {
+                    if ((arg_pattern & ARG_PATTERN::ASSIGN) != ARG_PATTERN::ASSIGN) {
+                        // 解析は不可のためスルー
+                        return false;
+                    }
+                    else {
+                        // 「=」による指定では1つのみ指定可能
+                        if (limit > 0 && this->value_num() == limit) {
+                            throw std::runtime_error(DescriptionCatalog::message("error.too_many_option_arguments", "option {0} でこれ以上の引数を指定することはできません", self.full_name()));
+                        }
+                        this->append_value_of(self, str.substr(i + 1));
+                        offset = offset2;
+                        return true;
+                    }
+                }
+                else {
+                    if ((arg_pattern & ARG_PATTERN::SPACE) != ARG_PATTERN::SPACE) {
+                        // 解析は不可のためスルー
+                        return false;
+                    }
+                }
+
+                std::size_t j = this->value_num();
+                if (limit > 0 && j == limit) {
+                    throw std::runtime_error(DescriptionCatalog::message("error.too_many_option_arguments", "option {0} でこれ以上の引数を指定することはできません", self.full_name()));
+                }
+
+                if (this->append_following_values(self, offset2, argc, argv, j, limit) == 0 && limit > 0) {
+                    throw std::runtime_error(DescriptionCatalog::message("error.option_argument_required", "option {0} には引数を指定する必要があります", self.full_name()));
+                }
+                offset = offset2;
+                return true;
+            }
+            return false;
+        }
+
+        /// <summary>
+        /// 引数付きのoptionとして後続のトークンから受け取る引数の数の上限を判定する
+        /// </summary>
+        /// <param name="self">判定対象のoption</param>
+        /// <param name="token">optionを示すトークン</param>
+        /// <param name="n">後続のトークンから受け取る引数の数の上限</param>
+        /// <returns>parse_optionがトークンを解析するときにtrue</returns>
+        bool following_option_values(const OptionBase& self, std::string_view token, std::size_t& n) const {
+            const std::size_t i = this->value_num();
+            n = std::min(i + 1, self.value_limit()) - i;
+            return self.match_name(token);
+        }
+
+        /// <summary>
+        /// 引数付きのlong optionとして後続のトークンから受け取る引数の数の上限を判定する
+        /// </summary>
+        /// <param name="self">判定対象のoption</param>
+        /// <param name="token">long optionを示すトークン</param>
+        /// <param name="n">後続のトークンから受け取る引数の数の上限</param>
+        /// <returns>parse_long_optionがトークンを解析するときにtrue</returns>
+        bool following_long_option_values(const OptionBase& self, std::string_view token, std::size_t& n) const {
+            using ARG_PATTERN = OptionHasValueBase::ARG_PATTERN;
+            const std::size_t arg_pattern = self.arg_pattern();
+            const std::size_t i = token.find('=');
+            n = 0;
+            if (!self.match_name(token.substr(0, i))) {
+                return false;
+            }
+            if (i != std::string_view::npos) {
+                return (arg_pattern & ARG_PATTERN::ASSIGN) == ARG_PATTERN::ASSIGN;
+            }
+            n = self.value_limit() - std::min(this->value_num(), self.value_limit());
+            return (arg_pattern & ARG_PATTERN::SPACE) == ARG_PATTERN::SPACE;
+        }
+
+    public:
+        virtual ~OptionValueBase() {}
+
+        /// <summary>
+        /// 解析における資源の消費量を関連付ける
+        /// </summary>
+        /// <param name="budget">optionの定義が保持する消費量</param>
+        void attach(ParseBudget& budget) noexcept { this->_budget = &budget; }
+
+        /// <summary>
+        /// ファイルパスとしての検査要求の追加
+        /// </summary>
+        /// <param name="requests">追加先</param>
+        /// <returns>追加した検査要求の実行方法(検査しないときはnullptr)</returns>
+        virtual PathCheck::Runner path_requests(std::vector<PathCheck::Request>& /*requests*/) const { return nullptr; }
+    };
+
+    /// <summary>
+    /// 引数の文字列全体が一致すべきパターン
+    /// </summary>
+    /// <remarks>
+    /// DFAに変換して照合する実装はCommandLineOptionPattern.hppのPatternである
+    /// </remarks>
+    class ValuePattern {
+    public:
+        virtual ~ValuePattern() {}
+
+        /// <summary>
+        /// 文字列全体がパターンに一致するかの判定
+        /// </summary>
+        /// <param name="str">判定対象の文字列</param>
+        /// <returns>一致するときにtrue</returns>
+        virtual bool match(std::string_view str) const noexcept = 0;
+
+        /// <summary>
+        /// パターンの文字列の取得
+        /// </summary>
+        /// <returns></returns>
+        virtual std::string_view source() const noexcept = 0;
+    };
+
+    // CommandLineOptionPattern.hppで定義する
+    class Pattern;
+
+    /// <summary>
+    /// 引数として許可された値の集合
+    /// </summary>
+    /// <typeparam name="T">引数の型</typeparam>
+    /// <remarks>
+    /// 構築時に1度だけ、数値は整列済みの配列、文字列は1つの領域に連結した文字列を指す開番地法のハッシュ表として構築する。
+    /// 構築後は変更されないため、shared_ptrを介して複数のoptionから共有できる
+    /// </remarks>
+    template <class T>
+    class OneOf {
+        static constexpr bool is_string = std::is_same_v<T, std::string>;
+    public:
+        /// <summary>
+        /// 検索に用いる値の型
+        /// </summary>
+        using key_type = std::conditional_t<is_string, std::string_view, T>;
+
+    private:
+        /// <summary>
+        /// 整列済みの値(数値のとき)
+        /// </summary>
+        std::vector<T> _sorted;
+        /// <summary>
+        /// 連結した文字列(文字列のとき)
+        /// </summary>
+        std::string _blob;
+        /// <summary>
+        /// 各文字列の_blob上の開始位置(末尾は_blobの長さ)
+        /// </summary>
+        std::vector<std::uint32_t> _offsets;
+        /// <summary>
+        /// 上位32ビットにハッシュ値の上位32ビット、下位32ビットに文字列の番号+1(0は空き)を格納したスロット
+        /// </summary>
+        std::vector<std::uint64_t> _slots;
+
+        static std::uint64_t hash(std::string_view str) noexcept {
+            // 64ビットに満たないハッシュ値は上位ビットへ広げる
+            return static_cast<std::uint64_t>(std::hash<std::string_view>{}(str)) * 0x9E3779B97F4A7C15ull;
+        }
+
+        std::string_view at(std::size_t i) const noexcept {
+            return std::string_view(this->_blob).substr(this->_offsets[i], this->_offsets[i + 1] - this->_offsets[i]);
+        }
+
+    public:
+        /// <summary>
+        /// 許可する値の一覧から構築する(重複は取り除かれる)
+        /// </summary>
+        /// <param name="values">許可する値の一覧</param>
+        template <class Container>
+        explicit OneOf(const Container& values) {
+            if constexpr (is_string) {
+                std::vector<std::string_view> keys(std::begin(values), std::end(values));
+                std::sort(keys.begin(), keys.end());
+                keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+                if (keys.empty()) throw std::invalid_argument("許可する値の集合を空にすることはできません");
+                this->_offsets.reserve(keys.size() + 1);
+                for (const auto& key : keys) {
+                    this->_offsets.push_back(static_cast<std::uint32_t>(this->_blob.size()));
+                    this->_blob.append(key);
+                    if (this->_blob.size() > std::numeric_limits<std::uint32_t>::max()) throw std::invalid_argument("許可する値の集合が大きすぎます");
+                }
+                this->_offsets.push_back(static_cast<std::uint32_t>(this->_blob.size()));
+                // 負荷率を1/2以下に保つ
+                this->_slots.assign(std::bit_ceil(std::max<std::size_t>(keys.size() * 2, 8)), 0);
+                const std::size_t mask = this->_slots.size() - 1;
+                for (std::size_t i = 0; i < keys.size(); ++i) {
+                    const auto h = hash(keys[i]);
+                    auto pos = static_cast<std::size_t>(h) & mask;
+                    while (this->_slots[pos] != 0) pos = (pos + 1) & mask;
+                    this->_slots[pos] = (h & 0xFFFFFFFF00000000ull) | (i + 1);
+                }
+            }
+            else {
+                this->_sorted.assign(std::begin(values), std::end(values));
+                if constexpr (std::is_floating_point_v<T>) {
+                    if (std::any_of(this->_sorted.begin(), this->_sorted.end(), [](T x) { return std::isnan(x); })) {
+                        throw std::invalid_argument("許可する値にNaNを含めることはできません");
+                    }
+                }
+                std::sort(this->_sorted.begin(), this->_sorted.end());
+                this->_sorted.erase(std::unique(this->_sorted.begin(), this->_sorted.end()), this->_sorted.end());
+                if (this->_sorted.empty()) throw std::invalid_argument("許可する値の集合を空にすることはできません");
+            }
+        }
+
+        /// <summary>
+        /// 値が許可されているかの判定
+        /// </summary>
+        /// <param name="value">判定対象の値</param>
+        /// <returns>許可されているときにtrue</returns>
+        bool contains(key_type value) const noexcept {
+            if constexpr (is_string) {
+                const auto h = hash(value);
+                const std::size_t mask = this->_slots.size() - 1;
+                for (auto pos = static_cast<std::size_t>(h) & mask; this->_slots[pos] != 0; pos = (pos + 1) & mask) {
+                    const auto slot = this->_slots[pos];
+                    if ((slot & 0xFFFFFFFF00000000ull) == (h & 0xFFFFFFFF00000000ull) && this->at(static_cast<std::size_t>(slot & 0xFFFFFFFF) - 1) == value) return true;
+                }
+                return false;
+            }
+            else {
+                // 比較結果を分岐ではなく選択で反映する二分探索(反復回数は値に依らない)
+                const T* base = this->_sorted.data();
+                std::size_t n = this->_sorted.size();
+                while (n > 1) {
+                    const std::size_t half = n / 2;
+                    base = base[half] <= value ? base + half : base;
+                    n -= half;
+                }
+                return *base == value;
+            }
+        }
+
+        /// <summary>
+        /// 許可されていない最初の値の検索
+        /// </summary>
+        /// <param name="values">判定対象の値の列</param>
+        /// <returns>許可されていない最初の値の位置(すべて許可されているときはvalues.size())</returns>
+        std::size_t find_missing(std::span<const T> values) const noexcept {
+            if constexpr (!is_string) {
+                // 数値は独立した探索を一定数ずつ早期脱出なしに行い、パイプライン化およびベクトル化を妨げないようにする
+                constexpr std::size_t block = 8;
+                std::size_t i = 0;
+                for (; i + block <= values.size(); i += block) {
+                    bool ok = true;
+                    for (std::size_t j = 0; j < block; ++j) ok &= this->contains(values[i + j]);
+                    if (!ok) break;
+                }
+                for (; i < values.size(); ++i) {
+                    if (!this->contains(values[i])) return i;
+                }
+                return values.size();
+            }
+            else {
+                for (std::size_t i = 0; i < values.size(); ++i) {
+                    if (!this->contains(values[i])) return i;
+                }
+                return values.size();
+            }
+        }
+
+        /// <summary>
+        /// 許可された値の数の取得
+        /// </summary>
+        /// <returns></returns>
+        std::size_t size() const noexcept {
+            if constexpr (is_string) return this->_offsets.size() - 1;
+            else return this->_sorted.size();
+        }
+
+        /// <summary>
+        /// 許可された値をJSONの配列として出力する(整列済み)
+        /// </summary>
+        /// <param name="json">出力先</param>
+        void write_json(JsonSink& json) const {
+            json.begin_array();
+            for (std::size_t i = 0; i < this->size(); ++i) {
+                if constexpr (is_string) json.value(this->at(i));
+                else json.value(this->_sorted[i]);
+            }
+            json.end_array();
+        }
+    };
+
+    /// <summary>
+    /// optionが保持する引数の設定(引数の数の上限と必須の件数はSchemaTableが保持する)
+    /// </summary>
+    /// <typeparam name="T">引数の型</typeparam>
+    template <class T>
+    class ValueInfo {
+        template <class U> friend class OptionValue;
+
+    protected:
+        /// <summary>
+        /// デフォルト引数
+        /// </summary>
+        std::vector<T> _default_value;
+        /// <summary>
+        /// 引数の制約条件
+        /// </summary>
+        std::function<bool(T)> _constraint;
+        /// <summary>
+        /// 引数の表示名(helpで<_name...[1-上限]>のように表示される)
+        /// </summary>
+        InternedString _name = InternedString::literal("arg");
+        /// <summary>
+        /// ファイルパスとしての検査(PathCheck::CHECKの論理和)
+        /// </summary>
+        std::uint32_t _path_checks = 0;
+        /// <summary>
+        /// ファイルパスとしての検査の実行方法
+        /// </summary>
+        PathCheck::Runner _path_runner = nullptr;
+        /// <summary>
+        /// 引数が一致すべきパターン
+        /// </summary>
+        std::shared_ptr<const ValuePattern> _pattern;
+        /// <summary>
+        /// 引数として許可された値の集合
+        /// </summary>
+        std::shared_ptr<const OneOf<T>> _one_of;
+
+        ValueInfo() {}
+        explicit ValueInfo(std::vector<T> default_value) : _default_value(std::move(default_value)) {}
+
+    public:
+        /// <summary>
+        /// デフォルト引数を持つかの判定
+        /// </summary>
+        /// <returns>デフォルト引数を持つ場合にtrue</returns>
+        bool has_default() const { return !this->_default_value.empty(); }
+
+        /// <summary>
+        /// 文字列を浮動小数点数に変換する
+        /// </summary>
+        /// <param name="str">変換対象の文字列(先頭の空白は読み飛ばす)</param>
+        /// <param name="result">変換結果</param>
+        /// <returns>文字列全体を変換できたときにtrue</returns>
+        /// <remarks>
+        /// ロケールに依存せず最近接偶数丸めで正確に変換する。符号「+」「-」、「inf」「infinity」「nan」(大文字小文字を区別しない)、
+        /// 「0x」から始まる16進数の浮動小数点数を受け付け、表現できる範囲を超える値は変換できないものとする
+        /// </remarks>
+        static bool parse_floating(std::string_view str, T& result) requires std::is_floating_point_v<T> {
+            while (!str.empty() && (str.front() == ' ' || (str.front() >= '\t' && str.front() <= '\r'))) str.remove_prefix(1);
+            bool negative = false;
+            if (!str.empty() && (str.front() == '+' || str.front() == '-')) {
+                negative = str.front() == '-';
+                str.remove_prefix(1);
+            }
+            // from_chars自身は符号「-」のみを受け付けるため符号は上で処理済みとする
+            if (str.empty() || str.front() == '+' || str.front() == '-') return false;
+            const bool hex = str.size() > 2 && str[0] == '0' && (str[1] == 'x' || str[1] == 'X');
+            // 「0x」の直後に符号や「inf」「nan」が続く文字列は16進数の浮動小数点数ではない
+            if (hex && !(std::isxdigit(static_cast<unsigned char>(str[2])) || str[2] == '.')) return false;
+#if defined(__cpp_lib_to_chars) && !defined(COMMAND_LINE_OPTION_NO_FROM_CHARS)
+            auto format = std::chars_format::general;
+            if (hex) {
+                format = std::chars_format::hex;
+                str.remove_prefix(2);
+            }
+            const auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), result, format);
+            if (ec != std::errc() || ptr != str.data() + str.size()) return false;
+#else
+            // from_chars(浮動小数点数)を利用できない処理系ではstrtodで変換する(ストリームは16進数の浮動小数点数を読み込めない)
+            // strtodは先頭の空白を読み飛ばし、小数点に現在のCロケールの文字を用いるため、from_charsと同じ規則になるよう調整する
+            if (std::isspace(static_cast<unsigned char>(str.front()))) return false;
+            std::string buffer(str);
+            const char point = *std::localeconv()->decimal_point;
+            if (point != '.') {
+                if (buffer.find(point) != std::string::npos) return false;
+                std::replace(buffer.begin(), buffer.end(), '.', point);
+            }
+            char* end = nullptr;
+            errno = 0;
+            if constexpr (std::is_same_v<T, float>) result = std::strtof(buffer.c_str(), &end);
+            else if constexpr (std::is_same_v<T, double>) result = std::strtod(buffer.c_str(), &end);
+            else result = std::strtold(buffer.c_str(), &end);
+            if (end != buffer.c_str() + buffer.size() || errno == ERANGE) return false;
+#endif
+            if (negative) result = -result;
+            return true;
+        }
+
+        /// <summary>
+        /// 文字列をValueとして利用可能な型に変換する
+        /// </summary>
+        /// <param name="str_view">変換対象の文字列</param>
+        /// <returns>変換結果</returns>
+        T transform(std::string_view str_view) {
+            if constexpr (std::is_floating_point_v<T>) {
+                T result;
+                if (!parse_floating(str_view, result)) {
+                    throw std::runtime_error(DescriptionCatalog::message("error.conversion", "{0} は型 {1} に変換することはできません", str_view, type_name<T>::value));
+                }
+                return result;
+            }
+            else if constexpr (!std::is_same_v<T, std::string>) {
+                std::istringstream stream{ std::string(str_view) };
+                T result;
+                stream >> result;
+                // 変換できなかった場合は例外を投げる
+                if (!(bool(stream) && (stream.eof() || stream.get() == std::char_traits<char>::eof()))) {
+                    throw std::runtime_error(DescriptionCatalog::message("error.conversion", "{0} は型 {1} に変換することはできません", str_view, type_name<T>::value));
+                }
+
+                return result;
+            }
+            else {
+                return std::string(str_view);
+            }
+        }
+    };
+
+    /// <summary>
+    /// optionに与える引数
+    /// </summary>
+    /// <typeparam name="T">引数の型</typeparam>
+    template <class T>
+    class Value : public ValueInfo<T> {
+        /// <summary>
+        /// 引数の数の上限
+        /// </summary>
+        std::size_t _limit = 1;
+        /// <summary>
+        /// 必須項目となる件数
+        /// </summary>
+        std::size_t _required = 0;
+
+    public:
+        Value() {}
+        Value(const T& x) : ValueInfo<T>(std::vector<T>(1, x)) {}
+        Value(std::initializer_list<T> x) : ValueInfo<T>(std::vector<T>(x)) {}
+
+        /// <summary>
+        /// 引数の制約条件の設定
+        /// </summary>
+        /// <typeparam name="F">引数の制約式の型</typeparam>
+        /// <param name="f">引数の制約式</param>
+        /// <returns></returns>
+        template <class F>
+        Value& constraint(F f) {
+            // デフォルト引数が制約条件を満たしているかのチェック
+            for (const auto& value : this->_default_value) {
+                if (!f(value)) {
+                    throw std::logic_error("デフォルト引数が満たさない制約条件を設定することはできません");
+                }
+            }
+            this->_constraint = f;
+            return *this;
+        }
+
+        /// <summary>
+        /// 引数の数の上限の設定
+        /// </summary>
+        /// <param name="l">引数の数の上限</param>
+        /// <returns></returns>
+        Value& limit(std::size_t l) {
+            if (l == 0) throw std::logic_error("保持する引数の数は0に設定することはできません");
+            if (l < this->_default_value.size()) throw std::logic_error("デフォルト引数の数が引数の数の制限を超過しています");
+            this->_limit = l;
+            return *this;
+        }
+
+        /// <summary>
+        /// 引数の数の上限をなしにする
+        /// </summary>
+        /// <returns></returns>
+        Value& unlimited() {
+            this->_limit = std::numeric_limits<std::size_t>::max();
+            return *this;
+        }
+
+        /// <summary>
+        /// 引数の表示名の設定
+        /// </summary>
+        /// <param name="n">引数の表示名</param>
+        /// <returns></returns>
+        Value& name(InternedString n) {
+            this->_name = n;
+            return *this;
+        }
+
+        /// <summary>
+        /// 必須項目として設定する
+        /// </summary>
+        /// <param name="n">必須項目となる件数</param>
+        /// <returns></returns>
+        Value& required(std::size_t n = std::numeric_limits<std::size_t>::max()) {
+            this->_required = n;
+            return *this;
+        }
+
+        /// <summary>
+        /// 引数として許可された値の集合の設定(他のoptionと共有するときは構築済みの集合を渡す)
+        /// </summary>
+        /// <param name="values">許可された値の集合</param>
+        /// <returns></returns>
+        Value& one_of(std::shared_ptr<const OneOf<T>> values) {
+            if (!values) throw std::invalid_argument("許可された値の集合にnullptrは指定できません");
+            // デフォルト引数が許可された値であるかのチェック
+            if (values->find_missing(this->_default_value) != this->_default_value.size()) {
+                throw std::logic_error("デフォルト引数が含まれない値の集合を設定することはできません");
+            }
+            this->_one_of = std::move(values);
+            return *this;
+        }
+
+        /// <summary>
+        /// 引数として許可された値の集合の設定
+        /// </summary>
+        /// <param name="values">許可する値の一覧</param>
+        /// <returns></returns>
+        template <class Container>
+        Value& one_of(const Container& values) requires requires { std::begin(values); std::end(values); } {
+            return this->one_of(std::make_shared<const OneOf<T>>(values));
+        }
+
+        /// <summary>
+        /// 引数として許可された値の集合の設定
+        /// </summary>
+        /// <param name="values">許可する値の一覧</param>
+        /// <returns></returns>
+        Value& one_of(std::initializer_list<T> values) {
+            return this->one_of(std::make_shared<const OneOf<T>>(values));
+        }
+
+        /// <summary>
+        /// 引数が全体として一致すべきパターンの設定(他のoptionと共有するときは構築済みのパターンを渡す)
+        /// </summary>
+        /// <param name="p">パターン</param>
+        /// <returns></returns>
+        Value& pattern(std::shared_ptr<const ValuePattern> p) requires std::is_same_v<T, std::string> {
+            if (!p) throw std::invalid_argument("パターンにnullptrは指定できません");
+            // デフォルト引数がパターンに一致しているかのチェック
+            for (const auto& value : this->_default_value) {
+                if (!p->match(value)) {
+                    throw std::logic_error("デフォルト引数が一致しないパターンを設定することはできません");
+                }
+            }
+            this->_pattern = std::move(p);
+            return *this;
+        }
+
+        /// <summary>
+        /// 引数が全体として一致すべきパターンの設定(設定時にDFAへ変換される)
+        /// </summary>
+        /// <typeparam name="P">パターンの型(CommandLineOptionPattern.hppを取り込む必要がある)</typeparam>
+        /// <param name="source">パターン(構文はPatternを参照)</param>
+        /// <returns></returns>
+        template <class P = Pattern>
+        Value& pattern(std::string_view source) requires std::is_same_v<T, std::string> {
+            return this->pattern(std::make_shared<const P>(source));
+        }
+
+        /// <summary>
+        /// ファイルパスとしての検査の設定
+        /// </summary>
+        /// <typeparam name="Pool">検査要求の実行方法(既定ではCommandLineOptionPath.hppを取り込む必要がある)</typeparam>
+        /// <param name="checks">PathCheck::CHECKの論理和</param>
+        /// <returns></returns>
+        template <class Pool = PathCheckPool>
+        Value& path(std::uint32_t checks = PathCheck::CHECK::EXISTS) requires std::is_same_v<T, std::string> {
+            this->_path_checks = checks;
+            this->_path_runner = [](std::vector<PathCheck::Request>& requests) { Pool::run(requests); };
+            return *this;
+        }
+
+        /// <summary>
+        /// 定義表に置く行の取得
+        /// </summary>
+        /// <param name="name">接頭辞を除いたoption名</param>
+        /// <param name="kind">optionの種類(SchemaTable::KIND)</param>
+        /// <param name="arg_pattern">引数の記載パターン</param>
+        /// <returns></returns>
+        SchemaTable::Row row(InternedString name, std::uint8_t kind, std::size_t arg_pattern) const {
+            return { name, kind, static_cast<std::uint8_t>(arg_pattern), option::value_type_id<T>(), this->_limit, this->_required };
+        }
+    };
+
+    /// <summary>
+    /// option引数に関する型
+    /// </summary>
+    template <class T>
+    class OptionValue : public OptionValueBase {
+        /// <summary>
+        /// 引数の設定
+        /// </summary>
+        ValueInfo<T> _value_info;
+        /// <summary>
+        /// optionに対する引数
+        /// </summary>
+        std::vector<T> _value;
+
+    protected:
+        /// <summary>
+        /// 引数の表示名の取得
+        /// </summary>
+        /// <returns></returns>
+        std::string_view value_name() const noexcept { return this->_value_info._name.view(); }
+
+        /// <summary>
+        /// 引数の形式とデフォルト引数の説明を追加する
+        /// </summary>
+        /// <param name="arg">追加先</param>
+        /// <param name="limit">引数の数の上限</param>
+        virtual void append_value_description(std::string& arg, std::size_t limit) const {
+            // 引数の形式の取得
+            arg += "<";
+            arg += this->_value_info._name.view();
+            if (limit == std::numeric_limits<std::size_t>::max()) {
+                arg += "...";
+            }
+            else if (limit > 1) {
+                arg += "...[1-" + std::to_string(limit) + "]";
+            }
+            arg += ">";
+            if (this->_value_info.has_default()) {
+                // デフォルト引数をカンマつなぎにする
+                std::stringstream stream;
+                auto& default_value = this->_value_info._default_value;
+                stream << default_value[0];
+                for (std::size_t i = 1; i < default_value.size(); ++i) {
+                    stream << "," << default_value[i];
+                }
+                arg += "(=" + stream.str() + ")";
+            }
+        }
+
+        /// <summary>
+        /// 解析結果の引数(指定がないときはデフォルト引数)をJSONの配列として出力する
+        /// </summary>
+        /// <param name="json">出力先</param>
+        void write_json_values(JsonSink& json) const {
+            const auto& values = this->_value.size() != 0 ? this->_value : this->_value_info._default_value;
+            json.begin_array();
+            for (const auto& x : values) json.value(x);
+            json.end_array();
+        }
+
+        /// <summary>
+        /// 引数の定義をJSONのメンバとして出力する(上限のない件数はnullとする)
+        /// </summary>
+        /// <param name="json">出力先</param>
+        /// <param name="limit">引数の数の上限</param>
+        /// <param name="required">必須の引数の数</param>
+        void write_json_value_schema(JsonSink& json, std::size_t limit, std::size_t required) const {
+            constexpr auto unlimited = std::numeric_limits<std::size_t>::max();
+            json.member("type", type_name<T>::value).member("value_name", this->_value_info._name.view());
+            json.key("limit");
+            if (limit == unlimited) json.value(nullptr);
+            else json.value(limit);
+            json.key("required");
+            if (required == unlimited) json.value(nullptr);
+            else json.value(required);
+            json.key("default").begin_array();
+            for (const auto& x : this->_value_info._default_value) json.value(x);
+            json.end_array();
+            json.member("constraint", static_cast<bool>(this->_value_info._constraint));
+            if (this->_value_info._one_of) {
+                json.key("one_of");
+                this->_value_info._one_of->write_json(json);
+            }
+            if constexpr (std::is_same_v<T, std::string>) {
+                if (this->_value_info._pattern) json.member("pattern", this->_value_info._pattern->source());
+            }
+        }
+
+        /// <summary>
+        /// 引数の追加
+        /// </summary>
+        /// <param name="val">引数を示す文字列</param>
+        void append(std::string_view val) {
+            this->_value.push_back(this->_value_info.transform(val));
+        }
+
+        /// <summary>
+        /// 引数の列を変換して追加する
+        /// </summary>
+        /// <param name="values">引数を示す文字列の列</param>
+        virtual void append_values(std::span<const std::string_view> values) {
+            for (auto val : values) this->append(val);
+        }
+
+        /// <summary>
+        /// 引数の数の取得
+        /// </summary>
+        virtual std::size_t value_num() const { return this->argNum(); }
+
+        /// <summary>
+        /// 引数の検査
+        /// </summary>
+        /// <param name="limit">引数の数の上限</param>
+        /// <param name="required">必須の引数の数(上限を超えない)</param>
+        virtual void validate_values(std::size_t limit, std::size_t required) const {
+            // チェック対象の引数
+            const auto& targets = this->_value.size() != 0 ? this->_value : this->_value_info._default_value;
+
+            // 引数の数のチェック
+            if (targets.size() > limit) {
+                throw std::runtime_error(DescriptionCatalog::message("error.too_many_arguments", "引数の数が多すぎます"));
+            }
+            if (limit == std::numeric_limits<std::size_t>::max() && required == std::numeric_limits<std::size_t>::max()) {
+                // 任意の数の引数を取ることができる場合かつデフォルトの必須の場合は1つのみ必須とする
+                if (this->_value_info._default_value.size() == 0 && targets.size() == 0) {
+                    throw std::runtime_error(DescriptionCatalog::message("error.too_few_arguments", "引数の数が少なすぎます"));
+                }
+            }
+            else {
+                if (targets.size() < required) {
+                    throw std::runtime_error(DescriptionCatalog::message("error.too_few_arguments", "引数の数が少なすぎます"));
+                }
+            }
+
+            // 引数の制約条件のチェック
+            if (this->_value_info._constraint) {
+                for (const auto& target : targets) {
+                    if (!this->_value_info._constraint(target)) {
+                        throw std::runtime_error(DescriptionCatalog::message("error.constraint", "{0} は制約条件を満たしていません", target));
+                    }
+                }
+            }
+
+            // 許可された値の集合のチェック
+            if (this->_value_info._one_of) {
+                if (const auto i = this->_value_info._one_of->find_missing(targets); i != targets.size()) {
+                    throw std::runtime_error(DescriptionCatalog::message("error.one_of", "{0} は許可された値ではありません", targets[i]));
+                }
+            }
+
+            // 引数のパターンのチェック
+            if constexpr (std::is_same_v<T, std::string>) {
+                if (this->_value_info._pattern) {
+                    for (const auto& target : targets) {
+                        if (!this->_value_info._pattern->match(target)) {
+                            throw std::runtime_error(DescriptionCatalog::message("error.pattern", "{0} はパターン {1} に一致しません", target, this->_value_info._pattern->source()));
+                        }
+                    }
+                }
+            }
+        }
+
+        /// <summary>
+        /// ファイルパスとしての検査要求の追加
+        /// </summary>
+        /// <param name="requests">追加先</param>
+        /// <returns>追加した検査要求の実行方法(検査しないときはnullptr)</returns>
+        virtual PathCheck::Runner path_requests(std::vector<PathCheck::Request>& requests) const {
+            if constexpr (std::is_same_v<T, std::string>) {
+                if (this->_value_info._path_checks == 0) return nullptr;
+                const auto& targets = this->_value.size() != 0 ? this->_value : this->_value_info._default_value;
+                for (const auto& target : targets) {
+                    requests.push_back({ target, this->_value_info._path_checks });
+                }
+                return this->_value_info._path_runner;
+            }
+            else {
+                return nullptr;
+            }
+        }
+
+        /// <summary>
+        /// 設定された引数のクリア
+        /// </summary>
+        virtual void clear_values() {
+            this->_value.clear();
+        }
+
+        /// <summary>
+        /// 先頭のn個を残して引数を削除する
+        /// </summary>
+        /// <param name="n">残す引数の数</param>
+        void truncateArg(std::size_t n) {
+            this->_value.erase(this->_value.begin() + std::min(n, this->_value.size()), this->_value.end());
+        }
+
+        /// <summary>
+        /// 引数の数の取得
+        /// </summary>
+        std::size_t argNum() const {
+            return this->_value.size();
+        }
+
+    public:
+        OptionValue(const ValueInfo<T>& value_info) : _value_info(value_info) {}
+
+        /// <summary>
+        /// 保持している値の取得
+        /// </summary>
+        /// <typeparam name="U">std::vector<T></typeparam>
+        /// <typeparam name="type"></typeparam>
+        /// <returns></returns>
+        template <class U, typename std::enable_if<!std::is_same<T, U>::value, std::nullptr_t>::type = nullptr>
+        U as() const {
+            if (this->_value.size() == 0) {
+                // デフォルト引数の検査
+                if (this->_value_info.has_default()) {
+                    return this->_value_info._default_value;
+                }
+                throw std::runtime_error(DescriptionCatalog::message("error.no_argument", "引数が設定されていません"));
+            }
+            return  this->_value;
+        };
+
+        /// <summary>
+        /// 保持している値の取得
+        /// </summary>
+        /// <typeparam name="U">T</typeparam>
+        /// <typeparam name="type"></typeparam>
+        /// <returns></returns>
+        template <class U, typename std::enable_if<std::is_same<T, U>::value, std::nullptr_t>::type = nullptr>
+        U as() const {
+            if (this->_value.size() == 0) {
+                // デフォルト引数の検査
+                if (this->_value_info.has_default()) {
+                    return this->_value_info._default_value[0];
+                }
+                throw std::runtime_error(DescriptionCatalog::message("error.no_argument", "引数が設定されていません"));
+            }
+            return this->_value[0];
+        };
+
+        /// <summary>
+        /// 保持している値(無いときはデフォルト値)を複製せずに参照する
+        /// </summary>
+        /// <returns>値の列への参照(次の解析もしくは初期化まで有効)</returns>
+        std::span<const T> view() const {
+            if (this->_value.size() == 0) {
+                // デフォルト引数の検査
+                if (this->_value_info.has_default()) {
+                    return this->_value_info._default_value;
+                }
+                throw std::runtime_error(DescriptionCatalog::message("error.no_argument", "引数が設定されていません"));
+            }
+            return this->_value;
+        }
+
+        /// <summary>
+        /// 保持している値をムーブして取り出す
+        /// </summary>
+        /// <returns>値の列(デフォルト値はoptionの定義の一部であるため複製を返す)</returns>
+        /// <remarks>取り出した後のoptionは引数が設定されていない状態となる</remarks>
+        std::vector<T> take() {
+            if (this->_value.size() == 0) {
+                // デフォルト引数の検査
+                if (this->_value_info.has_default()) {
+                    return this->_value_info._default_value;
+                }
+                throw std::runtime_error(DescriptionCatalog::message("error.no_argument", "引数が設定されていません"));
+            }
+            std::vector<T> result = std::move(this->_value);
+            this->_value.clear();
+            return result;
+        }
+    };
+
+    /// <summary>
+    /// 引数付きのoption
+    /// </summary>
+    template <class T>
+    class OptionHasValue : public Option, public OptionValue<T>, public OptionHasValueBase {
+    public:
+        OptionHasValue(const Value<T>& value_info, InternedString description) : Option(description), OptionValue<T>(value_info) {
+            if (value_info.has_default()) {
+                this->_use = true;
+            }
+        }
+
+        /// <summary>
+        /// クローンを作成する
+        /// </summary>
+        /// <returns>クローン</returns>
+        virtual OptionBase* clone() const { return new OptionHasValue(*this); }
+
+        /// <summary>
+        /// コマンドライン引数のオプションを解析する
+        /// </summary>
+        /// <param name="offset">コマンドライン引数のオフセット</param>
+        /// <param name="argc">コマンドライン引数の数</param>
+        /// <param name="argv">コマンドライン引数を示す配列</param>
+        /// <returns>解析を実行したときにtrue</returns>
+        virtual bool parse(int& offset, int& argc, const char* argv[]) {
+            if (this->parse_option(*this, offset, argc, argv)) {
+                this->_use = true;
+                return true;
+            }
+            return false;
+        }
+
+        /// <summary>
+        /// トークンを解析するかと後続のトークンから受け取る引数の数の上限を判定する(状態は変更しない)
+        /// </summary>
+        /// <param name="token">optionを示すトークン</param>
+        /// <param name="n">後続のトークンから受け取る引数の数の上限</param>
+        /// <returns>parseがトークンを解析するときにtrue</returns>
+        virtual bool following_values(std::string_view token, std::size_t& n) const {
+            return this->following_option_values(*this, token, n);
+        }
+
+        /// <summary>
+        /// 解析結果の値をJSONとして出力する
+        /// </summary>
+        /// <param name="json">出力先</param>
+        virtual void write_json(JsonSink& json) const { this->write_json_values(json); }
+
+        /// <summary>
+        /// optionの種類と引数の定義をJSONのメンバとして出力する
+        /// </summary>
+        /// <param name="json">出力先</param>
+        virtual void write_json_schema(JsonSink& json) const {
+            json.member("kind", "value");
+            this->write_json_arg_pattern(json, this->arg_pattern());
+            this->write_json_value_schema(json, this->value_limit(), this->value_required());
+        }
+
+        /// <summary>
+        /// 解析を巻き戻すために現在の状態を記録する
+        /// </summary>
+        /// <returns></returns>
+        virtual OptionMark mark() const { return { this->_use, this->argNum() }; }
+
+        /// <summary>
+        /// 記録した状態へ巻き戻す
+        /// </summary>
+        /// <param name="m">markで記録した状態</param>
+        virtual void rewind(const OptionMark& m) {
+            this->_use = m.use;
+            this->truncateArg(m.values);
+        }
+
+        /// <summary>
+        /// コマンドライン解析前の状態へ初期化
+        /// </summary>
+        virtual void init() {
+            this->clear_values();
+        }
+
+        /// <summary>
+        /// 与えられた引数のチェック
+        /// </summary>
+        virtual void validate() {
+            this->validate_values(this->value_limit(), this->value_required());
+        }
+    };
+
+    /// <summary>
+    /// 引数付きのlong option
+    /// </summary>
+    template <class T>
+    class LongOptionHasValue : public LongOption, public OptionValue<T>, public OptionHasValueBase {
+    public:
+        LongOptionHasValue(const Value<T>& value_info, InternedString description) : LongOption(description), OptionValue<T>(value_info) {
+            if (value_info.has_default()) {
+                this->_use = true;
+            }
+        }
+
+        /// <summary>
+        /// クローンを作成する
+        /// </summary>
+        /// <returns>クローン</returns>
+        virtual OptionBase* clone() const { return new LongOptionHasValue(*this); }
+
+        /// <summary>
+        /// コマンドライン引数のオプションを解析する
+        /// </summary>
+        /// <param name="offset">コマンドライン引数のオフセット</param>
+        /// <param name="argc">コマンドライン引数の数</param>
+        /// <param name="argv">コマンドライン引数を示す配列</param>
+        /// <returns>解析を実行したときにtrue</returns>
+        virtual bool parse(int& offset, int& argc, const char* argv[]) {
+            if (this->parse_long_option(*this, offset, argc, argv)) {
+                this->_use = true;
+                return true;
+            }
+            return false;
+        }
+
+        /// <summary>
+        /// トークンを解析するかと後続のトークンから受け取る引数の数の上限を判定する(状態は変更しない)
+        /// </summary>
+        /// <param name="token">long optionを示すトークン</param>
+        /// <param name="n">後続のトークンから受け取る引数の数の上限</param>
+        /// <returns>parseがトークンを解析するときにtrue</returns>
+        virtual bool following_values(std::string_view token, std::size_t& n) const {
+            return this->following_long_option_values(*this, token, n);
+        }
+
+        /// <summary>
+        /// 解析結果の値をJSONとして出力する
+        /// </summary>
+        /// <param name="json">出力先</param>
+        virtual void write_json(JsonSink& json) const { this->write_json_values(json); }
+
+        /// <summary>
+        /// optionの種類と引数の定義をJSONのメンバとして出力する
+        /// </summary>
+        /// <param name="json">出力先</param>
+        virtual void write_json_schema(JsonSink& json) const {
+            json.member("kind", "value");
+            this->write_json_arg_pattern(json, this->arg_pattern());
+            this->write_json_value_schema(json, this->value_limit(), this->value_required());
+        }
+
+        /// <summary>
+        /// 解析を巻き戻すために現在の状態を記録する
+        /// </summary>
+        /// <returns></returns>
+        virtual OptionMark mark() const { return { this->_use, this->argNum() }; }
+
+        /// <summary>
+        /// 記録した状態へ巻き戻す
+        /// </summary>
+        /// <param name="m">markで記録した状態</param>
+        virtual void rewind(const OptionMark& m) {
+            this->_use = m.use;
+            this->truncateArg(m.values);
+        }
+
+        /// <summary>
+        /// コマンドライン解析前の状態へ初期化
+        /// </summary>
+        virtual void init() {
+            this->clear_values();
+        }
+
+        /// <summary>
+        /// 与えられた引数のチェック
+        /// </summary>
+        virtual void validate() {
+            this->validate_values(this->value_limit(), this->value_required());
+        }
+    };
+
+    /// <summary>
+    /// 名前なしオプション
+    /// </summary>
+    template <class T>
+    class UnnamedOption : public OptionBase, public OptionValue<T> {
+        friend class AddOptions;
+        friend class OptionMap;
+        /// <summary>
+        /// trueなら後続の解析を中断する
+        /// </summary>
+        bool _pause = false;
+        /// <summary>
+        /// 名前なしオプションの中での定義順のインデックス
+        /// </summary>
+        std::size_t _slot = 0;
+
+    public:
+        UnnamedOption(const Value<T>& value_info, InternedString description) : OptionBase(description), OptionValue<T>(value_info) {}
+
+        /// <summary>
+        /// クローンを作成する
+        /// </summary>
+        /// <returns>クローン</returns>
+        virtual OptionBase* clone() const { return new UnnamedOption(*this); }
+
+        /// <summary>
+        /// エラーメッセージにおける名前なしオプションの表記の取得
+        /// </summary>
+        /// <returns>「#位置 <引数の表示名>」(位置は1から数える)</returns>
+        virtual std::string unnamed_label() const {
+            return MessageFormat::format("#{0} <{1}>", this->_slot + 1, this->value_name());
+        }
+
+        /// <summary>
+        /// 後続の名前なしオプションに解析が到達しないかの判定
+        /// </summary>
+        /// <returns>引数の数に上限がないもしくは後続の解析を中断する場合にtrue</returns>
+        bool is_terminal() const noexcept {
+            return this->_pause || this->value_limit() == std::numeric_limits<std::size_t>::max();
+        }
+
+        /// <summary>
+        /// コマンドライン引数のオプションを解析する
+        /// </summary>
+        /// <param name="offset">コマンドライン引数のオフセット</param>
+        /// <param name="argc">コマンドライン引数の数</param>
+        /// <param name="argv">コマンドライン引数を示す配列</param>
+        /// <returns>解析を実行したときにtrue</returns>
+        virtual bool parse(int& offset, int& argc, const char* argv[]) {
+            if (this->argNum() < this->value_limit()) {
+                this->append_value_of(*this, argv[offset]);
+                ++offset;
+                this->_use = true;
+                if (this->argNum() == this->value_limit() && this->_pause) {
+                    // 中断をする場合はその旨を設定する
+                    argc = offset;
+                }
+                return true;
+            }
+            return false;
+        }
+
+        /// <summary>
+        /// 解析結果の値をJSONとして出力する
+        /// </summary>
+        /// <param name="json">出力先</param>
+        virtual void write_json(JsonSink& json) const { this->write_json_values(json); }
+
+        /// <summary>
+        /// optionの種類と引数の定義をJSONのメンバとして出力する
+        /// </summary>
+        /// <param name="json">出力先</param>
+        virtual void write_json_schema(JsonSink& json) const {
+            json.member("kind", "unnamed").member("pause", this->_pause);
+            this->write_json_value_schema(json, this->value_limit(), this->value_required());
+        }
+
+        /// <summary>
+        /// 解析を巻き戻すために現在の状態を記録する
+        /// </summary>
+        /// <returns></returns>
+        virtual OptionMark mark() const { return { this->_use, this->argNum() }; }
+
+        /// <summary>
+        /// 記録した状態へ巻き戻す
+        /// </summary>
+        /// <param name="m">markで記録した状態</param>
+        virtual void rewind(const OptionMark& m) {
+            this->_use = m.use;
+            this->truncateArg(m.values);
+        }
+
+        /// <summary>
+        /// コマンドライン解析前の状態へ初期化
+        /// </summary>
+        virtual void init() {
+            this->clear_values();
+        }
+
+        /// <summary>
+        /// 与えられた引数のチェック
+        /// </summary>
+        virtual void validate() {
+            this->validate_values(this->value_limit(), this->value_required());
+        }
+    };
+
+    /// <summary>
+    /// 解析結果のうちoptionの外で集約して保持する状態
+    /// </summary>
+    class ParseState {
+        /// <summary>
+        /// 計数optionの出現回数
+        /// </summary>
+        std::vector<std::uint32_t> _counts;
+        /// <summary>
+        /// 否定可能なoptionの値(1optionにつき1ビット)
+        /// </summary>
+        std::vector<std::uint64_t> _flags;
+        /// <summary>
+        /// 否定可能なoptionのデフォルト値(1optionにつき1ビット)
+        /// </summary>
+        std::vector<std::uint64_t> _default_flags;
+        /// <summary>
+        /// 否定可能なoptionの数
+        /// </summary>
+        std::size_t _flag_num = 0;
+
+    public:
+        /// <summary>
+        /// 計数optionの領域の確保
+        /// </summary>
+        /// <returns>確保した領域のインデックス</returns>
+        std::size_t add_counter() {
+            this->_counts.push_back(0);
+            return this->_counts.size() - 1;
+        }
+
+        /// <summary>
+        /// 否定可能なoptionの領域の確保
+        /// </summary>
+        /// <param name="default_value">デフォルト値</param>
+        /// <returns>確保した領域のインデックス</returns>
+        std::size_t add_flag(bool default_value) {
+            std::size_t i = this->_flag_num++;
+            if ((i >> 6) == this->_flags.size()) {
+                this->_flags.push_back(0);
+                this->_default_flags.push_back(0);
+            }
+            if (default_value) {
+                this->_flags[i >> 6] |= std::uint64_t(1) << (i & 63);
+                this->_default_flags[i >> 6] |= std::uint64_t(1) << (i & 63);
+            }
+            return i;
+        }
+
+        /// <summary>
+        /// 出現回数の取得
+        /// </summary>
+        /// <param name="i">計数optionのインデックス</param>
+        /// <returns></returns>
+        std::uint32_t count(std::size_t i) const noexcept { return this->_counts[i]; }
+
+        /// <summary>
+        /// 出現回数を1つ増やす(上限で飽和する)
+        /// </summary>
+        /// <param name="i">計数optionのインデックス</param>
+        void increment(std::size_t i) noexcept {
+            if (this->_counts[i] != std::numeric_limits<std::uint32_t>::max()) {
+                ++this->_counts[i];
+            }
+        }
+
+        /// <summary>
+        /// 出現回数の設定
+        /// </summary>
+        /// <param name="i">計数optionのインデックス</param>
+        /// <param name="n">設定する出現回数</param>
+        void set_count(std::size_t i, std::uint32_t n) noexcept { this->_counts[i] = n; }
+
+        /// <summary>
+        /// 真偽値の取得
+        /// </summary>
+        /// <param name="i">否定可能なoptionのインデックス</param>
+        /// <returns></returns>
+        bool flag(std::size_t i) const noexcept { return ((this->_flags[i >> 6] >> (i & 63)) & 1) != 0; }
+
+        /// <summary>
+        /// 真偽値の設定
+        /// </summary>
+        /// <param name="i">否定可能なoptionのインデックス</param>
+        /// <param name="value">設定する値</param>
+        void set_flag(std::size_t i, bool value) noexcept {
+            const std::uint64_t mask = std::uint64_t(1) << (i & 63);
+            if (value) {
+                this->_flags[i >> 6] |= mask;
+            }
+            else {
+                this->_flags[i >> 6] &= ~mask;
+            }
+        }
+
+        /// <summary>
+        /// コマンドライン解析前の状態へ初期化
+        /// </summary>
+        void init() {
+            std::fill(this->_counts.begin(), this->_counts.end(), 0);
+            this->_flags = this->_default_flags;
+        }
+    };
+
+    /// <summary>
+    /// 計数optionもしくは否定可能なoptionの基底
+    /// </summary>
+    class FlagOptionBase {
+        friend class OptionMap;
+    protected:
+        /// <summary>
+        /// 値を保持する状態
+        /// </summary>
+        ParseState* _state = nullptr;
+        /// <summary>
+        /// 状態における値のインデックス
+        /// </summary>
+        std::size_t _slot = 0;
+        /// <summary>
+        /// 否定可能なoptionであるときにtrue
+        /// </summary>
+        bool _negatable;
+        /// <summary>
+        /// 否定可能なoptionのデフォルト値
+        /// </summary>
+        bool _default_value;
+
+        /// <summary>
+        /// 値を保持する領域を状態に確保する
+        /// </summary>
+        /// <param name="state">値を保持する状態</param>
+        void attach(ParseState& state) {
+            this->_state = &state;
+            this->_slot = this->_negatable ? state.add_flag(this->_default_value) : state.add_counter();
+        }
+
+    public:
+        FlagOptionBase(bool negatable, bool default_value) : _negatable(negatable), _default_value(default_value) {}
+
+        /// <summary>
+        /// 出現回数の取得(否定可能なoptionでは真偽値を0か1で返す)
+        /// </summary>
+        /// <returns></returns>
+        std::size_t count() const noexcept {
+            return this->_negatable ? std::size_t(this->_state->flag(this->_slot)) : this->_state->count(this->_slot);
+        }
+
+        /// <summary>
+        /// 否定可能なoptionであるかの判定
+        /// </summary>
+        /// <returns></returns>
+        bool negatable() const noexcept { return this->_negatable; }
+
+        /// <summary>
+        /// 出現回数もしくは真偽値を設定する
+        /// </summary>
+        /// <param name="n">countで取得した値</param>
+        void restore_count(std::uint64_t n) noexcept {
+            if (this->_negatable) this->_state->set_flag(this->_slot, n != 0);
+            else this->_state->set_count(this->_slot, static_cast<std::uint32_t>(n));
+        }
+    };
+
+    /// <summary>
+    /// 出現回数を数えるoption
+    /// </summary>
+    class CountOption : public Option, public FlagOptionBase {
+    public:
+        CountOption(InternedString description) : Option(description), FlagOptionBase(false, false) {}
+
+        /// <summary>
+        /// クローンを作成する
+        /// </summary>
+        /// <returns>クローン</returns>
+        virtual OptionBase* clone() const { return new CountOption(*this); }
+
+        /// <summary>
+        /// コマンドライン引数のオプションを解析する
+        /// </summary>
+        /// <param name="offset">コマンドライン引数のオフセット</param>
+        /// <param name="argc">コマンドライン引数の数</param>
+        /// <param name="argv">コマンドライン引数を示す配列</param>
+        /// <returns>解析を実行したときにtrue</returns>
+        virtual bool parse(int& offset, [[maybe_unused]] int& argc, const char* argv[]) {
+            if (this->match_name(argv[offset])) {
+                this->_state->increment(this->_slot);
+                ++offset;
+                return true;
+            }
+            return false;
+        }
+
+        /// <summary>
+        /// オプションが利用されているかの取得
+        /// </summary>
+        /// <returns></returns>
+        virtual bool use() const noexcept { return this->count() != 0; }
+
+        /// <summary>
+        /// 解析を巻き戻すために現在の状態を記録する
+        /// </summary>
+        /// <returns></returns>
+        virtual OptionMark mark() const { return { this->_use, 0, this->count() }; }
+
+        /// <summary>
+        /// 記録した状態へ巻き戻す
+        /// </summary>
+        /// <param name="m">markで記録した状態</param>
+        virtual void rewind(const OptionMark& m) { this->restore_count(m.state); }
+
+        /// <summary>
+        /// 解析結果の値をJSONとして出力する
+        /// </summary>
+        /// <param name="json">出力先</param>
+        virtual void write_json(JsonSink& json) const { json.value(this->count()); }
+
+        /// <summary>
+        /// optionの種類と引数の定義をJSONのメンバとして出力する
+        /// </summary>
+        /// <param name="json">出力先</param>
+        virtual void write_json_schema(JsonSink& json) const { json.member("kind", "count"); }
+    };
+
+    /// <summary>
+    /// 出現回数を数えるlong option
+    /// </summary>
+    class CountLongOption : public LongOption, public FlagOptionBase {
+    public:
+        CountLongOption(InternedString description) : LongOption(description), FlagOptionBase(false, false) {}
+
+        /// <summary>
+        /// クローンを作成する
+        /// </summary>
+        /// <returns>クローン</returns>
+        virtual OptionBase* clone() const { return new CountLongOption(*this); }
+
+        /// <summary>
+        /// コマンドライン引数のオプションを解析する
+        /// </summary>
+        /// <param name="offset">コマンドライン引数のオフセット</param>
+        /// <param name="argc">コマンドライン引数の数</param>
+        /// <param name="argv">コマンドライン引数を示す配列</param>
+        /// <returns>解析を実行したときにtrue</returns>
+        virtual bool parse(int& offset, [[maybe_unused]] int& argc, const char* argv[]) {
+            if (this->match_name(argv[offset])) {
+                this->_state->increment(this->_slot);
+                ++offset;
+                return true;
+            }
+            return false;
+        }
+
+        /// <summary>
+        /// オプションが利用されているかの取得
+        /// </summary>
+        /// <returns></returns>
+        virtual bool use() const noexcept { return this->count() != 0; }
+
+        /// <summary>
+        /// 解析を巻き戻すために現在の状態を記録する
+        /// </summary>
+        /// <returns></returns>
+        virtual OptionMark mark() const { return { this->_use, 0, this->count() }; }
+
+        /// <summary>
+        /// 記録した状態へ巻き戻す
+        /// </summary>
+        /// <param name="m">markで記録した状態</param>
+        virtual void rewind(const OptionMark& m) { this->restore_count(m.state); }
+
+        /// <summary>
+        /// 解析結果の値をJSONとして出力する
+        /// </summary>
+        /// <param name="json">出力先</param>
+        virtual void write_json(JsonSink& json) const { json.value(this->count()); }
+
+        /// <summary>
+        /// optionの種類と引数の定義をJSONのメンバとして出力する
+        /// </summary>
+        /// <param name="json">出力先</param>
+        virtual void write_json_schema(JsonSink& json) const { json.member("kind", "count"); }
+    };
+
+    /// <summary>
+    /// --no-による否定が可能な真偽値のlong option
+    /// </summary>
+    class NegatableLongOption : public LongOption, public FlagOptionBase {
+    public:
+        NegatableLongOption(InternedString description, bool default_value) : LongOption(description), FlagOptionBase(true, default_value) {}
+
+        /// <summary>
+        /// クローンを作成する
+        /// </summary>
+        /// <returns>クローン</returns>
+        virtual OptionBase* clone() const { return new NegatableLongOption(*this); }
+
+        /// <summary>
+        /// --no-を除いた名前がoption名もしくはlong optionの別名に一致するかの判定
+        /// </summary>
+        /// <param name="str">--no-を除いた名前</param>
+        /// <returns></returns>
+        bool match_negated_name(std::string_view str) const {
+            if (this->name() == str) {
+                return true;
+            }
+            for (const auto& alias : this->_aliases) {
+                if (alias.starts_with("--") && alias.substr(2) == str) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /// <summary>
+        /// コマンドライン引数のオプションを解析する
+        /// </summary>
+        /// <param name="offset">コマンドライン引数のオフセット</param>
+        /// <param name="argc">コマンドライン引数の数</param>
+        /// <param name="argv">コマンドライン引数を示す配列</param>
+        /// <returns>解析を実行したときにtrue</returns>
+        virtual bool parse(int& offset, [[maybe_unused]] int& argc, const char* argv[]) {
+            const auto str = std::string_view{ argv[offset] };
+            if (this->match_name(str)) {
+                this->_state->set_flag(this->_slot, true);
+                ++offset;
+                return true;
+            }
+            if (str.starts_with("--no-") && this->match_negated_name(str.substr(5))) {
+                this->_state->set_flag(this->_slot, false);
+                ++offset;
+                return true;
+            }
+            return false;
+        }
+
+        /// <summary>
+        /// トークンを解析するかと後続のトークンから受け取る引数の数の上限を判定する(状態は変更しない)
+        /// </summary>
+        /// <param name="token">optionもしくはlong optionを示すトークン</param>
+        /// <param name="n">後続のトークンから受け取る引数の数の上限</param>
+        /// <returns>parseがトークンを解析するときにtrue</returns>
+        virtual bool following_values(std::string_view token, std::size_t& n) const {
+            n = 0;
+            return this->match_name(token) || (token.starts_with("--no-") && this->match_negated_name(token.substr(5)));
+        }
+
+        /// <summary>
+        /// optionの種類と引数の定義をJSONのメンバとして出力する
+        /// </summary>
+        /// <param name="json">出力先</param>
+        virtual void write_json_schema(JsonSink& json) const { json.member("kind", "negatable").member("default", this->_default_value); }
+
+        /// <summary>
+        /// オプションが利用されているかの取得(真偽値そのものを返す)
+        /// </summary>
+        /// <returns></returns>
+        virtual bool use() const noexcept { return this->count() != 0; }
+
+        /// <summary>
+        /// 解析を巻き戻すために現在の状態を記録する
+        /// </summary>
+        /// <returns></returns>
+        virtual OptionMark mark() const { return { this->_use, 0, this->count() }; }
+
+        /// <summary>
+        /// 記録した状態へ巻き戻す
+        /// </summary>
+        /// <param name="m">markで記録した状態</param>
+        virtual void rewind(const OptionMark& m) { this->restore_count(m.state); }
+    };
+
+    /// <summary>
+    /// 出現回数を数えるoptionであることを示す型
+    /// </summary>
+    struct Counter {};
+
+    /// <summary>
+    /// --no-による否定が可能な真偽値のoptionであることを示す型
+    /// </summary>
+    class Negatable {
+        friend class AddOptions;
+        /// <summary>
+        /// デフォルト値
+        /// </summary>
+        bool _default_value;
+    public:
+        explicit Negatable(bool default_value = false) : _default_value(default_value) {}
+    };
+
+    /// <summary>
+    /// コマンドラインオプションの解析結果を取得するためのクラス
+    /// </summary>
+    class OptionWrapper {
+    protected:
+        std::shared_ptr<OptionBase> _option;
+
+    private:
+
+        // 型Tがvalue_typeをもつならその型に変換
+        template <class T, class = void>
+        struct to_value_type {
+            using type = T;
+        };
+        // std::stringは例外(クラス内での明示的特殊化はGCCで受け付けられないため部分特殊化の条件で除外する)
+        template <class T>
+        struct to_value_type<T, std::enable_if_t<!std::is_same_v<T, std::string>, std::void_t<typename T::value_type>>> {
+            using type = typename T::value_type;
+        };
+
+    protected:
+        /// <summary>
+        /// 型Tの引数を保持するoptionとして参照する
+        /// </summary>
+        template <class T>
+        OptionValue<T>* option_value() const {
+            OptionValue<T>* p = dynamic_cast<OptionValue<T>*>(this->_option.get());
+            if (p == nullptr) {
+                throw std::logic_error(MessageFormat::format("option {0} から型 {1} な引数を受け取ることはできません", this->_option->full_name(), type_name<T>::value));
+            }
+            return p;
+        }
+    public:
+        OptionWrapper(const std::shared_ptr<OptionBase>& option) : _option(option) {}
+
+        explicit operator bool() const noexcept { return this->_option->use(); }
+
+        /// <summary>
+        /// 計数optionの出現回数の取得(否定可能なoptionでは真偽値を0か1で返す)
+        /// </summary>
+        /// <returns></returns>
+        std::size_t count() const {
+            auto p = dynamic_cast<const FlagOptionBase*>(this->_option.get());
             if (p == nullptr) {
-                throw std::logic_error(std::format("option {0} から型 {1} な引数を受け取ることはできません", this->_option->full_name(), type_name<value_type>::value));
+                throw std::logic_error(MessageFormat::format("option {0} は計数optionではありません", this->_option->full_name()));
+            }
+            return p->count();
+        }
+
+        // optionの引数を型Tとして取得する(Tがコンテナであるときはpush_backで要素を追加可能なものであるとする)
+        template <class T>
+        T as() const {
+            if constexpr (std::is_same_v<T, bool>) {
+                // 計数optionもしくは否定可能なoptionの真偽値
+                if (dynamic_cast<const FlagOptionBase*>(this->_option.get()) != nullptr) {
+                    return this->_option->use();
+                }
+            }
+            auto p = this->option_value<typename to_value_type<T>::type>();
+            try {
+                return p->template as<T>();
+            }
+            catch (const std::runtime_error& e) {
+                throw std::runtime_error(DescriptionCatalog::message("error.option", "option {0} は{1}", this->_option->full_name(), e.what()));
+            }
+        }
+
+        // optionの引数の列を複製せずに参照する(参照は次の解析もしくは初期化まで有効)
+        template <class T>
+        std::span<const T> view() const {
+            auto p = this->option_value<T>();
+            try {
+                return p->view();
+            }
+            catch (const std::runtime_error& e) {
+                throw std::runtime_error(DescriptionCatalog::message("error.option", "option {0} は{1}", this->_option->full_name(), e.what()));
+            }
+        }
+
+    };
+
+    /// <summary>
+    /// 解析結果を変更できるコマンドラインオプションの解析結果を取得するためのクラス(非constなOptionMapからのみ取得できる)
+    /// </summary>
+    class MutableOptionWrapper : public OptionWrapper {
+    public:
+        explicit MutableOptionWrapper(const OptionWrapper& wrapper) : OptionWrapper(wrapper) {}
+
+        // optionの引数の列をムーブして取り出す(取り出した後のoptionは引数が設定されていない状態となる)
+        template <class T>
+        std::vector<T> take() const {
+            auto p = this->option_value<T>();
+            try {
+                auto result = p->take();
+                // 引数と合わせて使用の有無も解析前の状態へ戻す(デフォルト値は定義の一部であるため残る)
+                this->_option->rewind({});
+                return result;
+            }
+            catch (const std::runtime_error& e) {
+                throw std::runtime_error(DescriptionCatalog::message("error.option", "option {0} は{1}", this->_option->full_name(), e.what()));
+            }
+        }
+    };
+
+    /// <summary>
+    /// 表示幅に関するユーティリティ
+    /// </summary>
+    class DisplayWidth {
+    public:
+        /// <summary>
+        /// UTF-8の文字列の先頭の1文字を復号する
+        /// </summary>
+        /// <param name="str">復号対象の文字列(空でないこと)</param>
+        /// <param name="len">復号した文字のバイト数の格納先</param>
+        /// <returns>コードポイント(不正なバイト列のときは先頭の1バイトの値)</returns>
+        static constexpr char32_t decode(std::string_view str, std::size_t& len) noexcept {
+            const auto lead = static_cast<unsigned char>(str[0]);
+            std::size_t n = 0;
+            char32_t cp = 0;
+            if (lead < 0x80) { len = 1; return lead; }
+            else if ((lead & 0xE0) == 0xC0) { n = 2; cp = lead & 0x1F; }
+            else if ((lead & 0xF0) == 0xE0) { n = 3; cp = lead & 0x0F; }
+            else if ((lead & 0xF8) == 0xF0) { n = 4; cp = lead & 0x07; }
+            else { len = 1; return lead; }
+            if (str.size() < n) { len = 1; return lead; }
+            for (std::size_t i = 1; i < n; ++i) {
+                const auto c = static_cast<unsigned char>(str[i]);
+                if ((c & 0xC0) != 0x80) { len = 1; return lead; }
+                cp = (cp << 6) | (c & 0x3F);
+            }
+            len = n;
+            return cp;
+        }
+
+        /// <summary>
+        /// コードポイントの表示幅を取得する(East Asian WidthがWもしくはFの文字は2、結合文字と制御文字は0)
+        /// </summary>
+        /// <param name="cp">コードポイント</param>
+        /// <returns></returns>
+        static constexpr std::size_t of(char32_t cp) noexcept {
+            if (cp < 0x20 || (0x7F <= cp && cp < 0xA0)) return 0;
+            if ((0x0300 <= cp && cp <= 0x036F) || (0x200B <= cp && cp <= 0x200F) || (0xFE00 <= cp && cp <= 0xFE0F)) return 0;
+            if (cp < 0x1100) return 1;
+            if ((cp <= 0x115F) ||
+                (0x2E80 <= cp && cp <= 0x303E) ||
+                (0x3041 <= cp && cp <= 0x33FF) ||
+                (0x3400 <= cp && cp <= 0x4DBF) ||
+                (0x4E00 <= cp && cp <= 0x9FFF) ||
+                (0xA000 <= cp && cp <= 0xA4CF) ||
+                (0xAC00 <= cp && cp <= 0xD7A3) ||
+                (0xF900 <= cp && cp <= 0xFAFF) ||
+                (0xFE30 <= cp && cp <= 0xFE4F) ||
+                (0xFF00 <= cp && cp <= 0xFF60) ||
+                (0xFFE0 <= cp && cp <= 0xFFE6) ||
+                (0x1F300 <= cp && cp <= 0x1F64F) ||
+                (0x1F900 <= cp && cp <= 0x1F9FF) ||
+                (0x20000 <= cp && cp <= 0x3FFFD)) return 2;
+            return 1;
+        }
+
+        /// <summary>
+        /// UTF-8の文字列の表示幅を取得する
+        /// </summary>
+        /// <param name="str">対象の文字列</param>
+        /// <returns></returns>
+        static constexpr std::size_t of(std::string_view str) noexcept {
+            std::size_t width = 0;
+            for (std::size_t pos = 0, len = 0; pos < str.size(); pos += len) {
+                width += of(decode(str.substr(pos), len));
+            }
+            return width;
+        }
+    };
+
+    /// <summary>
+    /// optionの説明の出力先
+    /// </summary>
+    class DescriptionSink {
+        friend class OptionMap;
+
+    protected:
+        /// <summary>
+        /// flushまで参照先が有効な文字列を出力する(既定では複製して出力する)
+        /// </summary>
+        /// <param name="str">出力する文字列</param>
+        /// <remarks>
+        /// 寿命を保証できる名前や説明の文字列を複製せずに渡すためのOptionMap内部の経路である
+        /// </remarks>
+        virtual void write_stable(std::string_view str) { this->write(str); }
+
+    public:
+        virtual ~DescriptionSink() {}
+
+        /// <summary>
+        /// 文字列を出力する(strは呼び出しの後に破棄してよい)
+        /// </summary>
+        /// <param name="str">出力する文字列</param>
+        virtual void write(std::string_view str) = 0;
+
+        /// <summary>
+        /// 出力を確定する
+        /// </summary>
+        virtual void flush() {}
+
+        /// <summary>
+        /// 空白スペースを出力する
+        /// </summary>
+        /// <param name="n">空白スペースの数</param>
+        void spaces(std::size_t n) {
+            static constexpr std::string_view blank = "                                                                ";
+            for (; n > blank.size(); n -= blank.size()) this->write_stable(blank);
+            this->write_stable(blank.substr(0, n));
+        }
+    };
+
+    /// <summary>
+    /// std::stringへ出力するDescriptionSink
+    /// </summary>
+    class StringDescriptionSink : public DescriptionSink {
+        std::string& _str;
+    public:
+        explicit StringDescriptionSink(std::string& str) : _str(str) {}
+
+        void write(std::string_view str) override { this->_str.append(str); }
+    };
+
+    /// <summary>
+    /// FILE*へ出力するDescriptionSink(バッファリングはstdioに任せる)
+    /// </summary>
+    class FileDescriptionSink : public DescriptionSink {
+        std::FILE* _fp;
+    public:
+        explicit FileDescriptionSink(std::FILE* fp) : _fp(fp) {}
+
+        void write(std::string_view str) override {
+            if (!str.empty() && std::fwrite(str.data(), 1, str.size(), this->_fp) != str.size()) {
+                throw std::runtime_error(DescriptionCatalog::message("error.write_description", "説明の出力に失敗しました"));
+            }
+        }
+        void flush() override { std::fflush(this->_fp); }
+    };
+
+    // CommandLineOptionTerminal.hppで定義する
+    class FdDescriptionSink;
+    class TerminalWidth;
+
+    /// <summary>
+    /// optionの使用回数の記録先
+    /// </summary>
+    /// <remarks>
+    /// 共有メモリで集計する実装はCommandLineOptionUsage.hppのUsageCountersである
+    /// </remarks>
+    class UsageRecorder {
+    public:
+        virtual ~UsageRecorder() {}
+
+        /// <summary>
+        /// 使用回数を1つ増やす
+        /// </summary>
+        /// <param name="i">optionの定義順のインデックス</param>
+        virtual void add(std::size_t i) noexcept = 0;
+    };
+
+    // CommandLineOptionUsage.hppで定義する
+    class UsageCounters;
+
+    /// <summary>
+    /// option名からoptionを検索する構造
+    /// </summary>
+    /// <remarks>
+    /// optionの数と名前の分布から検索方法を選択する。名前が少なく先頭と末尾の4バイトと長さによる署名がほぼ重複しないときは
+    /// 署名の配列を分岐なしに比較する線形探索(コンパイラによりベクトル化される)とし、それ以外はハッシュ表とする。
+    /// 計測では16個以下で線形探索がハッシュ表より速く、24個以上ではハッシュ表が速かった。
+    /// 整列済み配列の二分探索とトライはいずれの数でも線形探索とハッシュ表の速い方より遅く、共通の接頭辞をもつ名前ではトライが特に遅かったため選択肢に含めない
+    /// </remarks>
+    class OptionLookup {
+    public:
+        /// <summary>
+        /// option名からoptionを引くための索引(同名のoptionは登録順に保持する)
+        /// </summary>
+        /// <remarks>
+        /// 全ての登録を1つの配列に置き、同名の登録は次の登録の位置で連結する。名前から先頭の登録へはオープンアドレス法のハッシュ表で引く。
+        /// 名前ごとの一覧やハッシュ表の節点を個別に確保しないため、登録による確保は配列を伸長するときのみとなる
+        /// </remarks>
+        class Index {
+            static constexpr std::uint32_t npos = std::numeric_limits<std::uint32_t>::max();
+
+            /// <summary>
+            /// 登録
+            /// </summary>
+            struct Entry {
+                std::string_view key;
+                std::shared_ptr<OptionBase> option;
+                /// <summary>
+                /// 同名の次の登録の位置
+                /// </summary>
+                std::uint32_t next = npos;
+            };
+
+            /// <summary>
+            /// 登録の一覧(登録順)
+            /// </summary>
+            std::vector<Entry> _entries;
+            /// <summary>
+            /// 名前ごとの先頭と末尾の登録の位置(名前の初出順)
+            /// </summary>
+            std::vector<std::pair<std::uint32_t, std::uint32_t>> _names;
+            /// <summary>
+            /// ハッシュ表(_namesの位置に1を加えた値、0は空き。大きさは2の冪)
+            /// </summary>
+            std::vector<std::uint32_t> _slots;
+
+            /// <summary>
+            /// 名前が置かれているもしくは置かれるべきハッシュ表の位置
+            /// </summary>
+            std::size_t slot_of(std::string_view key) const noexcept {
+                const std::size_t mask = this->_slots.size() - 1;
+                for (std::size_t i = std::hash<std::string_view>{}(key) & mask;; i = (i + 1) & mask) {
+                    const auto slot = this->_slots[i];
+                    if (slot == 0 || this->_entries[this->_names[slot - 1].first].key == key) return i;
+                }
+            }
+
+            void rehash(std::size_t size) {
+                this->_slots.assign(size, 0);
+                for (std::size_t i = 0; i < this->_names.size(); ++i) {
+                    this->_slots[this->slot_of(this->_entries[this->_names[i].first].key)] = static_cast<std::uint32_t>(i + 1);
+                }
+            }
+
+        public:
+            /// <summary>
+            /// 同名のoptionの一覧(索引を変更するまで有効)
+            /// </summary>
+            class Entries {
+                const std::vector<Entry>* _entries = nullptr;
+                std::uint32_t _first = npos;
+
+            public:
+                class iterator {
+                    const std::vector<Entry>* _entries = nullptr;
+                    std::uint32_t _i = npos;
+                public:
+                    constexpr iterator() noexcept {}
+                    constexpr iterator(const std::vector<Entry>* entries, std::uint32_t i) noexcept : _entries(entries), _i(i) {}
+                    const std::shared_ptr<OptionBase>& operator*() const noexcept { return (*this->_entries)[this->_i].option; }
+                    iterator& operator++() noexcept {
+                        this->_i = (*this->_entries)[this->_i].next;
+                        return *this;
+                    }
+                    bool operator==(const iterator& other) const noexcept { return this->_i == other._i; }
+                };
+
+                constexpr Entries() noexcept {}
+                constexpr Entries(const std::vector<Entry>& entries, std::uint32_t first) noexcept : _entries(&entries), _first(first) {}
+
+                bool empty() const noexcept { return this->_first == npos; }
+                iterator begin() const noexcept { return iterator(this->_entries, this->_first); }
+                iterator end() const noexcept { return iterator(this->_entries, npos); }
+            };
+
+            /// <summary>
+            /// optionを名前で登録する(同名のoptionの後に加える)
+            /// </summary>
+            /// <param name="key">接頭辞を除いた名前(索引の破棄まで有効な文字列)</param>
+            /// <param name="option">登録するoption</param>
+            void add(std::string_view key, std::shared_ptr<OptionBase> option) {
+                if ((this->_names.size() + 1) * 2 > this->_slots.size()) {
+                    this->rehash(std::max<std::size_t>(16, this->_slots.size() * 2));
+                }
+                const auto position = static_cast<std::uint32_t>(this->_entries.size());
+                const std::size_t i = this->slot_of(key);
+                // 追加の途中で確保に失敗しないよう先に倍へ伸長しておく
+                if (this->_names.size() == this->_names.capacity()) this->_names.reserve(std::max<std::size_t>(16, this->_names.size() * 2));
+                this->_entries.push_back({ key, std::move(option) });
+                if (this->_slots[i] == 0) {
+                    this->_names.emplace_back(position, position);
+                    this->_slots[i] = static_cast<std::uint32_t>(this->_names.size());
+                }
+                else {
+                    auto& name = this->_names[this->_slots[i] - 1];
+                    this->_entries[name.second].next = position;
+                    name.second = position;
+                }
+            }
+
+            /// <summary>
+            /// 名前に該当するoptionの一覧
+            /// </summary>
+            /// <param name="key">接頭辞を除いた名前</param>
+            /// <returns>該当しないときは空の一覧</returns>
+            Entries find(std::string_view key) const {
+                if (this->_slots.empty()) return Entries();
+                const auto slot = this->_slots[this->slot_of(key)];
+                return slot == 0 ? Entries() : Entries(this->_entries, this->_names[slot - 1].first);
+            }
+
+            bool contains(std::string_view key) const { return !this->find(key).empty(); }
+
+            /// <summary>
+            /// 名前の数の取得
+            /// </summary>
+            /// <returns></returns>
+            std::size_t size() const noexcept { return this->_names.size(); }
+
+            /// <summary>
+            /// 初出順にi番目の名前の取得
+            /// </summary>
+            std::string_view key(std::size_t i) const noexcept { return this->_entries[this->_names[i].first].key; }
+
+            /// <summary>
+            /// 初出順にi番目の名前のoptionの一覧の取得
+            /// </summary>
+            Entries entries(std::size_t i) const noexcept { return Entries(this->_entries, this->_names[i].first); }
+        };
+        /// <summary>
+        /// 同名のoptionの一覧
+        /// </summary>
+        using Entries = Index::Entries;
+
+        /// <summary>
+        /// 検索方法
+        /// </summary>
+        struct STRATEGY {
+            /// <summary>
+            /// 署名の配列の線形探索
+            /// </summary>
+            static constexpr std::size_t LINEAR = 0;
+            /// <summary>
+            /// ハッシュ表
+            /// </summary>
+            static constexpr std::size_t HASH = 1;
+        };
+
+        /// <summary>
+        /// 線形探索とする名前の数の上限
+        /// </summary>
+        static constexpr std::size_t linear_limit = 16;
+
+    private:
+        std::size_t _strategy = STRATEGY::LINEAR;
+        /// <summary>
+        /// 構築元の索引
+        /// </summary>
+        const Index* _index = nullptr;
+        /// <summary>
+        /// 線形探索における名前の署名
+        /// </summary>
+        std::array<std::uint64_t, linear_limit> _signatures{};
+        std::array<std::string_view, linear_limit> _keys{};
+        std::array<Entries, linear_limit> _entries{};
+        std::size_t _size = 0;
+
+        /// <summary>
+        /// 名前の先頭と末尾の4バイトと長さによる署名
+        /// </summary>
+        /// <param name="key">名前</param>
+        /// <returns></returns>
+        static std::uint64_t signature(std::string_view key) noexcept {
+            std::uint32_t head = 0, tail = 0;
+            if (key.size() >= 4) {
+                std::memcpy(&head, key.data(), 4);
+                std::memcpy(&tail, key.data() + key.size() - 4, 4);
+            }
+            else {
+                std::memcpy(&head, key.data(), key.size());
+            }
+            return (std::uint64_t(head) | (std::uint64_t(tail) << 32)) ^ (std::uint64_t(key.size()) << 59) ^ key.size();
+        }
+
+    public:
+        /// <summary>
+        /// 索引から検索の構造を構築する(索引を変更したときは構築し直す必要がある)
+        /// </summary>
+        /// <param name="index">構築元の索引</param>
+        void build(const Index& index) {
+            this->_index = &index;
+            this->_size = index.size();
+            this->_strategy = STRATEGY::HASH;
+            if (this->_size > linear_limit) {
+                return;
+            }
+            std::size_t i = 0;
+            for (; i < this->_size; ++i) {
+                this->_keys[i] = index.key(i);
+                this->_signatures[i] = signature(this->_keys[i]);
+                this->_entries[i] = index.entries(i);
+            }
+            // 署名の重複が多いときは文字列の比較が増えるため線形探索としない(高々linear_limit個のため総当たりで数える)
+            std::size_t distinct = 0;
+            for (std::size_t j = 0; j < i; ++j) {
+                distinct += std::find(this->_signatures.begin(), this->_signatures.begin() + j, this->_signatures[j]) == this->_signatures.begin() + j;
+            }
+            if (distinct + i / 4 >= i) {
+                this->_strategy = STRATEGY::LINEAR;
+            }
+        }
+
+        /// <summary>
+        /// 名前に該当するoptionの検索
+        /// </summary>
+        /// <param name="key">接頭辞と引数を除いたオプション名</param>
+        /// <returns>同名のoptionの一覧(該当しないときは空の一覧)</returns>
+        Entries find(std::string_view key) const {
+            if (this->_strategy == STRATEGY::LINEAR) {
+                const auto sig = signature(key);
+                std::uint32_t mask = 0;
+                for (std::size_t i = 0; i < linear_limit; ++i) {
+                    mask |= std::uint32_t(this->_signatures[i] == sig) << i;
+                }
+                mask &= (std::uint32_t(1) << this->_size) - 1;
+                for (; mask != 0; mask &= mask - 1) {
+                    const auto i = static_cast<std::size_t>(std::countr_zero(mask));
+                    if (this->_keys[i] == key) return this->_entries[i];
+                }
+                return Entries();
+            }
+            return this->_index->find(key);
+        }
+
+        /// <summary>
+        /// 選択された検索方法の取得
+        /// </summary>
+        /// <returns>STRATEGYのいずれか</returns>
+        std::size_t strategy() const noexcept { return this->_strategy; }
+
+        /// <summary>
+        /// 名前の数の取得
+        /// </summary>
+        /// <returns></returns>
+        std::size_t size() const noexcept { return this->_size; }
+
+        /// <summary>
+        /// 構築元の索引の取得
+        /// </summary>
+        /// <returns>構築していないときはnullptr</returns>
+        const Index* source() const noexcept { return this->_index; }
+    };
+
+    /// <summary>
+    /// コマンドラインオプションのためのデータ
+    /// </summary>
+    class OptionMap {
+        friend class IncrementalParser;
+        friend class EditableParse;
+        /// <summary>
+        /// option名からoptionを引くための索引(同名のoptionは登録順に保持する)
+        /// </summary>
+        using OptionIndex = OptionLookup::Index;
+
+        std::vector<std::shared_ptr<OptionBase>> _options;
+        std::vector<std::shared_ptr<OptionBase>> _long_options;
+        /// <summary>
+        /// 名前なしオプション(コマンドライン引数の出現順に先頭から埋められる)
+        /// </summary>
+        std::vector<std::shared_ptr<OptionBase>> _unnamed_options;
+        /// <summary>
+        /// 末尾の名前なしオプションの後続に解析が到達しないときにtrue
+        /// </summary>
+        bool _unnamed_terminated = false;
+        /// <summary>
+        /// optionの名前などの定義を定義順に保持する表(各optionが参照するため、OptionMapを移動しても位置を変えない)
+        /// </summary>
+        std::shared_ptr<SchemaTable> _schema = std::make_shared<SchemaTable>();
+        /// <summary>
+        /// optionの索引
+        /// </summary>
+        OptionIndex _option_index;
+        /// <summary>
+        /// long optionの索引
+        /// </summary>
+        OptionIndex _long_option_index;
+        /// <summary>
+        /// 解析時にoptionを検索する構造
+        /// </summary>
+        OptionLookup _option_lookup;
+        OptionLookup _long_option_lookup;
+        /// <summary>
+        /// 索引の変更後に検索の構造を構築したときにtrue
+        /// </summary>
+        bool _lookup_built = false;
+        /// <summary>
+        /// 計数optionと否定可能なoptionの値を保持する状態
+        /// </summary>
+        std::shared_ptr<ParseState> _state = std::make_shared<ParseState>();
+        /// <summary>
+        /// 解析における資源の上限と消費量
+        /// </summary>
+        std::shared_ptr<ParseBudget> _budget = std::make_shared<ParseBudget>();
+        /// <summary>
+        /// optionの使用回数(計測しないときはnullptr)
+        /// </summary>
+        std::shared_ptr<UsageRecorder> _usage;
+
+        /// <summary>
+        /// optionの定義を変更できることの確認(使用回数の計測を開始した後は指紋が変わるため変更できない)
+        /// </summary>
+        void ensure_extensible() const {
+            if (this->_usage) {
+                throw std::logic_error("使用回数の計測を開始した後にoptionを追加することはできません");
+            }
+        }
+
+        /// <summary>
+        /// optionの定義を表に加えて定義順のインデックスを付与する
+        /// </summary>
+        /// <param name="row">optionの定義</param>
+        /// <param name="prefix">接頭辞の長さ</param>
+        /// <param name="option">対象のoption</param>
+        void add_ordered(const SchemaTable::Row& row, std::uint8_t prefix, const std::shared_ptr<OptionBase>& option) {
+            this->ensure_extensible();
+            if (this->_schema->size() >= std::numeric_limits<std::uint32_t>::max()) {
+                throw std::length_error("optionの数が多すぎます");
+            }
+            // 表の定義は種類ごとの引数の有無とoption名の規則に従うもののみ受け付ける
+            const auto value = dynamic_cast<OptionValueBase*>(option.get());
+            if ((row.kind == SchemaTable::KIND::VALUE || row.kind == SchemaTable::KIND::UNNAMED) != (value != nullptr)) {
+                throw std::invalid_argument("optionの種類と引数の有無が一致しません");
+            }
+            if (prefix != 0) OptionName::check(row.name);
+            option->_order = static_cast<std::uint32_t>(this->_schema->add(row, prefix, option.get(), value));
+            option->_schema = this->_schema.get();
+        }
+
+        /// <summary>
+        /// 使用回数を計測しているときはoptionの使用回数を1つ増やす
+        /// </summary>
+        /// <param name="option">一致したoption</param>
+        void count_usage(const OptionBase* option) noexcept {
+            if (this->_usage) this->_usage->add(option->_order);
+        }
+
+        /// <summary>
+        /// 計数optionもしくは否定可能なoptionであれば値の領域を確保し、引数付きのoptionであれば資源の消費量を関連付ける
+        /// </summary>
+        /// <param name="option">対象のoption</param>
+        void attach_state(OptionBase* option) {
+            if (auto p = dynamic_cast<FlagOptionBase*>(option); p != nullptr) {
+                p->attach(*this->_state);
             }
-            try {
-                return p->template as<T>();
+            if (auto p = dynamic_cast<OptionValueBase*>(option); p != nullptr) {
+                p->attach(*this->_budget);
             }
-            catch (const std::runtime_error& e) {
-                throw std::runtime_error(std::format("option {0} は{1}", this->_option->full_name(), e.what()));
+        }
+
+        /// <summary>
+        /// 検索の構造からoptionを検索して解析する
+        /// </summary>
+        /// <param name="lookup">検索の構造</param>
+        /// <param name="key">接頭辞と引数を除いたオプション名</param>
+        /// <param name="offset">コマンドライン引数のオフセット</param>
+        /// <param name="argc">コマンドライン引数の数</param>
+        /// <param name="argv">コマンドライン引数を示す配列</param>
+        /// <returns>解析を実行したoption(解析しなかったときはnullptr)</returns>
+        static OptionBase* parse_indexed(const OptionLookup& lookup, std::string_view key, int& offset, int& argc, const char* argv[]) {
+            for (auto& ptr : lookup.find(key)) {
+                if (ptr->parse(offset, argc, argv)) {
+                    // 解析に成功したときは次の解析に移る
+                    return ptr.get();
+                }
             }
+            return nullptr;
         }
-    };
 
-    /// <summary>
-    /// コマンドラインオプションのためのデータ
-    /// </summary>
-    class OptionMap {
-        std::vector<std::shared_ptr<OptionBase>> _options;
-        std::vector<std::shared_ptr<OptionBase>> _long_options;
-        std::shared_ptr<OptionBase> _unnamed_options;
         /// <summary>
-        /// OptionBaseで宣言されるoption
+        /// 別名を索引に登録する
         /// </summary>
-        std::vector<std::weak_ptr<OptionBase>> _ordered_options;
+        /// <param name="option">別名の対象のoption</param>
+        /// <param name="alias">接頭辞付きの別名</param>
+        void index_alias(const std::shared_ptr<OptionBase>& option, std::string_view alias) {
+            this->_lookup_built = false;
+            if (alias.starts_with("--")) {
+                this->_long_option_index.add(alias.substr(2), option);
+            }
+            else {
+                this->_option_index.add(alias.substr(1), option);
+            }
+        }
 
         /// <summary>
         /// useの実装部
         /// </summary>
         /// <param name="l">オプション名</param>
-        /// <param name="options">オプションに関するリスト</param>
+        /// <param name="index">オプションに関する索引</param>
         /// <returns></returns>
-        std::shared_ptr<OptionBase> use_impl(const std::string& l, const std::vector<std::shared_ptr<OptionBase>>& options) const {
+        std::shared_ptr<OptionBase> use_impl(std::string_view l, const OptionIndex& index) const {
+            // 末尾の等号「=」もしくはスペース「 」により引数の受け取り方を限定する
+            std::size_t pattern = OptionHasValueBase::ARG_PATTERN::NONE;
+            std::string_view ll = l;
             if (std::size_t i = l.find('='); i == l.length() - 1) {
-                // lの末尾に等号「=」があれば等号で引数を受け取る対象のチェック
-                std::string ll = l.substr(0, i);
-                for (auto& option : options) {
-                    if (option->name() == ll) {
-                        auto p = dynamic_cast<OptionHasValueBase*>(option.get());
-                        if (p != nullptr && (p->arg_pattern() & OptionHasValueBase::ARG_PATTERN::ASSIGN) == OptionHasValueBase::ARG_PATTERN::ASSIGN) {
-                            return option;
-                        }
-                    }
-                }
+                pattern = OptionHasValueBase::ARG_PATTERN::ASSIGN;
+                ll = ll.substr(0, i);
             }
             else if (std::size_t j = l.find(' '); j == l.length() - 1) {
-                // lの末尾にスペース「 」があればスペースで引数を受け取る対象のチェック
-                std::string ll = l.substr(0, j);
-                for (auto& option : options) {
-                    if (option->name() == ll) {
-                        auto p = dynamic_cast<OptionHasValueBase*>(option.get());
-                        if (p != nullptr && (p->arg_pattern() & OptionHasValueBase::ARG_PATTERN::SPACE) == OptionHasValueBase::ARG_PATTERN::SPACE) {
-                            return option;
-                        }
-                    }
-                }
+                pattern = OptionHasValueBase::ARG_PATTERN::SPACE;
+                ll = ll.substr(0, j);
             }
-            else {
-                for (auto& option : options) {
-                    if (option->name() == l) {
-                        return option;
-                    }
+
+            for (auto& option : index.find(ll)) {
+                if (pattern == OptionHasValueBase::ARG_PATTERN::NONE) {
+                    return option;
+                }
+                // 引数付きのoption以外の記載パターンはNONEのため一致しない
+                if ((option->arg_pattern() & pattern) == pattern) {
+                    return option;
                 }
             }
             return nullptr;
         }
 
+        /// <summary>
+        /// 表の項目からoption名と引数の形式の説明を追加する
+        /// </summary>
+        /// <param name="out">追加先</param>
+        /// <param name="i">定義順のインデックス</param>
+        void append_name_description(std::string& out, std::size_t i) const {
+            const auto& schema = *this->_schema;
+            const auto kind = schema.kind(i);
+            if (kind == SchemaTable::KIND::NEGATABLE) out.append("--[no-]");
+            else out.append(schema.prefix(i));
+            out.append(schema.name(i));
+            if (kind == SchemaTable::KIND::VALUE) out += OptionHasValueBase::arg_pattern_description(schema.arg_pattern(i));
+            if (auto value = schema.value(i); value != nullptr) value->append_value_description(out, schema.limit(i));
+        }
+
+        /// <summary>
+        /// 説明を表示幅で折り返して出力する
+        /// </summary>
+        /// <param name="sink">出力先</param>
+        /// <param name="text">説明</param>
+        /// <param name="column">説明を出力し始める列</param>
+        /// <param name="indent">折り返した行の字下げの列数</param>
+        /// <param name="totalCols">折り返す列数(0のときは折り返さない)</param>
+        /// <remarks>
+        /// 空白スペースの位置と全角文字の前後で折り返し、折り返せる位置がないときは列数を超える直前で分割する
+        /// </remarks>
+        static void write_wrapped(DescriptionSink& sink, std::string_view text, std::size_t column, std::size_t indent, std::size_t totalCols) {
+            if (totalCols <= indent) {
+                sink.write_stable(text);
+                return;
+            }
+            std::size_t line_begin = 0;
+            std::size_t line_width = column;
+            // 直近の折り返せる位置(行末, 次の行の先頭, 行末までの表示幅)
+            std::size_t break_end = std::string_view::npos, break_next = 0, break_width = 0;
+            auto new_line = [&](std::size_t end, std::size_t next) {
+                sink.write_stable(text.substr(line_begin, end - line_begin));
+                sink.write_stable("\n");
+                sink.spaces(indent);
+                line_begin = next;
+                break_end = std::string_view::npos;
+            };
+            if (!text.empty() && totalCols <= column) {
+                sink.write_stable("\n");
+                sink.spaces(indent);
+                line_width = indent;
+            }
+            for (std::size_t pos = 0, len = 0; pos < text.size(); pos += len) {
+                const auto cp = DisplayWidth::decode(text.substr(pos), len);
+                if (cp == U'\n') {
+                    new_line(pos, pos + len);
+                    line_width = indent;
+                    continue;
+                }
+                const auto w = DisplayWidth::of(cp);
+                if (w == 2 && pos != line_begin) {
+                    break_end = break_next = pos;
+                    break_width = line_width;
+                }
+                if (totalCols < line_width + w && break_end != std::string_view::npos) {
+                    new_line(break_end, break_next);
+                    line_width = indent + (line_width - break_width);
+                }
+                if (totalCols < line_width + w && pos != line_begin) {
+                    new_line(pos, pos);
+                    line_width = indent;
+                }
+                if (cp == U' ' && pos != line_begin) {
+                    break_end = pos;
+                    break_next = pos + len;
+                    break_width = line_width + w;
+                }
+                else if (w == 2) {
+                    break_end = break_next = pos + len;
+                    break_width = line_width + w;
+                }
+                line_width += w;
+            }
+            sink.write_stable(text.substr(line_begin));
+        }
+
     public:
         OptionMap() {}
 
@@ -966,71 +3864,162 @@ namespace option {
         /// <returns>クローン</returns>
         OptionMap clone() const {
             OptionMap result;
-            for (const auto& e : this->_ordered_options) {
-                auto p = e.lock();
+            const auto& schema = *this->_schema;
+            result._schema->reserve(schema.size());
+            for (std::size_t i = 0; i < schema.size(); ++i) {
+                const auto p = schema.option(i);
                 auto option = p->clone();
-                if (dynamic_cast<Option*>(option) != nullptr) {
-                    result._options.emplace_back(option);
-                    result._ordered_options.emplace_back(result._options.back());
+                if (auto o = dynamic_cast<Option*>(option); o != nullptr) {
+                    result.add_option(schema.row(i), o);
+                }
+                else if (auto l = dynamic_cast<LongOption*>(option); l != nullptr) {
+                    result.add_long_option(schema.row(i), l);
                 }
-                else if (dynamic_cast<LongOption*>(option) != nullptr) {
-                    result._long_options.emplace_back(option);
-                    result._ordered_options.emplace_back(result._long_options.back());
+                else if (schema.kind(i) == SchemaTable::KIND::UNNAMED) {
+                    std::shared_ptr<OptionBase> u(option);
+                    result.add_ordered(schema.row(i), 0, u);
+                    result._unnamed_options.push_back(std::move(u));
+                    result.attach_state(option);
                 }
                 else {
-                    throw std::logic_error(std::format("option {0}は未知のoptionパターンです", p->name()));
+                    delete option;
+                    throw std::logic_error(MessageFormat::format("option {0}は未知のoptionパターンです", p->name()));
                 }
             }
-            if (this->_unnamed_options) {
-                result._unnamed_options.reset(this->_unnamed_options->clone());
-                result._ordered_options.emplace_back(result._unnamed_options);
-            }
+            result._unnamed_terminated = this->_unnamed_terminated;
+            *result._state = *this->_state;
+            *result._budget = *this->_budget;
+            result._usage = this->_usage;
             return result;
         }
 
+        /// <summary>
+        /// optionの定義を確定してoptionの数と名前の分布から検索の構造を構築する
+        /// </summary>
+        /// <remarks>
+        /// optionの追加後の最初の解析で自動的に呼び出される
+        /// </remarks>
+        void freeze() {
+            // 複製や移動の後は索引の位置が変わるため構築し直す
+            if (this->_lookup_built && this->_option_lookup.source() == &this->_option_index && this->_long_option_lookup.source() == &this->_long_option_index) {
+                return;
+            }
+            this->_option_lookup.build(this->_option_index);
+            this->_long_option_lookup.build(this->_long_option_index);
+            this->_lookup_built = true;
+        }
+
+        /// <summary>
+        /// 定義順のoptionの表の取得
+        /// </summary>
+        /// <returns></returns>
+        const SchemaTable& schema() const noexcept { return *this->_schema; }
+
+        /// <summary>
+        /// 解析における資源の上限の設定
+        /// </summary>
+        /// <param name="limits">上限</param>
+        void set_limits(const ParseLimits& limits) noexcept { this->_budget->set_limits(limits); }
+
+        /// <summary>
+        /// 解析における資源の上限の取得
+        /// </summary>
+        /// <returns></returns>
+        const ParseLimits& limits() const noexcept { return this->_budget->limits(); }
+
+        /// <summary>
+        /// 直前の解析における資源の消費量の取得
+        /// </summary>
+        /// <returns></returns>
+        const ParseBudget::Usage& budget_usage() const noexcept { return this->_budget->usage(); }
+
+        /// <summary>
+        /// optionの検索の構造の取得
+        /// </summary>
+        /// <returns></returns>
+        const OptionLookup& option_lookup() {
+            this->freeze();
+            return this->_option_lookup;
+        }
+
+        /// <summary>
+        /// long optionの検索の構造の取得
+        /// </summary>
+        /// <returns></returns>
+        const OptionLookup& long_option_lookup() {
+            this->freeze();
+            return this->_long_option_lookup;
+        }
+
         /// <summary>
         /// 名前なしoptionの取得
         /// </summary>
+        /// <param name="i">名前なしoptionの定義順のインデックス</param>
+        /// <returns></returns>
+        OptionWrapper unnamed_options(std::size_t i = 0) const {
+            if (i >= this->_unnamed_options.size()) {
+                throw std::invalid_argument(MessageFormat::format("{0} 番目の名前なしオプションは存在しません", i));
+            }
+            return OptionWrapper(this->_unnamed_options[i]);
+        }
+        MutableOptionWrapper unnamed_options(std::size_t i = 0) {
+            return MutableOptionWrapper(static_cast<const OptionMap&>(*this).unnamed_options(i));
+        }
+
+        /// <summary>
+        /// 名前なしoptionの数の取得
+        /// </summary>
         /// <returns></returns>
-        OptionWrapper unnamed_options() const {
-            return OptionWrapper(this->_unnamed_options);
+        std::size_t unnamed_options_size() const noexcept {
+            return this->_unnamed_options.size();
         }
 
         /// <summary>
         /// コマンドライン引数を解析する
         /// </summary>
+        /// <remarks>
+        /// optionの検索は索引により行い、各トークンは高々定数回しか走査しないため
+        /// 計算量はコマンドライン引数の総バイト数とoptionの数に対して線形となる
+        /// </remarks>
         /// <param name="argc">コマンドライン引数の数</param>
         /// <param name="argv">コマンドライン引数を示す配列</param>
         /// <param name="validate">引数のチェックを行うか</param>
         /// <returns>解析後のオフセット</returns>
         int parse(int argc, const char* argv[], bool validate = true) {
+            // 先読みでは任意の要素を参照するため事前にnullptrを含まないことと資源の上限を超えないことを確認する
+            this->_budget->reset();
+            for (int i = 0; i < argc; ++i) {
+                if (argv[i] == nullptr) {
+                    throw std::invalid_argument(MessageFormat::format("{0} 番目のコマンドライン引数がnullptrです", i));
+                }
+                this->_budget->consume_token(argv[i]);
+            }
+
+            this->freeze();
             int offset = 0;
+            // 引数を受け付ける名前なしオプションの位置(上限に達したものは再度参照しない)
+            std::size_t slot = 0;
             while (offset < argc) {
                 if (Option::is_option(argv[offset])) {
-                    bool exist = false;
-                    for (auto& ptr : this->_options) {
-                        if (ptr->parse(offset, argc, argv)) {
-                            // 解析に成功したときは次の解析に移る
-                            exist = true;
-                            break;
-                        }
-                    }
-                    if (!exist) {
-                        throw std::runtime_error(std::format("{0} に該当するoptionは存在しません", argv[offset]));
+                    std::string_view key = std::string_view{ argv[offset] }.substr(1);
+                    auto matched = parse_indexed(this->_option_lookup, key, offset, argc, argv);
+                    if (matched == nullptr) {
+                        throw std::runtime_error(DescriptionCatalog::message("error.unknown_option", "{0} に該当するoptionは存在しません", argv[offset]));
                     }
+                    this->count_usage(matched);
                 }
                 else if (LongOption::is_long_option(argv[offset])) {
-                    bool exist = false;
-                    for (auto& ptr : this->_long_options) {
-                        if (ptr->parse(offset, argc, argv)) {
-                            // 解析に成功したときは次の解析に移る
-                            exist = true;
-                            break;
-                        }
+                    std::string_view key = std::string_view{ argv[offset] }.substr(2);
+                    key = key.substr(0, key.find('='));
+                    // --no-から始まるときは否定可能なoptionとしても検索する
+                    auto matched = parse_indexed(this->_long_option_lookup, key, offset, argc, argv);
+                    if (matched == nullptr && key.starts_with("no-")) {
+                        matched = parse_indexed(this->_long_option_lookup, key.substr(3), offset, argc, argv);
                     }
-                    if (!exist) {
-                        throw std::runtime_error(std::format("{0} に該当するlong optionは存在しません", argv[offset]));
+                    if (matched == nullptr) {
+                        throw std::runtime_error(DescriptionCatalog::message("error.unknown_long_option", "{0} に該当するlong optionは存在しません", argv[offset]));
                     }
+                    this->count_usage(matched);
                 }
                 else {
                     if (OptionBase::is_dash(argv[offset])) {
@@ -1040,13 +4029,14 @@ namespace option {
                             continue;
                         }
                     }
-                    if (this->_unnamed_options) {
-                        if (!this->_unnamed_options->parse(offset, argc, argv)) {
-                            throw std::runtime_error(std::format("これ以上の名前なしオプション {0} は設定不可です", argv[offset]));
-                        }
+                    if (this->_unnamed_options.empty()) {
+                        throw std::runtime_error(DescriptionCatalog::message("error.unnamed_option", "名前なしオプションの設定はできません"));
                     }
-                    else {
-                        throw std::runtime_error("名前なしオプションの設定はできません");
+                    while (slot < this->_unnamed_options.size() && !this->_unnamed_options[slot]->parse(offset, argc, argv)) {
+                        ++slot;
+                    }
+                    if (slot == this->_unnamed_options.size()) {
+                        throw std::runtime_error(DescriptionCatalog::message("error.too_many_unnamed_options", "これ以上の名前なしオプション {0} は設定不可です", argv[offset]));
                     }
                 }
             }
@@ -1058,26 +4048,78 @@ namespace option {
             return offset;
         }
 
+        /// <summary>
+        /// 1つのoptionに与えられた引数のチェック
+        /// </summary>
+        /// <param name="option">チェック対象のoption</param>
+        /// <returns>エラーメッセージ(正当なときは空文字列)</returns>
+        static std::string validate_option(OptionBase& option) {
+            std::vector<PathCheck::Request> requests;
+            if (auto p = dynamic_cast<const OptionValueBase*>(&option); p != nullptr) {
+                if (auto runner = p->path_requests(requests); runner != nullptr) runner(requests);
+            }
+            return validate_option(option, requests);
+        }
+
+        /// <summary>
+        /// 1つのoptionに与えられた引数のチェック
+        /// </summary>
+        /// <param name="option">チェック対象のoption</param>
+        /// <param name="checked">optionのファイルパスとしての実行済みの検査要求</param>
+        /// <returns>エラーメッセージ(正当なときは空文字列)</returns>
+        static std::string validate_option(OptionBase& option, std::span<const PathCheck::Request> checked) {
+            try {
+                option.validate();
+                PathCheck::verify(checked);
+            }
+            catch (const std::runtime_error& e) {
+                return DescriptionCatalog::message("error.option_error", "option {0} に対する{1}", option.full_name(), e.what());
+            }
+            return std::string();
+        }
+
         /// <summary>
         /// 与えられた引数のチェック
         /// </summary>
         void validate() const {
-            // 引数の正当性確認
-            for (const auto& e : this->_ordered_options) {
-                auto p = e.lock();
+            // ファイルパスの検査は全optionの分をまとめて1度に実行する(実行方法はoptionごとに変えない前提とする)
+            const auto& schema = *this->_schema;
+            std::vector<PathCheck::Request> requests;
+            std::vector<std::size_t> offsets;
+            offsets.reserve(schema.size() + 1);
+            PathCheck::Runner runner = nullptr;
+            for (std::size_t i = 0; i < schema.size(); ++i) {
+                offsets.push_back(requests.size());
+                if (auto p = schema.value(i); p != nullptr) {
+                    if (auto r = p->path_requests(requests); r != nullptr) runner = r;
+                }
+            }
+            offsets.push_back(requests.size());
+            if (runner != nullptr) runner(requests);
+            auto checked = [&requests, &offsets](std::size_t i) {
+                return std::span<const PathCheck::Request>(requests.data() + offsets[i], offsets[i + 1] - offsets[i]);
+            };
+
+            // 引数の正当性確認(引数の数は表から読み、引数を持たないoptionは検査する内容がないため参照せず、名前なしオプションは後で検査する)
+            const auto kinds = schema.kinds();
+            for (std::size_t i = 0; i < kinds.size(); ++i) {
+                if (kinds[i] != SchemaTable::KIND::VALUE) continue;
                 try {
-                    p->validate();
+                    schema.value(i)->validate_values(schema.limit(i), schema.required(i));
+                    PathCheck::verify(checked(i));
                 }
                 catch (const std::runtime_error& e) {
-                    throw std::runtime_error(std::format("option {0} に対する{1}", p->full_name(), e.what()));
+                    throw std::runtime_error(DescriptionCatalog::message("error.option_error", "option {0} に対する{1}", std::string(schema.prefix(i)).append(schema.name(i)), e.what()));
                 }
             }
-            if (this->_unnamed_options) {
+            for (std::size_t i = 0; i < kinds.size(); ++i) {
+                if (kinds[i] != SchemaTable::KIND::UNNAMED) continue;
                 try {
-                    this->_unnamed_options->validate();
+                    schema.value(i)->validate_values(schema.limit(i), schema.required(i));
+                    PathCheck::verify(checked(i));
                 }
                 catch (const std::runtime_error& e) {
-                    throw std::runtime_error(std::format("名前なしオプションに対する引数 {0}", e.what()));
+                    throw std::runtime_error(DescriptionCatalog::message("error.unnamed_option_argument", "名前なしオプションに対する引数 {0}", e.what()));
                 }
             }
         }
@@ -1088,11 +4130,14 @@ namespace option {
         /// <param name="o">option名</param>
         /// <returns></returns>
         OptionWrapper ouse(const std::string& o) const {
-            auto p = this->use_impl(o, this->_options);
+            auto p = this->use_impl(o, this->_option_index);
             if (p != nullptr) {
                 return OptionWrapper(p);
             }
-            throw std::invalid_argument(std::format("{0} というoptionは存在しません", o));
+            throw std::invalid_argument(MessageFormat::format("{0} というoptionは存在しません", o));
+        }
+        MutableOptionWrapper ouse(const std::string& o) {
+            return MutableOptionWrapper(static_cast<const OptionMap&>(*this).ouse(o));
         }
 
         /// <summary>
@@ -1101,11 +4146,14 @@ namespace option {
         /// <param name="l">long option名</param>
         /// <returns></returns>
         OptionWrapper luse(const std::string& l) const {
-            auto p = this->use_impl(l, this->_long_options);
+            auto p = this->use_impl(l, this->_long_option_index);
             if (p != nullptr) {
                 return OptionWrapper(p);
             }
-            throw std::invalid_argument(std::format("{0} というlong optionは存在しません", l));
+            throw std::invalid_argument(MessageFormat::format("{0} というlong optionは存在しません", l));
+        }
+        MutableOptionWrapper luse(const std::string& l) {
+            return MutableOptionWrapper(static_cast<const OptionMap&>(*this).luse(l));
         }
 
         /// <summary>
@@ -1114,46 +4162,129 @@ namespace option {
         /// <param name="o">オプション名</param>
         /// <returns></returns>
         OptionWrapper use(const std::string& o) const {
-            auto p1 = this->use_impl(o, this->_options);
+            auto p1 = this->use_impl(o, this->_option_index);
             if (p1 != nullptr) {
                 return OptionWrapper(p1);
             }
-            auto p2 = this->use_impl(o, this->_long_options);
+            auto p2 = this->use_impl(o, this->_long_option_index);
             if (p2 != nullptr) {
                 return OptionWrapper(p2);
             }
-            throw std::invalid_argument(std::format("{0} というoptionは存在しません", o));
+            throw std::invalid_argument(MessageFormat::format("{0} というoptionは存在しません", o));
+        }
+        MutableOptionWrapper use(const std::string& o) {
+            return MutableOptionWrapper(static_cast<const OptionMap&>(*this).use(o));
         }
 
         /// <summary>
         /// optionの追加
         /// </summary>
+        /// <param name="row">optionの名前などの定義(表にのみ置かれる)</param>
         /// <param name="option">追加するoption</param>
-        void add_option(Option* option) {
-            this->_options.emplace_back(option);
-            this->_ordered_options.emplace_back(this->_options.back());
+        void add_option(const SchemaTable::Row& row, Option* option) {
+            this->add_option(row, std::shared_ptr<Option>(option));
+        }
+        /// <summary>
+        /// optionの追加(make_sharedで構築したoptionは共有の管理領域を別に確保しない)
+        /// </summary>
+        /// <param name="row">optionの名前などの定義(表にのみ置かれる)</param>
+        /// <param name="option">追加するoption</param>
+        void add_option(const SchemaTable::Row& row, std::shared_ptr<Option> option) {
+            // 定義を変更できないときに索引の無いoptionが残らないよう、順序付けを先に行う
+            this->add_ordered(row, 1, option);
+            this->_options.push_back(option);
+            this->_option_index.add(option->name(), option);
+            this->_lookup_built = false;
+            for (const auto& alias : option->aliases()) {
+                this->index_alias(option, alias);
+            }
+            this->attach_state(option.get());
         }
 
         /// <summary>
         /// long optionの追加
         /// </summary>
+        /// <param name="row">long optionの名前などの定義(表にのみ置かれる)</param>
+        /// <param name="option">追加するoption</param>
+        void add_long_option(const SchemaTable::Row& row, LongOption* option) {
+            this->add_long_option(row, std::shared_ptr<LongOption>(option));
+        }
+        /// <summary>
+        /// long optionの追加(make_sharedで構築したoptionは共有の管理領域を別に確保しない)
+        /// </summary>
+        /// <param name="row">long optionの名前などの定義(表にのみ置かれる)</param>
         /// <param name="option">追加するoption</param>
-        void add_long_option(LongOption* option) {
-            this->_long_options.emplace_back(option);
-            this->_ordered_options.emplace_back(this->_long_options.back());
+        void add_long_option(const SchemaTable::Row& row, std::shared_ptr<LongOption> option) {
+            this->add_ordered(row, 2, option);
+            this->_long_options.push_back(option);
+            this->_long_option_index.add(option->name(), option);
+            this->_lookup_built = false;
+            for (const auto& alias : option->aliases()) {
+                this->index_alias(option, alias);
+            }
+            this->attach_state(option.get());
+        }
+
+        /// <summary>
+        /// 別名の追加
+        /// </summary>
+        /// <remarks>
+        /// 別名は対象のoptionと同一の値を共有し、対象のoptionと同じ規則で解析される
+        /// </remarks>
+        /// <param name="alias">接頭辞付きの別名(-jや--parallelなど)</param>
+        /// <param name="target">接頭辞付きの対象のoption名(--jobsや--jobs=など)</param>
+        void add_alias(InternedString alias, std::string_view target) {
+            // 別名は定義の指紋に含まれる
+            this->ensure_extensible();
+            std::string_view str = alias;
+            bool is_long = str.size() >= 3 && str.starts_with("--") && str[2] != '-';
+            if (!is_long && !(str.size() >= 2 && str[0] == '-' && str[1] != '-')) {
+                throw std::invalid_argument(MessageFormat::format("別名 {0} はoptionもしくはlong optionの形式である必要があります", str));
+            }
+            if (str.find('=') != std::string_view::npos || str.find(' ') != std::string_view::npos) {
+                throw std::invalid_argument(MessageFormat::format("別名 {0} に等号や空白スペースを含めることはできません", str));
+            }
+            const auto& index = is_long ? this->_long_option_index : this->_option_index;
+            if (index.contains(str.substr(is_long ? 2 : 1))) {
+                throw std::invalid_argument(MessageFormat::format("{0} は既に定義されています", str));
+            }
+
+            std::shared_ptr<OptionBase> p;
+            if (target.starts_with("--")) {
+                p = this->use_impl(target.substr(2), this->_long_option_index);
+            }
+            else if (target.starts_with("-")) {
+                p = this->use_impl(target.substr(1), this->_option_index);
+            }
+            if (p == nullptr) {
+                throw std::invalid_argument(MessageFormat::format("{0} というoptionは存在しません", target));
+            }
+            p->add_alias(alias);
+            this->index_alias(p, p->aliases().back());
         }
 
         /// <summary>
         /// 名前なしのオプションの追加
         /// </summary>
+        /// <remarks>
+        /// 名前なしオプションは追加した順にコマンドライン引数の位置と対応付けられる
+        /// </remarks>
+        /// <param name="row">引数の数などの定義(表にのみ置かれる)</param>
         /// <param name="option">追加するoption</param>
         template <class T>
-        void add_unnamed_option(UnnamedOption<T>* option) {
-            if (this->_unnamed_options) {
-                throw std::invalid_argument("複数の名前なしオプションは定義できません");
+        void add_unnamed_option(const SchemaTable::Row& row, UnnamedOption<T>* option) {
+            this->add_unnamed_option(row, std::shared_ptr<UnnamedOption<T>>(option));
+        }
+        template <class T>
+        void add_unnamed_option(const SchemaTable::Row& row, std::shared_ptr<UnnamedOption<T>> option) {
+            if (this->_unnamed_terminated) {
+                throw std::invalid_argument("引数の数に上限のないもしくは中断する名前なしオプションの後に名前なしオプションは定義できません");
             }
-            this->_unnamed_options.reset(option);
-            this->_ordered_options.emplace_back(this->_unnamed_options);
+            option->_slot = this->_unnamed_options.size();
+            this->add_ordered(row, 0, option);
+            this->_unnamed_options.push_back(option);
+            this->attach_state(option.get());
+            this->_unnamed_terminated = option->is_terminal();
         }
 
         /// <summary>
@@ -1163,35 +4294,154 @@ namespace option {
         /// <param name="lengthBetweenOptionAndDescription">option名と説明の間の隙間</param>
         /// <returns></returns>
         std::string description(std::size_t optionCols, std::size_t lengthBetweenOptionAndDescription) const {
-            std::ostringstream oss;
-            for (const auto& e : this->_ordered_options) {
-                auto p = e.lock();
-                auto desc = p->description();
-                auto name_desc = p->name_description();
-                oss << "  " << name_desc;
-                // optionが長すぎるときは適当に補間する
-                if (optionCols < name_desc.length() + lengthBetweenOptionAndDescription) {
-                    oss << std::string(lengthBetweenOptionAndDescription, ' ');
-                }
-                else {
-                    oss << std::string(optionCols - name_desc.length(), ' ');
+            std::string result;
+            StringDescriptionSink sink(result);
+            this->write_description(sink, optionCols, lengthBetweenOptionAndDescription, 0);
+            return result;
+        }
+
+        /// <summary>
+        /// optionの説明を文字列を構築せずに逐次出力する
+        /// </summary>
+        /// <param name="sink">出力先</param>
+        /// <param name="optionCols">option部の列数</param>
+        /// <param name="lengthBetweenOptionAndDescription">option名と説明の間の隙間</param>
+        /// <param name="totalCols">説明を折り返す列数(0のときは折り返さない)</param>
+        /// <remarks>
+        /// 列数はバイト数ではなく表示幅で数えるため全角文字を含むoption名や説明でも桁が揃う。
+        /// DescriptionCatalogが設定されているときは説明をキーとしてカタログの文字列に置き換える
+        /// </remarks>
+        void write_description(DescriptionSink& sink, std::size_t optionCols, std::size_t lengthBetweenOptionAndDescription, std::size_t totalCols) const {
+            const auto catalog = DescriptionCatalog::current();
+            const auto& schema = *this->_schema;
+            std::string name_desc;
+            for (std::size_t i = 0; i < schema.size(); ++i) {
+                const auto p = schema.option(i);
+                name_desc.clear();
+                for (const auto& alias : p->aliases()) {
+                    name_desc.append(alias).append(", ");
                 }
-                oss << desc << std::endl;
+                this->append_name_description(name_desc, i);
+                const auto name_width = DisplayWidth::of(name_desc);
+                sink.write_stable("  ");
+                sink.write(name_desc);
+                // optionが長すぎるときは適当に補間する
+                const auto padding = optionCols < name_width + lengthBetweenOptionAndDescription ? lengthBetweenOptionAndDescription : optionCols - name_width;
+                sink.spaces(padding);
+                const auto desc = catalog ? catalog->find(p->description(), p->description()) : p->description();
+                write_wrapped(sink, desc, 2 + name_width + padding, 2 + optionCols, totalCols);
+                sink.write_stable("\n");
+            }
+            if (schema.size() == 0) sink.write_stable("  None\n");
+            sink.flush();
+        }
+
+        /// <summary>
+        /// 解析結果をJSONとして取得する
+        /// </summary>
+        /// <typeparam name="Writer">出力に用いるクラス(既定ではCommandLineOptionJson.hppを取り込む必要がある)</typeparam>
+        /// <returns></returns>
+        template <class Writer = JsonWriter>
+        std::string to_json() const {
+            Writer json;
+            write_json(*this, json);
+            return json.take();
+        }
+
+        /// <summary>
+        /// optionの定義をJSONとして取得する
+        /// </summary>
+        /// <typeparam name="Writer">出力に用いるクラス(既定ではCommandLineOptionJson.hppを取り込む必要がある)</typeparam>
+        /// <returns></returns>
+        template <class Writer = JsonWriter>
+        std::string json_schema() const {
+            Writer json;
+            write_json_schema(*this, json);
+            return json.take();
+        }
+
+        /// <summary>
+        /// optionの使用回数の計測を開始する(以降はoptionを追加できない)
+        /// </summary>
+        /// <typeparam name="Counters">使用回数の記録先(既定ではCommandLineOptionUsage.hppを取り込む必要がある)</typeparam>
+        /// <param name="mode">共有メモリを作成するときのアクセス権(既定では所有者のみ)</param>
+        /// <returns>使用回数(同じ定義をもつプロセス間で共有される)</returns>
+        template <class Counters = UsageCounters>
+        std::shared_ptr<Counters> enable_usage_counters(unsigned int mode = Counters::DEFAULT_MODE) {
+            if (!this->_usage) {
+                this->_usage = std::make_shared<Counters>(Counters::fingerprint_of(*this), this->_schema->size(), mode);
+            }
+            return std::dynamic_pointer_cast<Counters>(this->_usage);
+        }
+
+        /// <summary>
+        /// optionの使用回数の取得
+        /// </summary>
+        /// <returns>計測していないときはnullptr</returns>
+        template <class Counters = UsageCounters>
+        std::shared_ptr<Counters> usage_counters() const noexcept { return std::dynamic_pointer_cast<Counters>(this->_usage); }
+
+        /// <summary>
+        /// optionの使用回数をPrometheusのテキスト形式で出力する(UsageCounters::write_prometheusを参照)
+        /// </summary>
+        /// <param name="out">出力先</param>
+        template <class Counters = UsageCounters>
+        void write_usage_prometheus(std::string& out) const { Counters::write_prometheus(*this, out); }
+
+        /// <summary>
+        /// optionの使用回数をPrometheusのテキスト形式でファイルへ書き出す(UsageCounters::export_prometheusを参照)
+        /// </summary>
+        /// <param name="path">出力先のファイルパス</param>
+        /// <returns>書き出せたときにtrue</returns>
+        template <class Counters = UsageCounters>
+        bool export_usage(const std::string& path) const { return Counters::export_prometheus(*this, path); }
+
+        /// <summary>
+        /// 全てのoptionの現在の状態を定義順に記録する
+        /// </summary>
+        /// <returns></returns>
+        std::vector<OptionMark> mark() const {
+            std::vector<OptionMark> result;
+            result.reserve(this->_schema->size());
+            for (auto p : this->_schema->options()) {
+                result.push_back(p->mark());
+            }
+            return result;
+        }
+
+        /// <summary>
+        /// 全てのoptionを記録した状態へ巻き戻す
+        /// </summary>
+        /// <param name="marks">markで記録した状態</param>
+        /// <remarks>
+        /// 解析前に記録した状態へ巻き戻せば、initと異なり引数のないoptionの利用状況も含めて解析前の状態となる
+        /// </remarks>
+        void rewind(const std::vector<OptionMark>& marks) {
+            if (marks.size() != this->_schema->size()) {
+                throw std::invalid_argument("記録した状態の数がoptionの数と一致しません");
+            }
+            for (std::size_t i = 0; i < marks.size(); ++i) {
+                this->_schema->option(i)->rewind(marks[i]);
             }
-            if (this->_ordered_options.empty()) oss << "  None" << std::endl;
-            return oss.str();
         }
 
         /// <summary>
         /// コマンドライン解析前の状態へ初期化
         /// </summary>
         void init() {
-            for (const auto& e : this->_ordered_options) {
-                e.lock()->init();
+            // 引数を持たないoptionは初期化する内容がないため参照しない
+            for (auto p : this->_schema->values()) {
+                if (p != nullptr) p->clear_values();
             }
+            this->_state->init();
         }
     };
 
+    // CommandLineOptionIncremental.hppで定義する
+    class IncrementalParser;
+    // CommandLineOptionEditable.hppで定義する
+    class EditableParse;
+
     /// <summary>
     /// オプションの追加の記述のためのET
     /// </summary>
@@ -1213,8 +4463,19 @@ namespace option {
             /// <param name="name">option名</param>
             /// <param name="desc">optionの説明</param>
             /// <returns></returns>
-            AddOptions& operator()(const std::string& name, const std::string& desc) {
-                this->_ao._option_map.add_option(new Option(name, desc));
+            AddOptions& operator()(const OptionName& name, const OptionDescription& desc) {
+                this->_ao._option_map.add_option({ name.str() }, std::make_shared<Option>(desc.str()));
+                return this->_ao;
+            }
+
+            /// <summary>
+            /// 出現回数を数えるoptionの生成
+            /// </summary>
+            /// <param name="name">option名</param>
+            /// <param name="desc">optionの説明</param>
+            /// <returns></returns>
+            AddOptions& operator()(const OptionName& name, Counter, const OptionDescription& desc) {
+                this->_ao._option_map.add_option({ name.str(), SchemaTable::KIND::COUNT }, std::make_shared<CountOption>(desc.str()));
                 return this->_ao;
             }
 
@@ -1227,8 +4488,8 @@ namespace option {
             /// <param name="desc">optionの説明</param>
             /// <returns></returns>
             template <class T>
-            AddOptions& operator()(const std::string& name, const Value<T>& value, const std::string& desc) {
-                this->_ao._option_map.add_option(new OptionHasValue<T>(value, name, desc));
+            AddOptions& operator()(const OptionName& name, const Value<T>& value, const OptionDescription& desc) {
+                this->_ao._option_map.add_option(value.row(name.str(), SchemaTable::KIND::VALUE, OptionHasValueBase::ARG_PATTERN::SPACE), std::make_shared<OptionHasValue<T>>(value, desc.str()));
                 return this->_ao;
             }
         };
@@ -1249,8 +4510,31 @@ namespace option {
             /// <param name="name">long option名</param>
             /// <param name="desc">long optionの説明</param>
             /// <returns></returns>
-            AddOptions& operator()(const std::string& name, const std::string& desc) {
-                this->_ao._option_map.add_long_option(new LongOption(name, desc));
+            AddOptions& operator()(const OptionName& name, const OptionDescription& desc) {
+                this->_ao._option_map.add_long_option({ name.str() }, std::make_shared<LongOption>(desc.str()));
+                return this->_ao;
+            }
+
+            /// <summary>
+            /// 出現回数を数えるlong optionの生成
+            /// </summary>
+            /// <param name="name">long option名</param>
+            /// <param name="desc">long optionの説明</param>
+            /// <returns></returns>
+            AddOptions& operator()(const OptionName& name, Counter, const OptionDescription& desc) {
+                this->_ao._option_map.add_long_option({ name.str(), SchemaTable::KIND::COUNT }, std::make_shared<CountLongOption>(desc.str()));
+                return this->_ao;
+            }
+
+            /// <summary>
+            /// --no-による否定が可能な真偽値のlong optionの生成
+            /// </summary>
+            /// <param name="name">long option名</param>
+            /// <param name="negatable">デフォルト値の情報</param>
+            /// <param name="desc">long optionの説明</param>
+            /// <returns></returns>
+            AddOptions& operator()(const OptionName& name, const Negatable& negatable, const OptionDescription& desc) {
+                this->_ao._option_map.add_long_option({ name.str(), SchemaTable::KIND::NEGATABLE }, std::make_shared<NegatableLongOption>(desc.str(), negatable._default_value));
                 return this->_ao;
             }
 
@@ -1263,21 +4547,28 @@ namespace option {
             /// <param name="desc">long optionの説明</param>
             /// <returns></returns>
             template <class T>
-            AddOptions& operator()(const std::string& name, const Value<T>& value, const std::string& desc) {
-                LongOptionHasValue<T>* temp = nullptr;
-                std::size_t i = name.find('=');
-                std::size_t j = name.find(' ');
-                if (i == name.length() - 1) {
-                    temp = new LongOptionHasValue<T>(value, name.substr(0, i), desc, OptionHasValueBase::ARG_PATTERN::ASSIGN);
-                }
-                else if (j == name.length() - 1) {
-                    temp = new LongOptionHasValue<T>(value, name.substr(0, j), desc, OptionHasValueBase::ARG_PATTERN::SPACE);
-                }
-                else {
-                    temp = new LongOptionHasValue<T>(value, name, desc, OptionHasValueBase::ARG_PATTERN::ASSIGN | OptionHasValueBase::ARG_PATTERN::SPACE);
-                }
+            AddOptions& operator()(const LongOptionName& name, const Value<T>& value, const OptionDescription& desc) {
+                this->_ao._option_map.add_long_option(value.row(name.name().str(), SchemaTable::KIND::VALUE, name.arg_pattern()), std::make_shared<LongOptionHasValue<T>>(value, desc.str()));
+                return this->_ao;
+            }
+        };
+        /// <summary>
+        /// 別名の構築のためのクラス
+        /// </summary>
+        class AliasBuilder {
+            AddOptions& _ao;
+        public:
+            AliasBuilder() = delete;
+            AliasBuilder(AddOptions& ao) : _ao(ao) {}
 
-                this->_ao._option_map.add_long_option(temp);
+            /// <summary>
+            /// 別名の生成
+            /// </summary>
+            /// <param name="alias">接頭辞付きの別名</param>
+            /// <param name="target">接頭辞付きの対象のoption名</param>
+            /// <returns></returns>
+            AddOptions& operator()(InternedString alias, std::string_view target) {
+                this->_ao._option_map.add_alias(alias, target);
                 return this->_ao;
             }
         };
@@ -1319,16 +4610,16 @@ namespace option {
             /// <param name="desc">名前なしオプションの説明</param>
             /// <returns></returns>
             template <class T>
-            AddOptions& operator()(const Value<T>& value, const std::string& desc) {
-                UnnamedOption<T>* temp = new UnnamedOption<T>(value, desc);
+            AddOptions& operator()(const Value<T>& value, const OptionDescription& desc) {
+                auto temp = std::make_shared<UnnamedOption<T>>(value, desc.str());
                 temp->_pause = this->_pause;
-                this->_ao._option_map.add_unnamed_option(temp);
+                this->_ao._option_map.add_unnamed_option(value.row(InternedString(), SchemaTable::KIND::UNNAMED, OptionHasValueBase::ARG_PATTERN::NONE), std::move(temp));
                 this->init();
                 return this->_ao;
             }
         };
     public:
-        AddOptions(OptionMap& option_map) : _option_map(option_map), o(*this), l(*this), u(*this) {}
+        AddOptions(OptionMap& option_map) : _option_map(option_map), o(*this), l(*this), u(*this), a(*this) {}
 
         /// <summary>
         /// optionの構築のためのクラス
@@ -1342,6 +4633,10 @@ namespace option {
         /// 名前なしオプションの構築のためのオブジェクト
         /// </summary>
         UnnamedOptionBuilder u;
+        /// <summary>
+        /// 別名の構築のためのオブジェクト
+        /// </summary>
+        AliasBuilder a;
     };
 
     /// <summary>
@@ -1357,6 +4652,7 @@ namespace option {
         /// </summary>
         /// <returns></returns>
         const OptionMap& map() const { return this->_map; }
+        OptionMap& map() { return this->_map; }
 
         /// <summary>
         /// オプションの追加のためのAddOptionsの生成
@@ -1375,6 +4671,28 @@ namespace option {
             return this->_map.parse(argc, argv, validate);
         }
 
+        /// <summary>
+        /// コマンドライン引数を1つずつ受け取って解析するためのIncrementalParserの生成
+        /// </summary>
+        /// <typeparam name="Parser">生成するクラス(既定ではCommandLineOptionIncremental.hppを取り込む必要がある)</typeparam>
+        /// <returns></returns>
+        template <class Parser = IncrementalParser>
+        Parser parse_incremental() { return Parser(this->_map); }
+
+        /// <summary>
+        /// 解析における資源の上限の設定(信頼できない入力を解析するときに用いる)
+        /// </summary>
+        /// <param name="limits">上限</param>
+        void set_limits(const ParseLimits& limits) noexcept { this->_map.set_limits(limits); }
+
+        /// <summary>
+        /// 編集されるコマンドラインを再解析するためのEditableParseの生成
+        /// </summary>
+        /// <typeparam name="Parser">生成するクラス(既定ではCommandLineOptionEditable.hppを取り込む必要がある)</typeparam>
+        /// <returns></returns>
+        template <class Parser = EditableParse>
+        Parser parse_editable() { return Parser(this->_map); }
+
         /// <summary>
         /// コマンドラインオプションの説明の取得
         /// </summary>
@@ -1383,6 +4701,29 @@ namespace option {
             return this->_map.description(this->optionCols, this->lengthBetweenOptionAndDescription);
         }
 
+        /// <summary>
+        /// コマンドラインオプションの説明をファイルディスクリプタへ直接出力する
+        /// </summary>
+        /// <typeparam name="Sink">出力先(既定ではCommandLineOptionTerminal.hppを取り込む必要がある)</typeparam>
+        /// <typeparam name="Terminal">端末の列数の取得方法(既定ではCommandLineOptionTerminal.hppを取り込む必要がある)</typeparam>
+        /// <param name="fd">出力先のファイルディスクリプタ</param>
+        template <class Sink = FdDescriptionSink, class Terminal = TerminalWidth>
+        void print_description(int fd) const {
+            Sink sink(fd);
+            this->_map.write_description(sink, this->optionCols, this->lengthBetweenOptionAndDescription, this->totalCols != 0 ? this->totalCols : Terminal::of(fd));
+        }
+
+        /// <summary>
+        /// コマンドラインオプションの説明をFILE*へ直接出力する
+        /// </summary>
+        /// <typeparam name="Terminal">端末の列数の取得方法(既定ではCommandLineOptionTerminal.hppを取り込む必要がある)</typeparam>
+        /// <param name="fp">出力先</param>
+        template <class Terminal = TerminalWidth>
+        void print_description(std::FILE* fp = stdout) const {
+            FileDescriptionSink sink(fp);
+            this->_map.write_description(sink, this->optionCols, this->lengthBetweenOptionAndDescription, this->totalCols != 0 ? this->totalCols : Terminal::of(fp));
+        }
+
         /// <summary>
         /// コマンドラインオプションの説明におけるoption部の列数
         /// </summary>
@@ -1391,5 +4732,24 @@ namespace option {
         /// コマンドラインオプションの説明におけるoption名と説明の間の隙間
         /// </summary>
         std::size_t lengthBetweenOptionAndDescription = 2;
+        /// <summary>
+        /// print_descriptionで説明を折り返す列数(0のときはprint_descriptionの呼び出しごとに出力先の端末の列数を取得して用いる)
+        /// </summary>
+        std::size_t totalCols = 0;
     };
 }
+
+// 引数の型Tに関するクラステンプレートの明示的インスタンス化(prefixにexternを指定すると宣言となる)
+#define COMMAND_LINE_OPTION_INSTANTIATE(prefix, T)\
+    prefix template class option::Value<T>;\
+    prefix template class option::OptionValue<T>;\
+    prefix template class option::OptionHasValue<T>;\
+    prefix template class option::LongOptionHasValue<T>;\
+    prefix template class option::UnnamedOption<T>;
+#define COMMAND_LINE_OPTION_EXTERN_INSTANTIATE(T) COMMAND_LINE_OPTION_INSTANTIATE(extern, T)
+
+// COMMAND_LINE_OPTION_EXTERN_TEMPLATEが定義されているときは型名の宣言されている型に関するインスタンス化を
+// CommandLineOption.cppで1度だけ行い、各翻訳単位ではインスタンス化しない
+#ifdef COMMAND_LINE_OPTION_EXTERN_TEMPLATE
+COMMAND_LINE_OPTION_VALUE_TYPES(COMMAND_LINE_OPTION_EXTERN_INSTANTIATE)
+#endif
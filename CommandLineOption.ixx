@@ -0,0 +1,63 @@
+﻿// import option; で利用するためのモジュールインターフェース
+module;
+
+// 標準ライブラリはグローバルモジュールフラグメントで取り込む(分割したヘッダの分を含む)
+#include <string>
+#include <array>
+#include <sstream>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <deque>
+#include <iterator>
+#include <set>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <unordered_set>
+#include <string_view>
+#include <type_traits>
+#include <mutex>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <cmath>
+#include <charconv>
+#include <bit>
+#include <atomic>
+#include <span>
+#include <thread>
+#include <system_error>
+#include <bitset>
+#include <cctype>
+
+#ifdef _WIN32
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/uio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#endif
+
+export module option;
+
+#define COMMAND_LINE_OPTION_EXPORT export
+#include "CommandLineOption.hpp"
+#include "CommandLineOptionCatalog.hpp"
+#include "CommandLineOptionJson.hpp"
+#include "CommandLineOptionPattern.hpp"
+#include "CommandLineOptionPath.hpp"
+#include "CommandLineOptionTerminal.hpp"
+#include "CommandLineOptionUsage.hpp"
+#include "CommandLineOptionIncremental.hpp"
+#include "CommandLineOptionEditable.hpp"
+#include "CommandLineOptionStatic.hpp"
@@ -0,0 +1,122 @@
+﻿#pragma once
+
+#include "CommandLineOption.hpp"
+
+#ifndef _WIN32
+#include <unordered_map>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+COMMAND_LINE_OPTION_EXPORT namespace option {
+
+    /// <summary>
+    /// ファイルから読み込むoptionの説明とエラーメッセージの書式のカタログ
+    /// </summary>
+    /// <remarks>
+    /// カタログは「[言語]」で始まる節に「キー=文字列」を1行ずつ記述したUTF-8のファイルであり、節より前の行は全言語で共通となる。
+    /// ファイルは最初に参照されたときにメモリマップされ、指定した言語の行のみが索引付けされる
+    /// </remarks>
+    class FileDescriptionCatalog : public DescriptionCatalog {
+        std::string _path;
+        std::string _language;
+        std::once_flag _loaded;
+        /// <summary>
+        /// メモリマップしたファイルの内容
+        /// </summary>
+        const char* _data = nullptr;
+        std::size_t _size = 0;
+#ifdef _WIN32
+        /// <summary>
+        /// メモリマップの代替としてファイルを読み込む領域
+        /// </summary>
+        std::string _buffer;
+#endif
+        /// <summary>
+        /// キーからカタログ内の文字列への索引
+        /// </summary>
+        std::unordered_map<std::string_view, std::string_view> _index;
+
+        /// <summary>
+        /// ファイルを読み込み指定した言語の索引を構築する(読み込めないときは空のカタログとなる)
+        /// </summary>
+        void load() {
+#ifndef _WIN32
+            const int fd = ::open(this->_path.c_str(), O_RDONLY);
+            if (fd < 0) return;
+            struct stat st{};
+            if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+                void* p = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+                if (p != MAP_FAILED) {
+                    this->_data = static_cast<const char*>(p);
+                    this->_size = static_cast<std::size_t>(st.st_size);
+                }
+            }
+            ::close(fd);
+#else
+            std::FILE* fp = nullptr;
+            if (::fopen_s(&fp, this->_path.c_str(), "rb") != 0 || fp == nullptr) return;
+            char buf[4096];
+            for (std::size_t n; (n = std::fread(buf, 1, sizeof(buf), fp)) != 0;) this->_buffer.append(buf, n);
+            std::fclose(fp);
+            this->_data = this->_buffer.data();
+            this->_size = this->_buffer.size();
+#endif
+            std::string_view content(this->_data, this->_size);
+            if (content.starts_with("\xEF\xBB\xBF")) content.remove_prefix(3);
+            bool target = true;
+            while (!content.empty()) {
+                auto n = content.find('\n');
+                auto line = content.substr(0, n);
+                content.remove_prefix(n == std::string_view::npos ? content.size() : n + 1);
+                if (line.ends_with('\r')) line.remove_suffix(1);
+                if (line.empty() || line.front() == '#') continue;
+                if (line.front() == '[' && line.back() == ']') {
+                    target = line.substr(1, line.size() - 2) == this->_language;
+                    continue;
+                }
+                if (auto i = line.find('='); target && i != std::string_view::npos) {
+                    this->_index.insert_or_assign(line.substr(0, i), line.substr(i + 1));
+                }
+            }
+        }
+
+    public:
+        /// <summary>
+        /// カタログの構築(この時点ではファイルを読み込まない)
+        /// </summary>
+        /// <param name="path">カタログのファイルパス</param>
+        /// <param name="language">参照する言語の節の名前</param>
+        FileDescriptionCatalog(std::string path, std::string language) : _path(std::move(path)), _language(std::move(language)) {}
+        FileDescriptionCatalog(const FileDescriptionCatalog&) = delete;
+        FileDescriptionCatalog& operator=(const FileDescriptionCatalog&) = delete;
+        ~FileDescriptionCatalog() {
+#ifndef _WIN32
+            if (this->_data != nullptr) ::munmap(const_cast<char*>(this->_data), this->_size);
+#endif
+        }
+
+        /// <summary>
+        /// キーに対応する文字列を取得する
+        /// </summary>
+        /// <param name="key">キー</param>
+        /// <param name="fallback">該当しないときの文字列</param>
+        /// <returns>カタログ内の文字列(カタログの破棄まで有効)</returns>
+        std::string_view find(std::string_view key, std::string_view fallback) override {
+            std::call_once(this->_loaded, [this] { this->load(); });
+            auto itr = this->_index.find(key);
+            return itr == this->_index.end() ? fallback : itr->second;
+        }
+
+        /// <summary>
+        /// カタログの文字列の数(ファイルを読み込めなかったときは0)
+        /// </summary>
+        /// <returns></returns>
+        std::size_t size() {
+            std::call_once(this->_loaded, [this] { this->load(); });
+            return this->_index.size();
+        }
+    };
+}
@@ -0,0 +1,437 @@
+﻿#pragma once
+
+#include "CommandLineOptionIncremental.hpp"
+
+#include <set>
+
+COMMAND_LINE_OPTION_EXPORT namespace option {
+
+    /// <summary>
+    /// 編集されるコマンドラインを編集箇所から再解析するクラス
+    /// </summary>
+    /// <remarks>
+    /// optionの区切りごとに解析の状態を記録し、編集時は編集位置以前の最後の区切りまで適用を巻き戻してそこから再解析する。
+    /// 引数を保留しているoptionは次のトークンで区切りが確定した時点で解析し(IncrementalParser::settle)、そのトークンの手前を区切りとする。
+    /// 区切りより前のoptionの解析結果と、再解析で変化しなかったoptionの検証結果はそのまま再利用する。
+    /// 編集範囲より後ろの区切りに到達したときに解析の状態(区切りでは保留しているoptionと「-」による先読みはないため、名前なしオプションの位置、中断、資源の消費量)が
+    /// 編集前にその区切りで記録した状態と一致し、その区切り以降に適用したoptionを再解析した範囲で適用していなければ、再解析を打ち切って区切り以降の適用の記録を付け替える。
+    /// このとき再解析するトークンの数は編集の大きさと編集位置の前後のoptionの長さに比例する。
+    /// 再解析した範囲で適用したoptionが後ろで再び適用されるときは合流できないため、行末まで再解析する。
+    /// トークンの列、区切りの列、適用の記録は編集位置に間隙を置く列(GapBuffer)とし、間隙より後ろの区切りは行末からの相対的な位置と消費量で保持するため、
+    /// 付け替えるときに後ろの要素を複製もしくは書き換えることはない。合流の候補はoptionごとの間隙より後ろの適用の数から巻き戻す範囲のみを走査して求め、
+    /// 検証し直すのは巻き戻したoptionと再解析で適用したoptionのみとする。
+    /// したがって編集ごとの費用は再解析するトークンの数と、直前の編集位置から間隙を移す距離に比例し、行の長さとoptionの数によらない
+    /// </remarks>
+    class EditableParse {
+        /// <summary>
+        /// optionの区切りにおける解析の状態
+        /// </summary>
+        struct Boundary {
+            /// <summary>
+            /// 区切りとなるトークンの位置
+            /// </summary>
+            std::size_t position;
+            /// <summary>
+            /// その位置のトークンにより保留していたoptionの区切りが確定したか(そのトークンを編集するときは巻き戻す先にできない)
+            /// </summary>
+            bool settled;
+            /// <summary>
+            /// その位置のトークンの直前の解析の状態
+            /// </summary>
+            IncrementalParser::Checkpoint state;
+        };
+
+        OptionMap& _map;
+        IncrementalParser _parser;
+        GapBuffer<std::string> _tokens;
+        /// <summary>
+        /// optionの区切りにおける解析の状態(位置の昇順、間隙より後ろはflipにより行末からの相対的な値とする)
+        /// </summary>
+        GapBuffer<Boundary> _checkpoints;
+        /// <summary>
+        /// 行末まで解析した後の状態(解析時のエラーがないときのみ有効)
+        /// </summary>
+        IncrementalParser::Checkpoint _end{};
+        /// <summary>
+        /// 解析時のエラーメッセージ
+        /// </summary>
+        std::string _parse_error;
+        /// <summary>
+        /// 定義順のoptionごとの検証時のエラーメッセージ
+        /// </summary>
+        std::vector<std::string> _validation;
+        /// <summary>
+        /// 検証時のエラーがあるoption(定義順)
+        /// </summary>
+        std::set<std::size_t> _failing;
+        /// <summary>
+        /// 検証し直す必要のあるoption(編集の開始時にはすべてfalse)
+        /// </summary>
+        std::vector<bool> _dirty;
+        /// <summary>
+        /// 検証し直す必要のあるoptionの定義順のインデックス
+        /// </summary>
+        std::vector<std::size_t> _touched;
+        /// <summary>
+        /// optionごとの間隙より後ろの適用の記録の数
+        /// </summary>
+        std::vector<std::size_t> _held;
+        /// <summary>
+        /// 直前の編集で再解析したトークンの数
+        /// </summary>
+        std::size_t _reparsed = 0;
+
+        /// <summary>
+        /// 区切りの位置と消費量を行頭からの値と行末からの値の間で変換する(2回の変換で元に戻る)
+        /// </summary>
+        /// <param name="b">変換する区切り</param>
+        /// <returns></returns>
+        Boundary flip(const Boundary& b) const noexcept {
+            auto state = b.state;
+            state.offset = this->_end.offset - state.offset;
+            state.journal = this->_end.journal - state.journal;
+            state.budget.tokens = this->_end.budget.tokens - state.budget.tokens;
+            state.budget.bytes = this->_end.budget.bytes - state.budget.bytes;
+            state.budget.values = this->_end.budget.values - state.budget.values;
+            return { this->_tokens.size() - b.position, b.settled, state };
+        }
+
+        /// <summary>
+        /// i番目の区切りを行頭からの値で取得する
+        /// </summary>
+        /// <param name="i">区切りの位置</param>
+        /// <returns></returns>
+        Boundary boundary(std::size_t i) const noexcept {
+            return i < this->_checkpoints.gap() ? this->_checkpoints[i] : this->flip(this->_checkpoints[i]);
+        }
+
+        /// <summary>
+        /// optionを検証し直す対象とする
+        /// </summary>
+        /// <param name="order">定義順のインデックス</param>
+        /// <returns>新たに対象としたときにtrue</returns>
+        bool touch(std::size_t order) {
+            if (this->_dirty[order]) return false;
+            this->_dirty[order] = true;
+            this->_touched.push_back(order);
+            return true;
+        }
+
+        /// <summary>
+        /// 間隙より前の適用の記録のうちfirst番目以降のoptionを検証し直す対象とする
+        /// </summary>
+        /// <param name="first">適用の記録の位置</param>
+        void touch_from(std::size_t first) {
+            const auto head = this->_parser.journal().head();
+            for (std::size_t i = first; i < head.size(); ++i) {
+                this->touch(head[i].option->order());
+            }
+        }
+
+        /// <summary>
+        /// 検証し直す必要のあるoptionを検証する
+        /// </summary>
+        void revalidate() {
+            for (auto order : this->_touched) {
+                this->_validation[order] = OptionMap::validate_option(*this->_map._schema->option(order));
+                if (this->_validation[order].empty()) this->_failing.erase(order);
+                else this->_failing.insert(order);
+                this->_dirty[order] = false;
+            }
+            this->_touched.clear();
+        }
+
+        /// <summary>
+        /// 区切りと適用の記録の間隙をi番目の区切りの手前とその区切りの適用の記録の位置へ移す
+        /// </summary>
+        /// <param name="i">区切りの位置</param>
+        /// <param name="journal">i - 1番目の区切りにおける適用の記録の数</param>
+        void move_gap(std::size_t i, std::size_t journal) {
+            auto& checkpoints = this->_checkpoints;
+            for (std::size_t k = std::min(i, checkpoints.gap()); k < std::max(i, checkpoints.gap()); ++k) {
+                checkpoints[k] = this->flip(checkpoints[k]);
+            }
+            checkpoints.move_gap(i);
+
+            // 間隙をまたぐ適用の記録の数だけoptionごとの後ろの適用の数を増減する
+            const auto& applied = this->_parser.journal();
+            for (std::size_t k = journal; k < applied.gap(); ++k) ++this->_held[applied[k].option->order()];
+            for (std::size_t k = applied.gap(); k < journal; ++k) --this->_held[applied[k].option->order()];
+            this->_parser.detach(journal);
+        }
+
+        /// <summary>
+        /// 間隙より後ろの区切りから合流の候補を探し、それより前の区切りと適用を巻き戻して破棄する
+        /// </summary>
+        /// <param name="origin">巻き戻す区切り</param>
+        /// <param name="last">編集範囲の末尾</param>
+        /// <remarks>
+        /// 合流の候補は位置がlast以降で、それより前の取り外した適用のoptionをそれ以降で適用していない最初の区切りとする。
+        /// 走査した適用のoptionは後ろの適用の数を減らしながら数え、後ろに適用が残るoptionの数が0となる区切りを探す。
+        /// 編集の開始時には検証し直すoptionはないため、検証し直す対象であることを走査済みの印に兼ねる。
+        /// 候補がないとき(解析時のエラーがあるときを含む)は後ろの区切りと適用をすべて巻き戻す
+        /// </remarks>
+        void release(const Boundary& origin, std::size_t last) {
+            const auto held = this->_parser.journal().tail();
+            std::size_t scanned = 0;
+            std::size_t pending = 0;
+            auto scan = [&](std::size_t n) {
+                for (; scanned < n; ++scanned) {
+                    const auto order = held[scanned].option->order();
+                    const bool first = this->touch(order);
+                    --this->_held[order];
+                    if (first && this->_held[order] != 0) ++pending;
+                    else if (!first && this->_held[order] == 0) --pending;
+                }
+            };
+            auto& checkpoints = this->_checkpoints;
+            if (this->_parse_error.empty()) {
+                // 編集位置が巻き戻す区切りと一致する挿入ではその区切り自身が候補となる
+                if (origin.position >= last) {
+                    checkpoints.push_tail(this->flip(origin));
+                    return;
+                }
+                for (std::size_t k = checkpoints.gap(); k < checkpoints.size(); ++k) {
+                    const auto c = this->boundary(k);
+                    scan(c.state.journal - origin.state.journal);
+                    if (c.position >= last && pending == 0) {
+                        checkpoints.erase_tail(k - checkpoints.gap());
+                        this->_parser.drop(scanned);
+                        return;
+                    }
+                }
+            }
+            scan(held.size());
+            checkpoints.clear_tail();
+            this->_parser.drop(scanned);
+        }
+
+        /// <summary>
+        /// 再解析で到達した区切りにおいて編集前の状態と比較し、一致するときは間隙より後ろの適用の記録と区切りを付け替える
+        /// </summary>
+        /// <param name="target">合流の候補の編集後の位置</param>
+        /// <returns>合流したときにtrue</returns>
+        bool merge(std::size_t target) {
+            if (!this->_parser.at_boundary()) {
+                return false;
+            }
+            const auto now = this->_parser.checkpoint();
+            const auto then = this->boundary(this->_checkpoints.gap()).state;
+            if (now.slot != then.slot || now.stopped != then.stopped) {
+                return false;
+            }
+            // 取り外した適用はoptionに残っているため、それを除いた状態で次の名前なしの引数を受け付ける位置を求める
+            // (名前なしオプションの適用は引数を1つずつ加えるため、取り外した適用の数だけ引数の数を減らす)
+            const auto& options = this->_map._unnamed_options;
+            std::size_t cursor = now.slot;
+            for (; cursor < options.size(); ++cursor) {
+                const auto order = options[cursor]->order();
+                if (options[cursor]->mark().values - this->_held[order] < this->_map._schema->limit(order)) break;
+            }
+            if (cursor != then.cursor) {
+                return false;
+            }
+            // 付け替えた後の消費量が上限を超えるときは再解析して同じ位置でエラーとする
+            auto end = this->_end;
+            end.offset = end.offset - then.offset + now.offset;
+            end.journal = end.journal - then.journal + now.journal;
+            end.budget.tokens = end.budget.tokens - then.budget.tokens + now.budget.tokens;
+            end.budget.bytes = end.budget.bytes - then.budget.bytes + now.budget.bytes;
+            end.budget.values = end.budget.values - then.budget.values + now.budget.values;
+            const auto& limits = this->_map._budget->limits();
+            if (end.budget.tokens > limits.tokens || end.budget.bytes > limits.bytes || end.budget.values > limits.values) {
+                return false;
+            }
+            this->_parser.attach(end);
+            // 後ろの区切りは行末からの相対的な値のため、行末の状態を改めるのみで位置をずらした状態となる
+            // 合流した区切りの確定の仕方は手前の編集後のトークンによる
+            auto& checkpoints = this->_checkpoints;
+            if (checkpoints.gap() != 0 && checkpoints.head().back().position == target) {
+                checkpoints[checkpoints.gap()].settled = checkpoints.head().back().settled;
+                checkpoints.pop_head();
+            }
+            this->_end = end;
+            return true;
+        }
+
+        /// <summary>
+        /// 間隙より後ろの区切りと適用の記録をすべて巻き戻して破棄する
+        /// </summary>
+        void abandon() {
+            const auto held = this->_parser.journal().tail();
+            for (const auto& a : held) {
+                --this->_held[a.option->order()];
+                this->touch(a.option->order());
+            }
+            this->_parser.drop(held.size());
+            this->_checkpoints.clear_tail();
+        }
+
+    public:
+        /// <summary>
+        /// 空のコマンドラインとしての構築(optionの定義は解析前の状態へ初期化される)
+        /// </summary>
+        /// <param name="map">解析結果を格納するoptionの定義</param>
+        EditableParse(OptionMap& map) : _map(map), _parser(map, true), _validation(map._schema->size()), _dirty(map._schema->size(), false), _held(map._schema->size(), 0) {
+            this->_map.init();
+            this->_checkpoints.push_head({ 0, false, this->_parser.checkpoint() });
+            this->_parser.finish(false);
+            this->_end = this->_parser.checkpoint();
+            for (std::size_t i = 0; i < this->_dirty.size(); ++i) this->touch(i);
+            this->revalidate();
+        }
+
+        /// <summary>
+        /// トークンの範囲[first, last)を置き換えて再解析する(編集位置以前の最後の区切りから、編集前の状態と合流する区切りもしくは末尾までを再解析する)
+        /// </summary>
+        /// <typeparam name="It">std::string_viewに変換可能な要素の反復子</typeparam>
+        /// <param name="first">置き換える範囲の先頭</param>
+        /// <param name="last">置き換える範囲の末尾</param>
+        /// <param name="begin">置き換え後のトークンの先頭</param>
+        /// <param name="end">置き換え後のトークンの末尾</param>
+        template <class It>
+        void edit(std::size_t first, std::size_t last, It begin, It end) {
+            if (first > last || last > this->_tokens.size()) {
+                throw std::invalid_argument(MessageFormat::format("編集範囲 [{0}, {1}) はトークンの範囲外です", first, last));
+            }
+            // 置き換え後のトークンは現在のトークンを参照し得るため、列を変更する前に取り出す
+            std::vector<std::string> inserted;
+            for (; begin != end; ++begin) inserted.emplace_back(std::string_view(*begin));
+
+            // 編集位置以前で最後の区切りまで巻き戻す
+            std::size_t low = 0, high = this->_checkpoints.size();
+            while (high - low > 1) {
+                const std::size_t mid = low + (high - low) / 2;
+                if (this->boundary(mid).position <= first) low = mid;
+                else high = mid;
+            }
+            auto origin = this->boundary(low);
+            if (origin.position == first && origin.settled) origin = this->boundary(--low);
+            const std::size_t from = origin.position;
+
+            // 合流の候補以降の区切りと適用は間隙の後ろに残し、それより前を巻き戻す
+            this->move_gap(low + 1, origin.state.journal);
+            this->release(origin, last);
+            this->_parser.rollback(origin.state);
+
+            this->_tokens.move_gap(first);
+            this->_tokens.erase_tail(last - first);
+            for (auto& token : inserted) this->_tokens.push_head(std::move(token));
+
+            // 合流をあきらめるときは取り外した適用を巻き戻す
+            constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+            std::size_t target = this->_checkpoints.gap() == this->_checkpoints.size() ? npos : this->boundary(this->_checkpoints.gap()).position;
+            // 名前なしの引数は上限に達した名前なしオプションを読み飛ばすため、いずれかが後ろで適用されるときはすべてを対象とする
+            const bool unnamed_held = std::any_of(this->_map._unnamed_options.begin(), this->_map._unnamed_options.end(),
+                [&](const auto& u) { return this->_held[u->order()] != 0; });
+            auto reserved = [&](std::size_t order) {
+                return this->_held[order] != 0 || (unnamed_held && this->_map._schema->kind(order) == SchemaTable::KIND::UNNAMED);
+            };
+            auto abandon = [&]() {
+                this->abandon();
+                target = npos;
+            };
+            // 取り外した適用と同じoptionを適用したときは直前の区切りからやり直す
+            auto restart = [&]() {
+                const auto boundary = this->_checkpoints.head().back();
+                this->touch_from(boundary.state.journal);
+                this->_parser.rollback(boundary.state);
+                abandon();
+                return boundary.position;
+            };
+
+            auto conflict = [&](std::size_t applied) {
+                if (target == npos) return false;
+                const auto head = this->_parser.journal().head();
+                return std::any_of(head.begin() + applied, head.end(), [&](const auto& a) { return reserved(a.option->order()); });
+            };
+
+            this->_parse_error.clear();
+            this->_reparsed = 0;
+            bool merged = false;
+            for (std::size_t i = from; !merged;) {
+                try {
+                    while (true) {
+                        if (this->_checkpoints.gap() == 0 || this->_checkpoints.head().back().position != i) {
+                            // 次のトークンで区切りが確定するoptionは先に解析して、その手前を区切りとして記録する
+                            const bool pending = !this->_parser.at_boundary();
+                            const std::size_t applied = this->_parser.journal().gap();
+                            if (pending && i < this->_tokens.size()) this->_parser.settle(this->_tokens[i]);
+                            if (conflict(applied)) {
+                                i = restart();
+                                continue;
+                            }
+                            if (this->_parser.at_boundary()) {
+                                this->_checkpoints.push_head({ i, pending, this->_parser.checkpoint() });
+                            }
+                        }
+                        if (i == target) {
+                            if (this->merge(target)) {
+                                merged = true;
+                                break;
+                            }
+                            abandon();
+                        }
+                        if (i == this->_tokens.size()) break;
+                        const std::size_t applied = this->_parser.journal().gap();
+                        this->_parser.push(this->_tokens[i]);
+                        ++this->_reparsed;
+                        if (conflict(applied)) {
+                            i = restart();
+                            continue;
+                        }
+                        ++i;
+                    }
+                    if (!merged) {
+                        this->_parser.finish(false);
+                        this->_end = this->_parser.checkpoint();
+                    }
+                    break;
+                }
+                catch (const std::runtime_error& e) {
+                    if (target != npos) {
+                        i = restart();
+                        continue;
+                    }
+                    this->_parse_error = e.what();
+                    break;
+                }
+            }
+            this->touch_from(origin.state.journal);
+            this->revalidate();
+        }
+
+        /// <summary>
+        /// トークンの範囲[first, last)を置き換えて再解析する
+        /// </summary>
+        /// <param name="first">置き換える範囲の先頭</param>
+        /// <param name="last">置き換える範囲の末尾</param>
+        /// <param name="tokens">置き換え後のトークン</param>
+        void edit(std::size_t first, std::size_t last, std::initializer_list<std::string_view> tokens) {
+            this->edit(first, last, tokens.begin(), tokens.end());
+        }
+
+        /// <summary>
+        /// 現在のトークンの取得
+        /// </summary>
+        /// <returns>先頭から順に参照できるトークンの列</returns>
+        const GapBuffer<std::string>& tokens() const noexcept { return this->_tokens; }
+
+        /// <summary>
+        /// 解析もしくは検証のエラーメッセージの取得
+        /// </summary>
+        /// <returns>解析時のエラーもしくは定義順で最初の検証時のエラー(エラーがないときは空)</returns>
+        std::string_view error() const noexcept {
+            if (!this->_parse_error.empty()) {
+                return this->_parse_error;
+            }
+            return this->_failing.empty() ? std::string_view() : std::string_view(this->_validation[*this->_failing.begin()]);
+        }
+
+        /// <summary>
+        /// 直前の編集で再解析したトークンの数
+        /// </summary>
+        /// <returns></returns>
+        std::size_t reparsed() const noexcept { return this->_reparsed; }
+    };
+}
@@ -0,0 +1,612 @@
+﻿#pragma once
+
+#include "CommandLineOption.hpp"
+
+#include <deque>
+#include <iterator>
+
+COMMAND_LINE_OPTION_EXPORT namespace option {
+
+    /// <summary>
+    /// 間隙の前後に要素を保持する列(間隙の位置での挿入と削除は移動する要素の数によらない)
+    /// </summary>
+    /// <remarks>
+    /// 間隙を移すときは間にある要素のみを移動するため、同じ位置付近での挿入と削除を繰り返す費用は列の長さによらない。
+    /// 要素の添字は間隙の位置によらず先頭からの位置とする
+    /// </remarks>
+    template <class T>
+    class GapBuffer {
+        std::vector<T> _data;
+        /// <summary>
+        /// 間隙の先頭(間隙より前の要素の数)
+        /// </summary>
+        std::size_t _gap = 0;
+        /// <summary>
+        /// 間隙の後ろの要素の先頭
+        /// </summary>
+        std::size_t _tail = 0;
+
+        /// <summary>
+        /// 間隙をn要素以上とする(後ろの要素を確保し直した領域の末尾へ移す)
+        /// </summary>
+        void reserve_gap(std::size_t n) {
+            if (this->_tail - this->_gap >= n) return;
+            const std::size_t old_size = this->_data.size();
+            this->_data.resize(std::max(old_size * 2, old_size + n));
+            std::move_backward(this->_data.begin() + this->_tail, this->_data.begin() + old_size, this->_data.end());
+            this->_tail += this->_data.size() - old_size;
+        }
+
+    public:
+        /// <summary>
+        /// 先頭から順に要素を参照する反復子
+        /// </summary>
+        class const_iterator {
+            const GapBuffer* _buffer = nullptr;
+            std::size_t _index = 0;
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const T*;
+            using reference = const T&;
+
+            const_iterator() = default;
+            const_iterator(const GapBuffer* buffer, std::size_t index) : _buffer(buffer), _index(index) {}
+            reference operator*() const { return (*this->_buffer)[this->_index]; }
+            pointer operator->() const { return &(*this->_buffer)[this->_index]; }
+            const_iterator& operator++() { ++this->_index; return *this; }
+            const_iterator operator++(int) { auto result = *this; ++this->_index; return result; }
+            bool operator==(const const_iterator& other) const noexcept { return this->_index == other._index; }
+        };
+
+        std::size_t size() const noexcept { return this->_gap + (this->_data.size() - this->_tail); }
+        bool empty() const noexcept { return this->size() == 0; }
+        T& operator[](std::size_t i) noexcept { return i < this->_gap ? this->_data[i] : this->_data[i - this->_gap + this->_tail]; }
+        const T& operator[](std::size_t i) const noexcept { return i < this->_gap ? this->_data[i] : this->_data[i - this->_gap + this->_tail]; }
+        const_iterator begin() const noexcept { return const_iterator(this, 0); }
+        const_iterator end() const noexcept { return const_iterator(this, this->size()); }
+
+        /// <summary>
+        /// 間隙の位置(間隙より前の要素の数)
+        /// </summary>
+        /// <returns></returns>
+        std::size_t gap() const noexcept { return this->_gap; }
+        /// <summary>
+        /// 間隙より前の要素
+        /// </summary>
+        /// <returns></returns>
+        std::span<const T> head() const noexcept { return std::span<const T>(this->_data.data(), this->_gap); }
+        /// <summary>
+        /// 間隙より後ろの要素
+        /// </summary>
+        /// <returns></returns>
+        std::span<const T> tail() const noexcept { return std::span<const T>(this->_data.data() + this->_tail, this->_data.size() - this->_tail); }
+
+        /// <summary>
+        /// 間隙をi番目の要素の手前へ移す
+        /// </summary>
+        /// <param name="i">要素の位置</param>
+        void move_gap(std::size_t i) {
+            if (this->_gap == this->_tail) {
+                // 間隙が空のときは要素を移動せずに位置のみを改める(自身への移動代入を避ける)
+                this->_gap = this->_tail = i;
+            }
+            else if (i < this->_gap) {
+                const std::size_t n = this->_gap - i;
+                std::move_backward(this->_data.begin() + i, this->_data.begin() + this->_gap, this->_data.begin() + this->_tail);
+                this->_gap -= n;
+                this->_tail -= n;
+            }
+            else if (i > this->_gap) {
+                const std::size_t n = i - this->_gap;
+                std::move(this->_data.begin() + this->_tail, this->_data.begin() + this->_tail + n, this->_data.begin() + this->_gap);
+                this->_gap += n;
+                this->_tail += n;
+            }
+        }
+
+        /// <summary>
+        /// 間隙の直前に要素を加える
+        /// </summary>
+        void push_head(T value) {
+            this->reserve_gap(1);
+            this->_data[this->_gap++] = std::move(value);
+        }
+        /// <summary>
+        /// 間隙の直後に要素を加える
+        /// </summary>
+        void push_tail(T value) {
+            this->reserve_gap(1);
+            this->_data[--this->_tail] = std::move(value);
+        }
+        /// <summary>
+        /// 間隙の直前の要素を取り除く
+        /// </summary>
+        void pop_head() {
+            this->_data[--this->_gap] = T();
+        }
+        /// <summary>
+        /// 間隙の直後のn個の要素を取り除く
+        /// </summary>
+        void erase_tail(std::size_t n) {
+            for (std::size_t i = 0; i < n; ++i) this->_data[this->_tail++] = T();
+        }
+        /// <summary>
+        /// 間隙より後ろの要素をすべて取り除く
+        /// </summary>
+        void clear_tail() { this->erase_tail(this->_data.size() - this->_tail); }
+        /// <summary>
+        /// 全ての要素を取り除く
+        /// </summary>
+        void clear() {
+            this->_data.clear();
+            this->_gap = this->_tail = 0;
+        }
+    };
+
+    /// <summary>
+    /// コマンドライン引数を1つずつ受け取って解析するクラス
+    /// </summary>
+    /// <remarks>
+    /// 引数を待つoptionや「-」による先読みの状態を保持したまま制御を返すため、入力を待つスレッドを必要としない。
+    /// トークンの区切りをOptionMap::parseと同じ規則で判定し、区切ったトークンをOptionMap::parseと同じ処理で解析するため、
+    /// 全てのトークンを一度にOptionMap::parseへ渡したときと同じ結果となる
+    /// </remarks>
+    class IncrementalParser {
+    public:
+        /// <summary>
+        /// 解析が完了したoptionと引数の組
+        /// </summary>
+        struct Event {
+            /// <summary>
+            /// 解析したoption(名前なしオプションではその定義)
+            /// </summary>
+            const OptionBase* option;
+            /// <summary>
+            /// 引数(引数のないoptionでは空)
+            /// </summary>
+            std::string_view value;
+        };
+
+        /// <summary>
+        /// 解析を適用したoptionとその直前の状態
+        /// </summary>
+        struct Applied {
+            OptionBase* option;
+            OptionMark before;
+        };
+
+        /// <summary>
+        /// optionの区切りにおける解析の状態
+        /// </summary>
+        struct Checkpoint {
+            std::size_t slot;
+            /// <summary>
+            /// 次の名前なしの引数を受け付ける名前なしオプションの位置(slot以降で上限に達したものを除く)
+            /// </summary>
+            std::size_t cursor;
+            int offset;
+            bool stopped;
+            /// <summary>
+            /// 記録済みの適用の数
+            /// </summary>
+            std::size_t journal;
+            /// <summary>
+            /// 資源の消費量
+            /// </summary>
+            ParseBudget::Usage budget;
+        };
+
+    private:
+        OptionMap& _map;
+        /// <summary>
+        /// 受け取ったトークン(末尾の_unit_size個が解析を保留しているトークン)
+        /// </summary>
+        std::deque<std::string> _tokens;
+        /// <summary>
+        /// 解析を保留しているoptionとその引数のトークンの数
+        /// </summary>
+        std::size_t _unit_size = 0;
+        /// <summary>
+        /// 保留しているoptionを検索する索引とキー
+        /// </summary>
+        const OptionLookup* _lookup = nullptr;
+        std::string_view _key;
+        /// <summary>
+        /// 保留しているトークンのうち引数となるものの位置
+        /// </summary>
+        std::vector<std::size_t> _values;
+        /// <summary>
+        /// 保留しているoptionがさらに受け取ることのできる引数の数
+        /// </summary>
+        std::size_t _remaining = 0;
+        /// <summary>
+        /// 保留しているトークンの末尾がハイフンのみで構成され先読みを待つときにtrue
+        /// </summary>
+        bool _dash = false;
+        /// <summary>
+        /// 直前のトークンがハイフンのみで構成され次のトークンを名前なしオプションとするときにtrue
+        /// </summary>
+        bool _unnamed_dash = false;
+        /// <summary>
+        /// 引数を受け付ける名前なしオプションの位置
+        /// </summary>
+        std::size_t _slot = 0;
+        /// <summary>
+        /// 受け付けたトークンの数
+        /// </summary>
+        int _offset = 0;
+        /// <summary>
+        /// 名前なしオプションにより後続の解析が中断されたときにtrue
+        /// </summary>
+        bool _stopped = false;
+        std::vector<const char*> _argv;
+        std::vector<Event> _events;
+        /// <summary>
+        /// 保留しているトークンを解析するoption
+        /// </summary>
+        OptionBase* _candidate = nullptr;
+        /// <summary>
+        /// 巻き戻しのために適用を記録するときにtrue
+        /// </summary>
+        bool _journaling;
+        /// <summary>
+        /// 適用の記録(detachで取り外した記録は間隙の後ろに置いたまま保持する)
+        /// </summary>
+        GapBuffer<Applied> _journal;
+        /// <summary>
+        /// detachで取り外した適用の記録を保持しているときにtrue(attachするまでの間は間隙の前のみを適用の記録とする)
+        /// </summary>
+        bool _held = false;
+
+        /// <summary>
+        /// 適用の記録の末尾へ間隙を移す(取り外した記録を保持していないときのみ)
+        /// </summary>
+        /// <remarks>
+        /// attachした後に間隙は移さずに残すため、続けて解析もしくは巻き戻すときに末尾へ移す
+        /// </remarks>
+        void unhold() {
+            if (!this->_held) this->_journal.move_gap(this->_journal.size());
+        }
+
+        /// <summary>
+        /// 末尾のトークンを解析するoptionを索引から検索し、引数を受け取らないときはそのまま解析する
+        /// </summary>
+        /// <param name="lookup">検索の構造</param>
+        /// <param name="key">接頭辞と引数を除いたオプション名</param>
+        /// <returns>該当するoptionが存在したときにtrue</returns>
+        bool begin(const OptionLookup& lookup, std::string_view key) {
+            const std::string_view token = this->_tokens.back();
+            for (const auto& ptr : lookup.find(key)) {
+                std::size_t n = 0;
+                if (ptr->following_values(token, n)) {
+                    this->_candidate = ptr.get();
+                    this->_lookup = &lookup;
+                    this->_key = key;
+                    this->_unit_size = 1;
+                    this->_remaining = n;
+                    this->_values.clear();
+                    if (n == 0) this->flush(0);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /// <summary>
+        /// 末尾のトークンを保留しているoptionの外で解析する
+        /// </summary>
+        void start() {
+            this->_map.freeze();
+            const std::string& token = this->_tokens.back();
+            if (this->_unnamed_dash) {
+                this->_unnamed_dash = false;
+                this->unnamed();
+            }
+            else if (Option::is_option(token.c_str())) {
+                if (!this->begin(this->_map._option_lookup, std::string_view(token).substr(1))) {
+                    throw std::runtime_error(DescriptionCatalog::message("error.unknown_option", "{0} に該当するoptionは存在しません", token));
+                }
+            }
+            else if (LongOption::is_long_option(token.c_str())) {
+                auto key = std::string_view(token).substr(2);
+                key = key.substr(0, key.find('='));
+                // --no-から始まるときは否定可能なoptionとしても検索する
+                if (!this->begin(this->_map._long_option_lookup, key) &&
+                    !(key.starts_with("no-") && this->begin(this->_map._long_option_lookup, key.substr(3)))) {
+                    throw std::runtime_error(DescriptionCatalog::message("error.unknown_long_option", "{0} に該当するlong optionは存在しません", token));
+                }
+            }
+            else if (OptionBase::is_dash(token.c_str())) {
+                this->_unnamed_dash = true;
+            }
+            else {
+                this->unnamed();
+            }
+        }
+
+        /// <summary>
+        /// 保留しているoptionとその引数を解析する
+        /// </summary>
+        /// <param name="excluded">末尾から除外するまだ解析していないトークンの数</param>
+        void flush(std::size_t excluded) {
+            const std::size_t end = this->_tokens.size() - excluded;
+            const std::size_t first = end - this->_unit_size;
+            this->_argv.clear();
+            for (std::size_t i = first; i < end; ++i) {
+                this->_argv.push_back(this->_tokens[i].c_str());
+            }
+            int offset = 0;
+            int argc = static_cast<int>(this->_unit_size);
+            this->_unit_size = 0;
+            this->_dash = false;
+            if (this->_journaling) {
+                // 解析の途中で例外を投げたときも巻き戻せるように解析の前に記録する
+                this->unhold();
+                this->_journal.push_head({ this->_candidate, this->_candidate->mark() });
+            }
+            auto matched = OptionMap::parse_indexed(*this->_lookup, this->_key, offset, argc, this->_argv.data());
+            if (matched == nullptr) {
+                throw std::runtime_error(DescriptionCatalog::message("error.unknown_option", "{0} に該当するoptionは存在しません", this->_tokens[first]));
+            }
+            if (!this->_journaling) {
+                this->_map.count_usage(matched);
+            }
+
+            const std::string_view token = this->_tokens[first];
+            if (this->_values.empty()) {
+                const auto i = token.find('=');
+                this->_events.push_back({ matched, i == std::string_view::npos ? std::string_view() : token.substr(i + 1) });
+            }
+            for (auto i : this->_values) {
+                this->_events.push_back({ matched, this->_tokens[first + i] });
+            }
+        }
+
+        /// <summary>
+        /// 末尾のトークンを名前なしオプションとして解析する
+        /// </summary>
+        void unnamed() {
+            auto& options = this->_map._unnamed_options;
+            if (options.empty()) {
+                throw std::runtime_error(DescriptionCatalog::message("error.unnamed_option", "名前なしオプションの設定はできません"));
+            }
+            // 中断を検出するためにargcを1つ多く渡す(中断したときはargcが解析後のオフセットに書き換えられる)
+            const char* argv[] = { this->_tokens.back().c_str(), "" };
+            int offset = 0;
+            int argc = 2;
+            for (; this->_slot < options.size(); ++this->_slot) {
+                auto& option = options[this->_slot];
+                if (this->_journaling) {
+                    this->unhold();
+                    this->_journal.push_head({ option.get(), option->mark() });
+                }
+                if (option->parse(offset, argc, argv)) break;
+                if (this->_journaling) this->_journal.pop_head();
+            }
+            if (this->_slot == options.size()) {
+                throw std::runtime_error(DescriptionCatalog::message("error.too_many_unnamed_options", "これ以上の名前なしオプション {0} は設定不可です", argv[0]));
+            }
+            this->_events.push_back({ options[this->_slot].get(), this->_tokens.back() });
+            this->_stopped = argc == offset;
+        }
+
+        /// <summary>
+        /// 前回の呼び出しで返したトークンを破棄する
+        /// </summary>
+        void retire() {
+            this->_events.clear();
+            while (this->_tokens.size() > this->_unit_size) {
+                this->_tokens.pop_front();
+            }
+        }
+
+    public:
+        /// <summary>
+        /// 解析器の構築
+        /// </summary>
+        /// <param name="map">解析結果を格納するoptionの定義</param>
+        /// <param name="journaling">checkpointとrollbackにより解析を巻き戻せるようにするときにtrue(このときは使用回数を計測しない)</param>
+        IncrementalParser(OptionMap& map, bool journaling = false) : _map(map), _journaling(journaling) {
+            this->_map._budget->reset();
+        }
+
+        /// <summary>
+        /// コマンドライン引数を1つ解析する
+        /// </summary>
+        /// <param name="token">コマンドライン引数</param>
+        /// <returns>このトークンにより解析が完了したoptionと引数の組(次の呼び出しまで有効)</returns>
+        /// <remarks>
+        /// optionの引数となりうるトークンは後続のトークンにより区切りが確定するまで保留される。
+        /// 後続の解析が中断された後のトークンは受け付けない
+        /// </remarks>
+        const std::vector<Event>& push(std::string_view token) {
+            this->retire();
+            if (this->_stopped) {
+                return this->_events;
+            }
+            // 保留するトークンは上限を超えて蓄積しない
+            this->_map._budget->consume_token(token);
+            const char* str = this->_tokens.emplace_back(token).c_str();
+            ++this->_offset;
+            if (this->_unit_size == 0) {
+                this->start();
+            }
+            else if (this->_dash ? str[0] != '-' : (Option::is_option(str) || LongOption::is_long_option(str))) {
+                // 保留しているoptionの引数はこのトークンの手前までとなる
+                this->flush(1);
+                this->start();
+            }
+            else if (!this->_dash && OptionBase::is_dash(str)) {
+                // 先読みを行ってそれが「-」から始まるならそれを引数として扱う
+                ++this->_unit_size;
+                this->_dash = true;
+            }
+            else {
+                this->_dash = false;
+                this->_values.push_back(this->_unit_size++);
+                if (--this->_remaining == 0) this->flush(0);
+            }
+            return this->_events;
+        }
+
+        /// <summary>
+        /// 次のトークンにより保留しているoptionの区切りが確定するときは、そのトークンを受け付ける前に保留しているoptionを解析する
+        /// </summary>
+        /// <param name="token">次にpushへ渡すコマンドライン引数</param>
+        /// <returns>区切りが確定したoptionと引数の組(次の呼び出しまで有効)</returns>
+        /// <remarks>
+        /// 続けてpushにtokenを渡したときと同じ結果となり、その間はat_boundaryにより区切りとして状態を記録できる。
+        /// tokenが資源の上限を超えるときはpushでそのエラーを先に投げるため、ここでは解析しない
+        /// </remarks>
+        const std::vector<Event>& settle(std::string_view token) {
+            this->retire();
+            const auto& usage = this->_map._budget->usage();
+            const auto& limits = this->_map._budget->limits();
+            if (this->_stopped || this->_unit_size == 0 || usage.tokens >= limits.tokens || usage.bytes + token.size() > limits.bytes) {
+                return this->_events;
+            }
+            const std::string str(token);
+            if (this->_dash ? str[0] != '-' : (Option::is_option(str.c_str()) || LongOption::is_long_option(str.c_str()))) {
+                this->flush(0);
+            }
+            return this->_events;
+        }
+
+        /// <summary>
+        /// 入力の終了を通知して保留しているoptionを解析する
+        /// </summary>
+        /// <param name="validate">引数のチェックを行うか</param>
+        /// <returns>保留していたoptionと引数の組</returns>
+        const std::vector<Event>& finish(bool validate = true) {
+            this->retire();
+            if (this->_unit_size != 0) {
+                this->flush(0);
+            }
+            this->_unnamed_dash = false;
+            if (validate) {
+                this->_map.validate();
+            }
+            return this->_events;
+        }
+
+        /// <summary>
+        /// 名前なしオプションにより後続の解析が中断されたかの判定
+        /// </summary>
+        /// <returns></returns>
+        bool stopped() const noexcept { return this->_stopped; }
+
+        /// <summary>
+        /// 受け付けたトークンの数(OptionMap::parseの解析後のオフセットに相当する)
+        /// </summary>
+        /// <returns></returns>
+        int offset() const noexcept { return this->_offset; }
+
+        /// <summary>
+        /// 次のトークンがoptionの区切りとなるかの判定
+        /// </summary>
+        /// <returns>保留しているトークンがなく次のトークンを新たに解析するときにtrue</returns>
+        bool at_boundary() const noexcept { return this->_unit_size == 0 && !this->_unnamed_dash; }
+
+        /// <summary>
+        /// optionの区切りにおける解析の状態を取得する
+        /// </summary>
+        /// <returns></returns>
+        Checkpoint checkpoint() const {
+            if (!this->at_boundary()) {
+                throw std::logic_error("optionの区切り以外で状態を記録することはできません");
+            }
+            // 上限に達した名前なしオプションは次の名前なしの引数で読み飛ばされるため、合流の判定ではその先の位置を比較する
+            const auto& options = this->_map._unnamed_options;
+            std::size_t cursor = this->_slot;
+            while (cursor < options.size() && options[cursor]->mark().values >= this->_map._schema->limit(options[cursor]->order())) {
+                ++cursor;
+            }
+            // 取り外した適用の記録を保持している間はそれを除いた数とする
+            return { this->_slot, cursor, this->_offset, this->_stopped, this->_held ? this->_journal.gap() : this->_journal.size(), this->_map._budget->usage() };
+        }
+
+        /// <summary>
+        /// 適用の記録を遡ってoptionの区切りにおける状態へ巻き戻す
+        /// </summary>
+        /// <param name="checkpoint">checkpointで取得した状態</param>
+        void rollback(const Checkpoint& checkpoint) {
+            if (!this->_journaling) {
+                throw std::logic_error("適用を記録しない解析は巻き戻すことはできません");
+            }
+            this->unhold();
+            while (this->_journal.gap() > checkpoint.journal) {
+                const auto& applied = this->_journal.head().back();
+                applied.option->rewind(applied.before);
+                this->_journal.pop_head();
+            }
+            this->_tokens.clear();
+            this->_events.clear();
+            this->_unit_size = 0;
+            this->_dash = false;
+            this->_unnamed_dash = false;
+            this->_slot = checkpoint.slot;
+            this->_offset = checkpoint.offset;
+            this->_stopped = checkpoint.stopped;
+            this->_map._budget->restore(checkpoint.budget);
+        }
+
+        /// <summary>
+        /// 適用の記録のうちfirst番目以降を巻き戻さずに取り外す
+        /// </summary>
+        /// <param name="first">適用の記録の位置</param>
+        /// <remarks>
+        /// 取り外した記録は複製せずに間隙の後ろ(journal().tail())に保持し、以降の解析はその手前に記録する。
+        /// 間隙を移す費用は直前に取り外した位置からの距離に比例する
+        /// </remarks>
+        void detach(std::size_t first) {
+            if (!this->_journaling) {
+                throw std::logic_error("適用を記録しない解析から適用の記録を取り外すことはできません");
+            }
+            this->_journal.move_gap(first);
+            this->_held = true;
+        }
+
+        /// <summary>
+        /// 取り外した適用の記録のうち先頭からn個を巻き戻して破棄する(後ろから順に巻き戻す)
+        /// </summary>
+        /// <param name="n">破棄する適用の記録の数</param>
+        void drop(std::size_t n) {
+            const auto held = this->_journal.tail();
+            for (std::size_t i = n; i > 0; --i) {
+                held[i - 1].option->rewind(held[i - 1].before);
+            }
+            this->_journal.erase_tail(n);
+        }
+
+        /// <summary>
+        /// detachで取り外した適用の記録を付け加え、それらを適用し終えたoptionの区切りにおける状態とする
+        /// </summary>
+        /// <param name="checkpoint">適用し終えた区切りにおける状態(journalは付け加えた後の記録の数)</param>
+        /// <remarks>
+        /// 取り外した記録はoptionに適用済みであること。記録は移動せずに間隙を残したまま適用の記録に戻す
+        /// </remarks>
+        void attach(const Checkpoint& checkpoint) {
+            if (!this->_journaling) {
+                throw std::logic_error("適用を記録しない解析に適用の記録を付け加えることはできません");
+            }
+            if (!this->at_boundary() || this->_journal.size() != checkpoint.journal) {
+                throw std::logic_error("optionの区切りにおける状態と適用の記録が一致しません");
+            }
+            this->_held = false;
+            this->_tokens.clear();
+            this->_events.clear();
+            this->_slot = checkpoint.slot;
+            this->_offset = checkpoint.offset;
+            this->_stopped = checkpoint.stopped;
+            this->_map._budget->restore(checkpoint.budget);
+        }
+
+        /// <summary>
+        /// 適用の記録の取得
+        /// </summary>
+        /// <returns>適用の記録(detachで取り外した記録は間隙の後ろ)</returns>
+        const GapBuffer<Applied>& journal() const noexcept { return this->_journal; }
+    };
+}
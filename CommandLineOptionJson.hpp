@@ -0,0 +1,285 @@
+﻿#pragma once
+
+#include "CommandLineOption.hpp"
+
+// SSE2が利用できるときはJSON文字列のエスケープに用いる
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define COMMAND_LINE_OPTION_SSE2
+#endif
+
+COMMAND_LINE_OPTION_EXPORT namespace option {
+
+    /// <summary>
+    /// JSONを伸長可能なバッファへ直接書き込むクラス
+    /// </summary>
+    class JsonWriter : public JsonSink {
+        std::string _buffer;
+        /// <summary>
+        /// 次の値の前に区切り「,」が必要なときにtrue
+        /// </summary>
+        bool _separate = false;
+
+        /// <summary>
+        /// 必要であれば区切りを出力する
+        /// </summary>
+        void separate() {
+            if (this->_separate) this->_buffer.push_back(',');
+            this->_separate = false;
+        }
+
+        /// <summary>
+        /// 数値を出力する
+        /// </summary>
+        /// <param name="x">出力する数値</param>
+        template <class T>
+        void number(T x) {
+            this->separate();
+            if constexpr (std::is_floating_point_v<T>) {
+                // JSONで表現できない無限大と非数はnullとする
+                if (!std::isfinite(x)) {
+                    this->_buffer.append("null");
+                    this->_separate = true;
+                    return;
+                }
+            }
+            char buf[128];
+            auto [end, ec] = std::to_chars(buf, buf + sizeof(buf), x);
+            this->_buffer.append(buf, ec == std::errc() ? end : buf);
+            this->_separate = true;
+        }
+
+    protected:
+        void write_null() override {
+            this->separate();
+            this->_buffer.append("null");
+            this->_separate = true;
+        }
+        void write_bool(bool x) override {
+            this->separate();
+            this->_buffer.append(x ? "true" : "false");
+            this->_separate = true;
+        }
+        void write_integer(long long x) override { this->number(x); }
+        void write_unsigned(unsigned long long x) override { this->number(x); }
+        void write_number(float x) override { this->number(x); }
+        void write_number(double x) override { this->number(x); }
+        void write_number(long double x) override { this->number(x); }
+        void write_string(std::string_view str) override {
+            this->separate();
+            escape(this->_buffer, str);
+            this->_separate = true;
+        }
+
+    public:
+        /// <summary>
+        /// JSON文字列として出力する必要のある文字であるかの判定
+        /// </summary>
+        /// <param name="c">判定対象の文字</param>
+        /// <returns></returns>
+        static constexpr bool needs_escape(char c) noexcept {
+            return c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20;
+        }
+
+        /// <summary>
+        /// 先頭のUTF-8のバイト列の長さを取得する
+        /// </summary>
+        /// <param name="str">対象の文字列(空でないこと)</param>
+        /// <returns>バイト数(不正なバイト列のときは0)</returns>
+        /// <remarks>
+        /// 冗長な符号化、サロゲート、U+10FFFFを超えるコードポイントは不正とする
+        /// </remarks>
+        static constexpr std::size_t utf8_length(std::string_view str) noexcept {
+            const auto byte = [&str](std::size_t i) { return static_cast<unsigned char>(str[i]); };
+            const auto lead = byte(0);
+            std::size_t n = 0;
+            unsigned char low = 0x80, high = 0xBF;
+            if (lead < 0x80) return 1;
+            else if (0xC2 <= lead && lead <= 0xDF) n = 2;
+            else if (0xE0 <= lead && lead <= 0xEF) {
+                n = 3;
+                if (lead == 0xE0) low = 0xA0;
+                else if (lead == 0xED) high = 0x9F;
+            }
+            else if (0xF0 <= lead && lead <= 0xF4) {
+                n = 4;
+                if (lead == 0xF0) low = 0x90;
+                else if (lead == 0xF4) high = 0x8F;
+            }
+            else return 0;
+            if (str.size() < n || byte(1) < low || high < byte(1)) return 0;
+            for (std::size_t i = 2; i < n; ++i) {
+                if ((byte(i) & 0xC0) != 0x80) return 0;
+            }
+            return n;
+        }
+
+        /// <summary>
+        /// 文字列をエスケープしてJSON文字列として追加する
+        /// </summary>
+        /// <param name="out">出力先</param>
+        /// <param name="str">対象の文字列</param>
+        /// <remarks>
+        /// SSE2が利用できるときは16バイトずつエスケープの必要な文字と非ASCIIの文字を探し、該当しない区間はまとめて複製する。
+        /// UTF-8として不正なバイトは1バイトごとに\ufffdに置き換える
+        /// </remarks>
+        static void escape(std::string& out, std::string_view str) {
+            static constexpr char hex[] = "0123456789abcdef";
+            out.push_back('"');
+            std::size_t begin = 0;
+            for (std::size_t i = 0; i < str.size();) {
+#ifdef COMMAND_LINE_OPTION_SSE2
+                if (i + 16 <= str.size()) {
+                    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str.data() + i));
+                    const __m128i control = _mm_cmpeq_epi8(_mm_max_epu8(v, _mm_set1_epi8(0x1F)), _mm_set1_epi8(0x1F));
+                    const __m128i special = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\\')));
+                    // 最上位ビットの立つ非ASCIIのバイトもUTF-8として検査するために止まる
+                    const auto mask = static_cast<unsigned int>(_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(control, special), v)));
+                    if (mask == 0) {
+                        i += 16;
+                        continue;
+                    }
+                    i += std::countr_zero(mask);
+                }
+#endif
+                if (static_cast<unsigned char>(str[i]) >= 0x80) {
+                    if (const auto n = utf8_length(str.substr(i)); n != 0) {
+                        i += n;
+                        continue;
+                    }
+                    out.append(str.substr(begin, i - begin));
+                    out.append("\\ufffd");
+                    begin = ++i;
+                    continue;
+                }
+                if (!needs_escape(str[i])) {
+                    ++i;
+                    continue;
+                }
+                out.append(str.substr(begin, i - begin));
+                switch (const char c = str[i]; c) {
+                case '"': out.append("\\\""); break;
+                case '\\': out.append("\\\\"); break;
+                case '\b': out.append("\\b"); break;
+                case '\f': out.append("\\f"); break;
+                case '\n': out.append("\\n"); break;
+                case '\r': out.append("\\r"); break;
+                case '\t': out.append("\\t"); break;
+                default:
+                    out.append("\\u00");
+                    out.push_back(hex[(c >> 4) & 0xF]);
+                    out.push_back(hex[c & 0xF]);
+                    break;
+                }
+                begin = ++i;
+            }
+            out.append(str.substr(begin));
+            out.push_back('"');
+        }
+
+        JsonWriter& begin_object() override {
+            this->separate();
+            this->_buffer.push_back('{');
+            return *this;
+        }
+        JsonWriter& end_object() override {
+            this->_buffer.push_back('}');
+            this->_separate = true;
+            return *this;
+        }
+        JsonWriter& begin_array() override {
+            this->separate();
+            this->_buffer.push_back('[');
+            return *this;
+        }
+        JsonWriter& end_array() override {
+            this->_buffer.push_back(']');
+            this->_separate = true;
+            return *this;
+        }
+
+        /// <summary>
+        /// オブジェクトのキーを出力する
+        /// </summary>
+        /// <param name="k">キー</param>
+        /// <returns></returns>
+        JsonWriter& key(std::string_view k) override {
+            this->separate();
+            escape(this->_buffer, k);
+            this->_buffer.push_back(':');
+            return *this;
+        }
+
+        /// <summary>
+        /// 出力したJSONの取得
+        /// </summary>
+        /// <returns></returns>
+        const std::string& str() const noexcept { return this->_buffer; }
+
+        /// <summary>
+        /// 出力したJSONの取り出し
+        /// </summary>
+        /// <returns></returns>
+        std::string take() {
+            this->_separate = false;
+            return std::move(this->_buffer);
+        }
+    };
+
+    /// <summary>
+    /// 解析結果をJSONとして出力する(OptionMap::to_jsonを参照)
+    /// </summary>
+    /// <param name="map">解析したoption</param>
+    /// <param name="json">出力先</param>
+    /// <remarks>
+    /// 利用されているoption(否定可能なoptionは常に)を定義順に"options"の配列へ
+    /// {"index":定義順のインデックス,"name":接頭辞付きのoption名,"arg_pattern":引数の記載パターン,"value":解析結果}として出力し、
+    /// 名前なしオプションの引数を定義順に"unnamed"に出力する。
+    /// 「--help」と「--help=」のように同じ名前のoptionを定義できるため名前をキーとするオブジェクトにはしない
+    /// </remarks>
+    inline void write_json(const OptionMap& map, JsonSink& json) {
+        const auto& schema = map.schema();
+        json.begin_object().key("options").begin_array();
+        for (std::size_t i = 0; i < schema.size(); ++i) {
+            const auto kind = schema.kind(i);
+            if (kind == SchemaTable::KIND::UNNAMED || (!schema.option(i)->use() && kind != SchemaTable::KIND::NEGATABLE)) continue;
+            json.begin_object();
+            json.member("index", i);
+            json.member("name", std::string(schema.prefix(i)).append(schema.name(i)));
+            if (kind == SchemaTable::KIND::VALUE) OptionHasValueBase::write_json_arg_pattern(json, schema.arg_pattern(i));
+            json.key("value");
+            schema.option(i)->write_json(json);
+            json.end_object();
+        }
+        json.end_array().key("unnamed").begin_array();
+        for (std::size_t i = 0; i < schema.size(); ++i) {
+            if (schema.kind(i) == SchemaTable::KIND::UNNAMED) schema.option(i)->write_json(json);
+        }
+        json.end_array().end_object();
+    }
+
+    /// <summary>
+    /// optionの定義をJSONとして出力する(OptionMap::json_schemaを参照)
+    /// </summary>
+    /// <param name="map">optionの定義</param>
+    /// <param name="json">出力先</param>
+    inline void write_json_schema(const OptionMap& map, JsonSink& json) {
+        const auto catalog = DescriptionCatalog::current();
+        json.begin_object().key("options").begin_array();
+        const auto& schema = map.schema();
+        for (std::size_t i = 0; i < schema.size(); ++i) {
+            const auto p = schema.option(i);
+            json.begin_object();
+            json.key("name");
+            if (schema.kind(i) == SchemaTable::KIND::UNNAMED) json.value(nullptr);
+            else json.value(std::string(schema.prefix(i)).append(schema.name(i)));
+            json.key("aliases").begin_array();
+            for (const auto& alias : p->aliases()) json.value(alias);
+            json.end_array();
+            json.member("description", catalog ? catalog->find(p->description(), p->description()) : p->description());
+            p->write_json_schema(json);
+            json.end_object();
+        }
+        json.end_array().end_object();
+    }
+}
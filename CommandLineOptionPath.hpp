@@ -0,0 +1,103 @@
+﻿#pragma once
+
+#include "CommandLineOption.hpp"
+
+#include <atomic>
+#include <thread>
+#include <system_error>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+COMMAND_LINE_OPTION_EXPORT namespace option {
+
+    /// <summary>
+    /// ファイルパスである引数の検査を複数のスレッドで並行に実行する
+    /// </summary>
+    /// <remarks>
+    /// OptionMap::validateは全optionの検査要求をまとめて発行するため、
+    /// ネットワークファイルシステムなどで1件ごとの待ち時間が直列に積み重なることはない。
+    /// スレッドは保持せず、runの呼び出しごとに最大MAX_CONCURRENCY - 1個を作成して検査の終了時にjoinする
+    /// (検査要求が1件以下のときは作成しない)。そのため検査1件あたりの待ち時間がスレッドの作成より短いときは直列に実行するより遅くなり得る
+    /// </remarks>
+    class PathCheckPool {
+    public:
+        using CHECK = PathCheck::CHECK;
+
+        /// <summary>
+        /// 並行に発行する検査の最大数
+        /// </summary>
+        static constexpr std::size_t MAX_CONCURRENCY = 16;
+
+        /// <summary>
+        /// 1つのパスを検査する
+        /// </summary>
+        /// <param name="path">検査対象のパス</param>
+        /// <param name="checks">実施する検査</param>
+        /// <returns>最初に満たさなかった検査(すべて満たしたときは0)</returns>
+        static std::uint32_t check(std::string_view path, std::uint32_t checks) {
+            const std::string str(path);
+#ifdef _WIN32
+            struct ::_stat64 st{};
+            const bool exists = ::_stat64(str.c_str(), &st) == 0;
+            const bool directory = exists && (st.st_mode & _S_IFDIR) != 0;
+            auto accessible = [](const std::string& p, int mode) { return ::_access(p.c_str(), mode) == 0; };
+            constexpr int read_mode = 4, write_mode = 2;
+            constexpr std::string_view separators = "/\\";
+#else
+            struct stat st{};
+            const bool exists = ::stat(str.c_str(), &st) == 0;
+            const bool directory = exists && S_ISDIR(st.st_mode);
+            auto accessible = [](const std::string& p, int mode) { return ::access(p.c_str(), mode) == 0; };
+            constexpr int read_mode = R_OK, write_mode = W_OK;
+            constexpr std::string_view separators = "/";
+#endif
+            if ((checks & (CHECK::EXISTS | CHECK::DIRECTORY | CHECK::READABLE)) != 0 && !exists) return CHECK::EXISTS;
+            if ((checks & CHECK::DIRECTORY) != 0 && !directory) return CHECK::DIRECTORY;
+            if ((checks & CHECK::READABLE) != 0 && !accessible(str, read_mode)) return CHECK::READABLE;
+            if ((checks & CHECK::WRITABLE) != 0) {
+                if (exists) {
+                    if (!accessible(str, write_mode)) return CHECK::WRITABLE;
+                }
+                else {
+                    // 作成される予定のパスは親ディレクトリに書き込むことができるかで判定する
+                    const auto pos = str.find_last_of(separators);
+                    const std::string parent = pos == std::string::npos ? std::string(".") : str.substr(0, pos == 0 ? 1 : pos);
+                    if (!accessible(parent, write_mode)) return CHECK::WRITABLE;
+                }
+            }
+            return 0;
+        }
+
+        /// <summary>
+        /// 検査要求を呼び出し元のスレッドと新たに作成したスレッドで並行に実行する
+        /// </summary>
+        /// <param name="requests">検査要求(結果はfailedに格納される)</param>
+        /// <param name="concurrency">並行に発行する検査の最大数</param>
+        static void run(std::vector<PathCheck::Request>& requests, std::size_t concurrency = MAX_CONCURRENCY) {
+            const std::size_t workers = std::min({ requests.size(), concurrency, MAX_CONCURRENCY });
+            std::atomic<std::size_t> next = 0;
+            auto work = [&requests, &next] {
+                for (std::size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < requests.size();) {
+                    requests[i].failed = check(requests[i].path, requests[i].checks);
+                }
+            };
+            std::vector<std::thread> threads;
+            threads.reserve(workers > 1 ? workers - 1 : 0);
+            for (std::size_t i = 1; i < workers; ++i) {
+                try {
+                    threads.emplace_back(work);
+                }
+                catch (const std::system_error&) {
+                    // スレッドを作成できないときは作成済みのスレッドのみで実行する
+                    break;
+                }
+            }
+            work();
+            for (auto& thread : threads) thread.join();
+        }
+    };
+}
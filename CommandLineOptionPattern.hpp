@@ -0,0 +1,413 @@
+﻿#pragma once
+
+#include "CommandLineOption.hpp"
+
+#include <bitset>
+#include <unordered_map>
+
+COMMAND_LINE_OPTION_EXPORT namespace option {
+
+    /// <summary>
+    /// 引数の文字列全体に対するパターン(正規表現の部分集合)
+    /// </summary>
+    /// <remarks>
+    /// 構築時にバイト単位のDFAへ変換しておき、照合は入力の長さに比例する時間でメモリの確保なしに行う。
+    /// 利用可能な構文は連接、「|」、「()」、「*」「+」「?」「{m}」「{m,}」「{m,n}」、「.」(「\n」「\r」以外の任意の1バイト)、
+    /// 「[a-z]」「[^...]」の文字クラス(バイト単位)、「\d」「\w」「\s」とその否定「\D」「\W」「\S」、「\n」「\t」および記号のエスケープであり、
+    /// 常に文字列全体に一致するかを判定する(std::regex_matchと同様)。
+    /// バイト単位で照合するため、U+2028、U+2029のUTF-8表現の各バイトにも「.」は一致する(charのstd::regexと同じであり、std::wregexとは異なる)
+    /// </remarks>
+    class Pattern : public ValuePattern {
+        /// <summary>
+        /// 構文木のノード
+        /// </summary>
+        struct Node {
+            enum class KIND { EMPTY, SET, CONCAT, ALT, REPEAT } kind;
+            std::bitset<256> set;
+            std::vector<std::size_t> children;
+            std::size_t min = 0;
+            std::size_t max = 0;
+        };
+
+        /// <summary>
+        /// NFAの状態(setに含まれるバイトでnextに遷移し、epsilonへは入力なしで遷移する)
+        /// </summary>
+        struct NfaState {
+            std::bitset<256> set;
+            std::size_t next = 0;
+            std::vector<std::size_t> epsilon;
+        };
+
+        /// <summary>
+        /// 構文解析器
+        /// </summary>
+        class Parser {
+            std::string_view _source;
+            std::size_t _pos = 0;
+            std::vector<Node>& _nodes;
+
+            [[noreturn]] void fail() const {
+                throw std::invalid_argument(MessageFormat::format("パターン {0} の{1}文字目が不正です", this->_source, this->_pos + 1));
+            }
+            std::size_t add(Node node) {
+                this->_nodes.push_back(std::move(node));
+                return this->_nodes.size() - 1;
+            }
+            bool peek(char c) const { return this->_pos < this->_source.size() && this->_source[this->_pos] == c; }
+
+            static std::bitset<256> range(unsigned char first, unsigned char last) {
+                std::bitset<256> set;
+                for (std::size_t c = first; c <= last; ++c) set.set(c);
+                return set;
+            }
+
+            /// <summary>
+            /// 「\」に続く1文字が示す文字集合
+            /// </summary>
+            std::bitset<256> escape() {
+                if (this->_pos >= this->_source.size()) this->fail();
+                const char c = this->_source[this->_pos++];
+                std::bitset<256> set;
+                switch (c) {
+                case 'd': case 'D': set = range('0', '9'); break;
+                case 'w': case 'W': set = range('0', '9') | range('A', 'Z') | range('a', 'z'); set.set('_'); break;
+                case 's': case 'S': set = range('\t', '\r'); set.set(' '); break;
+                case 'n': set.set('\n'); return set;
+                case 't': set.set('\t'); return set;
+                default:
+                    if (std::isalnum(static_cast<unsigned char>(c))) {
+                        --this->_pos;
+                        this->fail();
+                    }
+                    set.set(static_cast<unsigned char>(c));
+                    return set;
+                }
+                return std::isupper(static_cast<unsigned char>(c)) ? ~set : set;
+            }
+
+            /// <summary>
+            /// 「[」に続く文字クラス
+            /// </summary>
+            std::bitset<256> bracket() {
+                std::bitset<256> set;
+                const bool negate = this->peek('^');
+                if (negate) ++this->_pos;
+                bool first = true;
+                while (this->_pos < this->_source.size() && (first || this->_source[this->_pos] != ']')) {
+                    first = false;
+                    std::bitset<256> item;
+                    const auto c = static_cast<unsigned char>(this->_source[this->_pos++]);
+                    if (c == '\\') {
+                        item = this->escape();
+                    }
+                    else if (this->_pos + 1 < this->_source.size() && this->_source[this->_pos] == '-' && this->_source[this->_pos + 1] != ']') {
+                        const auto last = static_cast<unsigned char>(this->_source[this->_pos + 1]);
+                        if (last < c) this->fail();
+                        item = range(c, last);
+                        this->_pos += 2;
+                    }
+                    else {
+                        item.set(c);
+                    }
+                    set |= item;
+                }
+                if (!this->peek(']')) this->fail();
+                ++this->_pos;
+                return negate ? ~set : set;
+            }
+
+            /// <summary>
+            /// 「{」に続く回数指定の数値
+            /// </summary>
+            std::size_t number() {
+                const auto begin = this->_source.data() + this->_pos;
+                std::size_t n = 0;
+                const auto [ptr, ec] = std::from_chars(begin, this->_source.data() + this->_source.size(), n);
+                if (ec != std::errc() || n > MAX_REPEAT) this->fail();
+                this->_pos += static_cast<std::size_t>(ptr - begin);
+                return n;
+            }
+
+            std::size_t atom() {
+                const char c = this->_source[this->_pos++];
+                Node node{ Node::KIND::SET, {}, {}, 0, 0 };
+                switch (c) {
+                case '(': {
+                    const auto inner = this->alternation();
+                    if (!this->peek(')')) this->fail();
+                    ++this->_pos;
+                    return inner;
+                }
+                case '[': node.set = this->bracket(); break;
+                case '.':
+                    node.set.set();
+                    node.set.reset('\n');
+                    node.set.reset('\r');
+                    break;
+                case '\\': node.set = this->escape(); break;
+                case '*': case '+': case '?': case '{': case ')': case ']': case '}':
+                    --this->_pos;
+                    this->fail();
+                default: node.set.set(static_cast<unsigned char>(c)); break;
+                }
+                return this->add(std::move(node));
+            }
+
+            std::size_t repetition() {
+                auto child = this->atom();
+                while (this->_pos < this->_source.size()) {
+                    Node node{ Node::KIND::REPEAT, {}, {}, 0, 0 };
+                    const char c = this->_source[this->_pos];
+                    if (c == '*') { node.min = 0; node.max = INFINITE; }
+                    else if (c == '+') { node.min = 1; node.max = INFINITE; }
+                    else if (c == '?') { node.min = 0; node.max = 1; }
+                    else if (c == '{') {
+                        ++this->_pos;
+                        node.min = node.max = this->number();
+                        if (this->peek(',')) {
+                            ++this->_pos;
+                            node.max = this->peek('}') ? INFINITE : this->number();
+                            if (node.max < node.min) this->fail();
+                        }
+                        if (!this->peek('}')) this->fail();
+                    }
+                    else break;
+                    ++this->_pos;
+                    node.children.push_back(child);
+                    child = this->add(std::move(node));
+                }
+                return child;
+            }
+
+            std::size_t sequence() {
+                Node node{ Node::KIND::CONCAT, {}, {}, 0, 0 };
+                while (this->_pos < this->_source.size() && !this->peek('|') && !this->peek(')')) {
+                    node.children.push_back(this->repetition());
+                }
+                if (node.children.empty()) return this->add(Node{ Node::KIND::EMPTY, {}, {}, 0, 0 });
+                return node.children.size() == 1 ? node.children[0] : this->add(std::move(node));
+            }
+
+        public:
+            Parser(std::string_view source, std::vector<Node>& nodes) : _source(source), _nodes(nodes) {}
+
+            std::size_t alternation() {
+                Node node{ Node::KIND::ALT, {}, {}, 0, 0 };
+                node.children.push_back(this->sequence());
+                while (this->peek('|')) {
+                    ++this->_pos;
+                    node.children.push_back(this->sequence());
+                }
+                return node.children.size() == 1 ? node.children[0] : this->add(std::move(node));
+            }
+
+            std::size_t parse() {
+                const auto root = this->alternation();
+                if (this->_pos != this->_source.size()) this->fail();
+                return root;
+            }
+        };
+
+        /// <summary>
+        /// 上限なしの繰り返しを示す回数
+        /// </summary>
+        static constexpr std::size_t INFINITE = std::numeric_limits<std::size_t>::max();
+        /// <summary>
+        /// 「{m,n}」で指定可能な回数の上限
+        /// </summary>
+        static constexpr std::size_t MAX_REPEAT = 1000;
+        /// <summary>
+        /// NFAおよびDFAの状態数の上限
+        /// </summary>
+        static constexpr std::size_t MAX_STATES = 4096;
+
+        /// <summary>
+        /// パターンの文字列
+        /// </summary>
+        std::string _source;
+        /// <summary>
+        /// バイトから入力の同値類への対応
+        /// </summary>
+        std::array<std::uint8_t, 256> _classes{};
+        /// <summary>
+        /// 入力の同値類の数
+        /// </summary>
+        std::size_t _class_num = 0;
+        /// <summary>
+        /// 状態×同値類の遷移表(状態0は行き止まり、状態1は初期状態)
+        /// </summary>
+        std::vector<std::uint16_t> _table;
+        /// <summary>
+        /// 受理状態であるか
+        /// </summary>
+        std::vector<std::uint8_t> _accepting;
+
+        /// <summary>
+        /// 構文木のノードをNFAに変換する
+        /// </summary>
+        /// <returns>(開始状態, 終了状態)</returns>
+        std::pair<std::size_t, std::size_t> build(const std::vector<Node>& nodes, std::size_t i, std::vector<NfaState>& nfa) const {
+            auto state = [this, &nfa] {
+                if (nfa.size() >= MAX_STATES) throw std::invalid_argument(MessageFormat::format("パターン {0} は複雑すぎます", this->_source));
+                nfa.emplace_back();
+                return nfa.size() - 1;
+            };
+            const auto& node = nodes[i];
+            const auto start = state();
+            auto end = start;
+            switch (node.kind) {
+            case Node::KIND::EMPTY:
+                break;
+            case Node::KIND::SET:
+                end = state();
+                nfa[start].set = node.set;
+                nfa[start].next = end;
+                break;
+            case Node::KIND::CONCAT:
+                for (auto child : node.children) {
+                    const auto [s, e] = this->build(nodes, child, nfa);
+                    nfa[end].epsilon.push_back(s);
+                    end = e;
+                }
+                break;
+            case Node::KIND::ALT:
+                end = state();
+                for (auto child : node.children) {
+                    const auto [s, e] = this->build(nodes, child, nfa);
+                    nfa[start].epsilon.push_back(s);
+                    nfa[e].epsilon.push_back(end);
+                }
+                break;
+            case Node::KIND::REPEAT: {
+                for (std::size_t n = 0; n < node.min; ++n) {
+                    const auto [s, e] = this->build(nodes, node.children[0], nfa);
+                    nfa[end].epsilon.push_back(s);
+                    end = e;
+                }
+                if (node.max == INFINITE) {
+                    const auto loop = state();
+                    const auto [s, e] = this->build(nodes, node.children[0], nfa);
+                    nfa[end].epsilon.push_back(loop);
+                    nfa[loop].epsilon.push_back(s);
+                    nfa[e].epsilon.push_back(loop);
+                    end = loop;
+                }
+                else if (node.max > node.min) {
+                    const auto last = state();
+                    for (std::size_t n = node.min; n < node.max; ++n) {
+                        const auto [s, e] = this->build(nodes, node.children[0], nfa);
+                        nfa[end].epsilon.push_back(last);
+                        nfa[end].epsilon.push_back(s);
+                        end = e;
+                    }
+                    nfa[end].epsilon.push_back(last);
+                    end = last;
+                }
+                break;
+            }
+            }
+            return { start, end };
+        }
+
+        /// <summary>
+        /// 状態の集合をε遷移で閉じる(結果は整列済み)
+        /// </summary>
+        static void closure(const std::vector<NfaState>& nfa, std::vector<std::size_t>& states) {
+            std::vector<std::uint8_t> visited(nfa.size());
+            std::vector<std::size_t> stack(states);
+            states.clear();
+            while (!stack.empty()) {
+                const auto s = stack.back();
+                stack.pop_back();
+                if (visited[s]) continue;
+                visited[s] = 1;
+                states.push_back(s);
+                stack.insert(stack.end(), nfa[s].epsilon.begin(), nfa[s].epsilon.end());
+            }
+            std::sort(states.begin(), states.end());
+        }
+
+    public:
+        /// <summary>
+        /// パターンをDFAに変換して構築する
+        /// </summary>
+        /// <param name="source">パターン(不正なときはstd::invalid_argumentを投げる)</param>
+        explicit Pattern(std::string_view source) : _source(source) {
+            std::vector<Node> nodes;
+            const auto root = Parser(source, nodes).parse();
+            std::vector<NfaState> nfa;
+            const auto [start, accept] = this->build(nodes, root, nfa);
+
+            // 全ての文字集合で区別されないバイトを同じ同値類にまとめる
+            std::vector<std::string> signatures;
+            for (std::size_t c = 0; c < 256; ++c) {
+                std::string signature;
+                for (const auto& s : nfa) signature.push_back(s.set[c] ? '1' : '0');
+                auto itr = std::find(signatures.begin(), signatures.end(), signature);
+                this->_classes[c] = static_cast<std::uint8_t>(itr - signatures.begin());
+                if (itr == signatures.end()) signatures.push_back(std::move(signature));
+            }
+            this->_class_num = signatures.size();
+            std::array<std::size_t, 256> representative{};
+            for (std::size_t c = 256; c-- > 0;) representative[this->_classes[c]] = c;
+
+            // 部分集合構成法によりDFAを構築する
+            std::vector<std::vector<std::size_t>> dstates(2);
+            dstates[1].push_back(start);
+            closure(nfa, dstates[1]);
+            std::unordered_map<std::string, std::uint16_t> index;
+            auto key = [](const std::vector<std::size_t>& states) {
+                return std::string(reinterpret_cast<const char*>(states.data()), states.size() * sizeof(std::size_t));
+            };
+            index.emplace(key(dstates[0]), 0);
+            index.emplace(key(dstates[1]), 1);
+            this->_table.assign(2 * this->_class_num, 0);
+            for (std::size_t d = 1; d < dstates.size(); ++d) {
+                for (std::size_t k = 0; k < this->_class_num; ++k) {
+                    std::vector<std::size_t> next;
+                    for (auto s : dstates[d]) {
+                        if (nfa[s].set[representative[k]]) next.push_back(nfa[s].next);
+                    }
+                    closure(nfa, next);
+                    auto [itr, inserted] = index.emplace(key(next), static_cast<std::uint16_t>(dstates.size()));
+                    if (inserted) {
+                        if (dstates.size() >= MAX_STATES) throw std::invalid_argument(MessageFormat::format("パターン {0} は複雑すぎます", this->_source));
+                        dstates.push_back(std::move(next));
+                        this->_table.resize(dstates.size() * this->_class_num, 0);
+                    }
+                    this->_table[d * this->_class_num + k] = itr->second;
+                }
+            }
+            this->_accepting.resize(dstates.size());
+            for (std::size_t d = 0; d < dstates.size(); ++d) {
+                this->_accepting[d] = std::binary_search(dstates[d].begin(), dstates[d].end(), accept);
+            }
+        }
+
+        /// <summary>
+        /// 文字列全体がパターンに一致するかの判定
+        /// </summary>
+        /// <param name="str">判定対象の文字列</param>
+        /// <returns>一致するときにtrue</returns>
+        bool match(std::string_view str) const noexcept override {
+            std::size_t state = 1;
+            for (const char c : str) {
+                state = this->_table[state * this->_class_num + this->_classes[static_cast<unsigned char>(c)]];
+                if (state == 0) return false;
+            }
+            return this->_accepting[state] != 0;
+        }
+
+        /// <summary>
+        /// パターンの文字列の取得
+        /// </summary>
+        /// <returns></returns>
+        std::string_view source() const noexcept override { return this->_source; }
+
+        /// <summary>
+        /// DFAの状態数の取得(行き止まりの状態を含む)
+        /// </summary>
+        /// <returns></returns>
+        std::size_t state_num() const noexcept { return this->_accepting.size(); }
+    };
+}
@@ -0,0 +1,496 @@
+﻿#pragma once
+
+#include "CommandLineOption.hpp"
+#include "CommandLineOptionJson.hpp"
+
+#ifndef _WIN32
+#include <thread>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <unordered_set>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+COMMAND_LINE_OPTION_EXPORT namespace option {
+
+    /// <summary>
+    /// 解析サーバとクライアントの間のプロトコル
+    /// </summary>
+    /// <remarks>
+    /// 整数はすべてリトルエンディアンとする。
+    /// 要求: [u32 後続のバイト数][u8 操作][u32 引数の数]{[u32 引数のバイト数][引数]}*
+    /// 応答: [u32 後続のバイト数][u8 状態][内容]
+    /// 1つの接続で複数の要求を順に送ることができる
+    /// </remarks>
+    struct ParseProtocol {
+        /// <summary>
+        /// 要求する操作
+        /// </summary>
+        struct OP {
+            /// <summary>
+            /// 解析と検証を行い解析結果のJSONを返す
+            /// </summary>
+            static constexpr std::uint8_t PARSE = 0;
+            /// <summary>
+            /// 解析と検証のみを行い内容は空とする
+            /// </summary>
+            static constexpr std::uint8_t VALIDATE = 1;
+        };
+        /// <summary>
+        /// 応答の状態
+        /// </summary>
+        struct STATUS {
+            /// <summary>
+            /// 成功
+            /// </summary>
+            static constexpr std::uint8_t OK = 0;
+            /// <summary>
+            /// 解析もしくは検証のエラー(内容はエラーメッセージ)
+            /// </summary>
+            static constexpr std::uint8_t ERROR = 1;
+            /// <summary>
+            /// 不正な要求(内容はエラーメッセージ)
+            /// </summary>
+            static constexpr std::uint8_t BAD_REQUEST = 2;
+        };
+
+        /// <summary>
+        /// 整数をリトルエンディアンで追加する
+        /// </summary>
+        /// <param name="buf">追加先</param>
+        /// <param name="x">追加する整数</param>
+        static void put_u32(std::string& buf, std::uint32_t x) {
+            const char bytes[] = { char(x & 0xFF), char((x >> 8) & 0xFF), char((x >> 16) & 0xFF), char((x >> 24) & 0xFF) };
+            buf.append(bytes, 4);
+        }
+
+        /// <summary>
+        /// リトルエンディアンの整数を読み込む
+        /// </summary>
+        /// <param name="p">読み込み位置</param>
+        /// <returns></returns>
+        static std::uint32_t get_u32(const char* p) noexcept {
+            const auto b = reinterpret_cast<const unsigned char*>(p);
+            return std::uint32_t(b[0]) | (std::uint32_t(b[1]) << 8) | (std::uint32_t(b[2]) << 16) | (std::uint32_t(b[3]) << 24);
+        }
+
+        /// <summary>
+        /// 全バイトを送信する
+        /// </summary>
+        /// <param name="fd">送信先のソケット</param>
+        /// <param name="data">送信するデータ</param>
+        /// <returns>送信できたときにtrue</returns>
+        static bool send_all(int fd, std::string_view data) {
+#ifdef MSG_NOSIGNAL
+            constexpr int flags = MSG_NOSIGNAL;
+#else
+            constexpr int flags = 0;
+#endif
+            while (!data.empty()) {
+                const auto n = ::send(fd, data.data(), data.size(), flags);
+                if (n < 0 && errno == EINTR) continue;
+                if (n <= 0) return false;
+                data.remove_prefix(static_cast<std::size_t>(n));
+            }
+            return true;
+        }
+
+        /// <summary>
+        /// 指定したバイト数を受信する
+        /// </summary>
+        /// <param name="fd">受信元のソケット</param>
+        /// <param name="p">格納先</param>
+        /// <param name="size">受信するバイト数</param>
+        /// <returns>受信できたときにtrue(相手が切断したときや受信が時間切れになったときはfalse)</returns>
+        static bool recv_all(int fd, char* p, std::size_t size) {
+            while (size != 0) {
+                const auto n = ::recv(fd, p, size, 0);
+                if (n < 0 && errno == EINTR) continue;
+                if (n <= 0) return false;
+                p += n;
+                size -= static_cast<std::size_t>(n);
+            }
+            return true;
+        }
+
+        /// <summary>
+        /// 長さの前置されたフレームを1つ受信する
+        /// </summary>
+        /// <param name="fd">受信元のソケット</param>
+        /// <param name="frame">受信したフレーム(長さを除く)</param>
+        /// <param name="max_size">フレームの大きさの上限</param>
+        /// <returns>受信できたときにtrue</returns>
+        static bool recv_frame(int fd, std::string& frame, std::size_t max_size) {
+            char header[4];
+            if (!recv_all(fd, header, 4)) return false;
+            const std::size_t size = get_u32(header);
+            if (size > max_size) return false;
+            frame.resize(size);
+            return recv_all(fd, frame.data(), size);
+        }
+
+        /// <summary>
+        /// Unixドメインソケットのアドレスを構築する
+        /// </summary>
+        /// <param name="path">ソケットのパス</param>
+        /// <returns></returns>
+        static sockaddr_un address(const std::string& path) {
+            sockaddr_un addr{};
+            addr.sun_family = AF_UNIX;
+            if (path.size() >= sizeof(addr.sun_path)) {
+                throw std::invalid_argument(MessageFormat::format("ソケットのパス {0} が長すぎます", path));
+            }
+            std::copy(path.begin(), path.end(), addr.sun_path);
+            return addr;
+        }
+    };
+
+    /// <summary>
+    /// 構築済みのoptionの定義を常駐させ、Unixドメインソケットで解析要求に応答するサーバ
+    /// </summary>
+    /// <remarks>
+    /// 受け付けた接続はワーカーのプールへ渡され、各ワーカーは自身の複製したOptionMapで要求を解析するため、
+    /// 複数のクライアントを同時に処理できる。optionの定義の構築は起動時の1回のみである。
+    /// ワーカーは1度に1つの接続を担当するため、idle_timeoutの間に要求を送らない接続は切断してワーカーを次の接続へ渡す
+    /// </remarks>
+    class ParseServer {
+        std::string _path;
+        OptionMap _map;
+        std::size_t _worker_num;
+        int _listen_fd = -1;
+        std::vector<std::thread> _workers;
+        std::mutex _mutex;
+        std::condition_variable _cv;
+        /// <summary>
+        /// ワーカーへ渡す前の接続
+        /// </summary>
+        std::deque<int> _pending;
+        /// <summary>
+        /// ワーカーが処理している接続
+        /// </summary>
+        std::unordered_set<int> _active;
+        bool _stopping = false;
+
+        /// <summary>
+        /// 要求を解析して応答を構築する
+        /// </summary>
+        /// <param name="map">ワーカーのOptionMap</param>
+        /// <param name="initial">ワーカーのOptionMapの解析前の状態</param>
+        /// <param name="frame">要求(長さを除く)</param>
+        /// <param name="args">引数を格納する領域</param>
+        /// <param name="argv">引数を示す配列の領域</param>
+        /// <param name="response">応答の格納先</param>
+        static void handle(OptionMap& map, const std::vector<OptionMark>& initial, const std::string& frame, std::string& args, std::vector<const char*>& argv, std::string& response) {
+            auto reply = [&response](std::uint8_t status, std::string_view payload) {
+                response.clear();
+                ParseProtocol::put_u32(response, static_cast<std::uint32_t>(payload.size() + 1));
+                response += char(status);
+                response += payload;
+            };
+            if (frame.size() < 5) {
+                reply(ParseProtocol::STATUS::BAD_REQUEST, "要求が短すぎます");
+                return;
+            }
+            const std::uint8_t op = static_cast<std::uint8_t>(frame[0]);
+            const std::size_t argc = ParseProtocol::get_u32(frame.data() + 1);
+            // 引数はnull終端して連結する(連結後の大きさは要求を超えないため再確保は起こらない)
+            args.clear();
+            args.reserve(frame.size());
+            argv.clear();
+            std::size_t pos = 5;
+            for (std::size_t i = 0; i < argc; ++i) {
+                if (frame.size() - pos < 4 || frame.size() - pos - 4 < ParseProtocol::get_u32(frame.data() + pos)) {
+                    reply(ParseProtocol::STATUS::BAD_REQUEST, "引数が要求の範囲外です");
+                    return;
+                }
+                const std::size_t len = ParseProtocol::get_u32(frame.data() + pos);
+                argv.push_back(args.data() + args.size());
+                args.append(frame.data() + pos + 4, len).push_back('\0');
+                pos += 4 + len;
+            }
+            if (op != ParseProtocol::OP::PARSE && op != ParseProtocol::OP::VALIDATE) {
+                reply(ParseProtocol::STATUS::BAD_REQUEST, "未知の操作です");
+                return;
+            }
+
+            try {
+                map.rewind(initial);
+                map.parse(static_cast<int>(argv.size()), argv.data());
+                reply(ParseProtocol::STATUS::OK, op == ParseProtocol::OP::PARSE ? map.to_json() : std::string());
+            }
+            catch (const std::exception& e) {
+                reply(ParseProtocol::STATUS::ERROR, e.what());
+            }
+        }
+
+        /// <summary>
+        /// 接続を受け取って要求に応答し続けるワーカー
+        /// </summary>
+        void work() {
+            OptionMap map = this->_map.clone();
+            const auto initial = map.mark();
+            std::string frame, args, response;
+            std::vector<const char*> argv;
+            while (true) {
+                int fd;
+                {
+                    std::unique_lock<std::mutex> lock(this->_mutex);
+                    this->_cv.wait(lock, [this] { return this->_stopping || !this->_pending.empty(); });
+                    if (this->_stopping) return;
+                    fd = this->_pending.front();
+                    this->_pending.pop_front();
+                    this->_active.insert(fd);
+                }
+                while (ParseProtocol::recv_frame(fd, frame, this->max_request)) {
+                    handle(map, initial, frame, args, argv, response);
+                    if (!ParseProtocol::send_all(fd, response)) break;
+                }
+                {
+                    std::lock_guard<std::mutex> lock(this->_mutex);
+                    this->_active.erase(fd);
+                }
+                ::close(fd);
+            }
+        }
+
+    public:
+        /// <summary>
+        /// サーバの構築(ソケットはrunで作成する)
+        /// </summary>
+        /// <param name="map">構築済みのoptionの定義(複製して保持する)</param>
+        /// <param name="path">Unixドメインソケットのパス</param>
+        /// <param name="workers">ワーカーの数(0のときはハードウェアのスレッド数)</param>
+        ParseServer(const OptionMap& map, std::string path, std::size_t workers = 0)
+            : _path(std::move(path)), _map(map.clone()), _worker_num(workers != 0 ? workers : std::max(1u, std::thread::hardware_concurrency())) {}
+        ParseServer(const ParseServer&) = delete;
+        ParseServer& operator=(const ParseServer&) = delete;
+        ~ParseServer() {
+            this->stop();
+        }
+
+        /// <summary>
+        /// 要求の大きさの上限(超えた接続は切断する)
+        /// </summary>
+        std::size_t max_request = std::size_t(1) << 20;
+
+        /// <summary>
+        /// 要求の受信と応答の送信を待つ時間の上限(超えた接続は切断する、0のときは無制限)
+        /// </summary>
+        std::chrono::milliseconds idle_timeout = std::chrono::seconds(5);
+
+        /// <summary>
+        /// ソケットファイルのアクセス権(既定では所有者のみ接続できる)
+        /// </summary>
+        unsigned int socket_mode = 0600;
+
+        /// <summary>
+        /// ソケットを作成してstopが呼ばれるまで接続を受け付ける
+        /// </summary>
+        /// <remarks>
+        /// パスに既存のソケットファイルがあるときは削除して作り直し、ソケット以外のファイルがあるときは例外を投げる。
+        /// アクセス権はlistenの前に設定するため、socket_modeで許可されないユーザーが接続できる期間はない
+        /// </remarks>
+        void run() {
+            const auto addr = ParseProtocol::address(this->_path);
+            struct stat st{};
+            if (::lstat(this->_path.c_str(), &st) == 0) {
+                if (!S_ISSOCK(st.st_mode)) {
+                    throw std::runtime_error(MessageFormat::format("{0} はソケットではないため削除できません", this->_path));
+                }
+                ::unlink(this->_path.c_str());
+            }
+            const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+            if (fd < 0) {
+                throw std::runtime_error(MessageFormat::format("ソケットを作成できませんでした (errno={0})", errno));
+            }
+            if (::bind(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0 ||
+                ::chmod(this->_path.c_str(), static_cast<mode_t>(this->socket_mode)) != 0 || ::listen(fd, SOMAXCONN) != 0) {
+                const int error = errno;
+                ::close(fd);
+                throw std::runtime_error(MessageFormat::format("ソケット {0} で待ち受けできませんでした (errno={1})", this->_path, error));
+            }
+            {
+                std::lock_guard<std::mutex> lock(this->_mutex);
+                if (this->_stopping) {
+                    ::close(fd);
+                    return;
+                }
+                this->_listen_fd = fd;
+            }
+            for (std::size_t i = 0; i < this->_worker_num; ++i) {
+                this->_workers.emplace_back([this] { this->work(); });
+            }
+            while (true) {
+                const int client = ::accept(fd, nullptr, nullptr);
+                if (client < 0) {
+                    if (errno == EINTR || errno == ECONNABORTED) continue;
+                    break;
+                }
+                if (this->idle_timeout.count() > 0) {
+                    timeval tv{};
+                    tv.tv_sec = static_cast<decltype(tv.tv_sec)>(this->idle_timeout.count() / 1000);
+                    tv.tv_usec = static_cast<decltype(tv.tv_usec)>(this->idle_timeout.count() % 1000 * 1000);
+                    ::setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+                    ::setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+                }
+                std::lock_guard<std::mutex> lock(this->_mutex);
+                if (this->_stopping) {
+                    ::close(client);
+                    break;
+                }
+                this->_pending.push_back(client);
+                this->_cv.notify_one();
+            }
+
+            this->stop();
+            for (auto& t : this->_workers) t.join();
+            this->_workers.clear();
+            std::lock_guard<std::mutex> lock(this->_mutex);
+            ::close(this->_listen_fd);
+            this->_listen_fd = -1;
+            ::unlink(this->_path.c_str());
+        }
+
+        /// <summary>
+        /// 接続の受け付けとワーカーの停止を要求する(他のスレッドやシグナル処理の後に呼び出せる)
+        /// </summary>
+        /// <remarks>
+        /// runは処理中の接続を切断して全てのワーカーを停止した後に制御を返す
+        /// </remarks>
+        void stop() {
+            {
+                std::lock_guard<std::mutex> lock(this->_mutex);
+                this->_stopping = true;
+                if (this->_listen_fd >= 0) {
+                    // acceptを中断させる
+                    ::shutdown(this->_listen_fd, SHUT_RDWR);
+                }
+                for (int fd : this->_active) ::shutdown(fd, SHUT_RDWR);
+                for (int fd : this->_pending) ::close(fd);
+                this->_pending.clear();
+            }
+            this->_cv.notify_all();
+        }
+    };
+
+    /// <summary>
+    /// ParseServerへ解析を要求するクライアント
+    /// </summary>
+    /// <remarks>
+    /// サーバがidle_timeoutにより切断した接続で要求したときは1度だけ接続し直して要求を送り直す。
+    /// 送り直すのは送信に失敗したときと、応答を1バイトも受信しないうちに切断されたときのみである
+    /// (受信の時間切れなどではサーバが解析を終えている場合があり、使用回数の計測を有効にしたサーバでは送り直すと二重に数えられる)
+    /// </remarks>
+    class ParseClient {
+        std::string _path;
+        int _fd = -1;
+        std::string _request;
+        std::string _buffer;
+
+        /// <summary>
+        /// サーバへ接続する
+        /// </summary>
+        void connect() {
+            const auto addr = ParseProtocol::address(this->_path);
+            this->_fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+            if (this->_fd < 0 || ::connect(this->_fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0) {
+                const int error = errno;
+                if (this->_fd >= 0) ::close(this->_fd);
+                this->_fd = -1;
+                throw std::runtime_error(MessageFormat::format("ソケット {0} に接続できませんでした (errno={1})", this->_path, error));
+            }
+        }
+
+        /// <summary>
+        /// 要求の送受信の結果
+        /// </summary>
+        struct EXCHANGE {
+            /// <summary>
+            /// 応答を受信した
+            /// </summary>
+            static constexpr int OK = 0;
+            /// <summary>
+            /// サーバは要求を処理していない(送信に失敗したか、応答の前に切断された)ため送り直してよい
+            /// </summary>
+            static constexpr int RETRY = 1;
+            /// <summary>
+            /// サーバが要求を処理したかどうか分からないため送り直してはならない
+            /// </summary>
+            static constexpr int FAILED = 2;
+        };
+
+        /// <summary>
+        /// 構築済みの要求を送信して応答を受信する
+        /// </summary>
+        /// <returns>送受信の結果(EXCHANGE)</returns>
+        int exchange() {
+            if (!ParseProtocol::send_all(this->_fd, this->_request)) return EXCHANGE::RETRY;
+            // 応答の最初の1バイトで、要求を読まずに切断されたのか、応答の途中で失敗したのかを区別する
+            char header[4];
+            ssize_t n;
+            do {
+                n = ::recv(this->_fd, header, 1, 0);
+            } while (n < 0 && errno == EINTR);
+            if (n == 0 || (n < 0 && errno == ECONNRESET)) return EXCHANGE::RETRY;
+            if (n < 0 || !ParseProtocol::recv_all(this->_fd, header + 1, 3)) return EXCHANGE::FAILED;
+            this->_buffer.resize(ParseProtocol::get_u32(header));
+            if (this->_buffer.empty() || !ParseProtocol::recv_all(this->_fd, this->_buffer.data(), this->_buffer.size())) return EXCHANGE::FAILED;
+            return EXCHANGE::OK;
+        }
+
+    public:
+        /// <summary>
+        /// サーバへの接続
+        /// </summary>
+        /// <param name="path">Unixドメインソケットのパス</param>
+        explicit ParseClient(const std::string& path) : _path(path) {
+            this->connect();
+        }
+        ParseClient(const ParseClient&) = delete;
+        ParseClient& operator=(const ParseClient&) = delete;
+        ~ParseClient() {
+            if (this->_fd >= 0) ::close(this->_fd);
+        }
+
+        /// <summary>
+        /// 解析を要求する
+        /// </summary>
+        /// <param name="op">操作(ParseProtocol::OP)</param>
+        /// <param name="argc">コマンドライン引数の数</param>
+        /// <param name="argv">コマンドライン引数を示す配列</param>
+        /// <param name="payload">応答の内容の格納先</param>
+        /// <returns>応答の状態(ParseProtocol::STATUS)</returns>
+        std::uint8_t request(std::uint8_t op, int argc, const char* const argv[], std::string& payload) {
+            this->_request.assign(4, '\0');
+            this->_request += char(op);
+            ParseProtocol::put_u32(this->_request, static_cast<std::uint32_t>(argc));
+            for (int i = 0; i < argc; ++i) {
+                const std::string_view arg = argv[i];
+                ParseProtocol::put_u32(this->_request, static_cast<std::uint32_t>(arg.size()));
+                this->_request += arg;
+            }
+            std::string size;
+            ParseProtocol::put_u32(size, static_cast<std::uint32_t>(this->_request.size() - 4));
+            this->_request.replace(0, 4, size);
+
+            auto result = this->exchange();
+            if (result == EXCHANGE::RETRY) {
+                // サーバが待機中の接続を切断したときは接続し直す(サーバは要求を読んでいないため送り直してよい)
+                ::close(this->_fd);
+                this->_fd = -1;
+                this->connect();
+                result = this->exchange();
+            }
+            if (result != EXCHANGE::OK) {
+                throw std::runtime_error("サーバとの通信に失敗しました");
+            }
+            payload.assign(this->_buffer, 1);
+            return static_cast<std::uint8_t>(this->_buffer[0]);
+        }
+    };
+}
+#endif
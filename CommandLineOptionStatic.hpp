@@ -0,0 +1,490 @@
+﻿#pragma once
+
+#include "CommandLineOption.hpp"
+
+COMMAND_LINE_OPTION_EXPORT namespace option {
+
+    /// <summary>
+    /// コンパイル時に定義するoptionの仕様
+    /// </summary>
+    /// <remarks>
+    /// 配列における順序はAddOptionsによる登録の順序に相当し、同じ名前をもつoptionと別名は配列の前方にあるものから解析を試みる
+    /// </remarks>
+    struct StaticOption {
+        /// <summary>
+        /// optionの種類(SchemaTable::KINDに別名を加えたもの)
+        /// </summary>
+        struct KIND : SchemaTable::KIND {
+            // 別名(targetの示すoptionと同じ規則で解析される)
+            static constexpr std::uint8_t ALIAS = 5;
+        };
+
+        /// <summary>
+        /// 上限のない件数
+        /// </summary>
+        static constexpr std::size_t UNLIMITED = std::numeric_limits<std::size_t>::max();
+
+        /// <summary>
+        /// 接頭辞付きのoption名もしくは別名(「-o」もしくは「--help」の形式、名前なしオプションは空)
+        /// </summary>
+        std::string_view name;
+        /// <summary>
+        /// optionの種類
+        /// </summary>
+        std::uint8_t kind = KIND::FLAG;
+        /// <summary>
+        /// 引数付きのlong optionの引数の記載パターン(OptionHasValueBase::ARG_PATTERNの論理和)
+        /// </summary>
+        std::size_t arg_pattern = OptionHasValueBase::ARG_PATTERN::ASSIGN | OptionHasValueBase::ARG_PATTERN::SPACE;
+        /// <summary>
+        /// 引数の数の上限(引数付きのoptionと名前なしオプション)
+        /// </summary>
+        std::size_t limit = 1;
+        /// <summary>
+        /// 上限まで引数を受け取った後に後続の解析を中断するときにtrue(名前なしオプション)
+        /// </summary>
+        bool pause = false;
+        /// <summary>
+        /// 別名の対象のoptionのインデックス(別名より前方にあること)
+        /// </summary>
+        std::size_t target = 0;
+    };
+
+    /// <summary>
+    /// StaticSchemaのoptionの数に依存しない処理
+    /// </summary>
+    /// <remarks>
+    /// 完全ハッシュの構築は定数式でも実行時でも行えるため、tools/schema_compiler.cppは実行時に構築した表をヘッダとして出力する
+    /// </remarks>
+    class StaticSchemaBase {
+    public:
+        using KIND = StaticOption::KIND;
+
+        /// <summary>
+        /// 該当するoptionが存在しないことを示すインデックス
+        /// </summary>
+        static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+        /// <summary>
+        /// バケットごとの種の探索回数の上限
+        /// </summary>
+        static constexpr std::uint32_t max_seed = 1 << 16;
+
+        /// <summary>
+        /// バケットの数(1バケットあたり平均2つの名前)
+        /// </summary>
+        /// <param name="n">optionの数</param>
+        /// <returns></returns>
+        static constexpr std::size_t bucket_count(std::size_t n) noexcept { return (n + 1) / 2; }
+
+        /// <summary>
+        /// ハッシュ表の大きさ(2のべき乗)
+        /// </summary>
+        /// <param name="n">optionの数</param>
+        /// <returns></returns>
+        static constexpr std::size_t table_size(std::size_t n) noexcept { return std::bit_ceil(2 * n); }
+
+        /// <summary>
+        /// 種付きのFNV-1aハッシュ(接頭辞と残りを連結した文字列に対する値)
+        /// </summary>
+        /// <param name="prefix">接頭辞</param>
+        /// <param name="rest">残りの文字列</param>
+        /// <param name="seed">種</param>
+        /// <returns></returns>
+        static constexpr std::uint64_t hash(std::string_view prefix, std::string_view rest, std::uint64_t seed) noexcept {
+            std::uint64_t h = 14695981039346656037ull ^ (seed * 0x9E3779B97F4A7C15ull);
+            for (char c : prefix) {
+                h ^= static_cast<unsigned char>(c);
+                h *= 1099511628211ull;
+            }
+            for (char c : rest) {
+                h ^= static_cast<unsigned char>(c);
+                h *= 1099511628211ull;
+            }
+            return h ^ (h >> 29);
+        }
+
+        /// <summary>
+        /// optionの仕様の検証(AddOptionsで登録したときに例外となる仕様は例外を投げる)
+        /// </summary>
+        /// <param name="options">optionの仕様の配列</param>
+        static constexpr void check(std::span<const StaticOption> options) {
+            bool terminated = false;
+            for (std::size_t i = 0; i < options.size(); ++i) {
+                const auto& o = options[i];
+                if (o.kind > KIND::ALIAS) throw std::invalid_argument("optionの種類が不正です");
+                if (o.kind == KIND::UNNAMED) {
+                    if (!o.name.empty()) throw std::invalid_argument("名前なしオプションに名前を指定することはできません");
+                    if (terminated) throw std::invalid_argument("引数の数に上限のないもしくは中断する名前なしオプションの後に名前なしオプションは定義できません");
+                    terminated = o.pause || o.limit == StaticOption::UNLIMITED;
+                }
+                else if (o.name.starts_with("--")) OptionName::check(o.name.substr(2));
+                else if (o.name.starts_with("-")) OptionName::check(o.name.substr(1));
+                else throw std::invalid_argument("optionは「-」から始まる必要があります");
+                if ((o.kind == KIND::VALUE || o.kind == KIND::UNNAMED) && o.limit == 0) throw std::invalid_argument("保持する引数の数は0に設定することはできません");
+                if (o.kind == KIND::NEGATABLE && !o.name.starts_with("--")) throw std::invalid_argument("否定可能なoptionはlong optionである必要があります");
+                if (o.kind == KIND::ALIAS) {
+                    if (o.target >= i || options[o.target].kind == KIND::ALIAS || options[o.target].kind == KIND::UNNAMED) {
+                        throw std::invalid_argument("別名の対象は別名より前方にあるoptionである必要があります");
+                    }
+                    for (std::size_t j = 0; j < i; ++j) {
+                        if (options[j].name == o.name) throw std::invalid_argument("別名が既に定義されている名前と重複しています");
+                    }
+                }
+            }
+        }
+
+        /// <summary>
+        /// option名の完全ハッシュ(hash and displace)の構築
+        /// </summary>
+        /// <param name="options">optionの仕様の配列</param>
+        /// <param name="seeds">バケットごとのハッシュの種の格納先(bucket_count(options.size())個)</param>
+        /// <param name="slots">ハッシュ表の格納先(table_size(options.size())個、同じ名前をもつ先頭の定義のインデックス+1、空きは0)</param>
+        static constexpr void build(std::span<const StaticOption> options, std::span<std::uint32_t> seeds, std::span<std::uint32_t> slots) {
+            check(options);
+            if (seeds.size() != bucket_count(options.size()) || slots.size() != table_size(options.size())) {
+                throw std::invalid_argument("ハッシュ表の大きさがoptionの数と一致しません");
+            }
+            // 同じ名前の定義は配列の前方にあるものを代表とする
+            std::vector<std::size_t> heads;
+            for (std::size_t i = 0; i < options.size(); ++i) {
+                if (options[i].kind == KIND::UNNAMED) continue;
+                if (std::none_of(heads.begin(), heads.end(), [&](std::size_t h) { return options[h].name == options[i].name; })) heads.push_back(i);
+            }
+            std::vector<std::size_t> bucket_of(heads.size()), bucket_size(seeds.size()), order(seeds.size());
+            for (std::size_t k = 0; k < heads.size(); ++k) {
+                bucket_of[k] = hash("", options[heads[k]].name, 0) % seeds.size();
+                ++bucket_size[bucket_of[k]];
+            }
+
+            // 要素の多いバケットから順に全要素が空きスロットに収まる種を探す
+            for (std::size_t b = 0; b < order.size(); ++b) order[b] = b;
+            std::sort(order.begin(), order.end(), [&](std::size_t x, std::size_t y) { return bucket_size[x] > bucket_size[y] || (bucket_size[x] == bucket_size[y] && x < y); });
+            std::fill(seeds.begin(), seeds.end(), 0);
+            std::fill(slots.begin(), slots.end(), 0);
+            std::vector<std::size_t> members, positions;
+            for (std::size_t b : order) {
+                members.clear();
+                for (std::size_t k = 0; k < heads.size(); ++k) {
+                    if (bucket_of[k] == b) members.push_back(heads[k]);
+                }
+                if (members.empty()) continue;
+                positions.resize(members.size());
+                std::uint32_t seed = 1;
+                for (; seed < max_seed; ++seed) {
+                    bool placed = true;
+                    for (std::size_t k = 0; k < members.size() && placed; ++k) {
+                        positions[k] = hash("", options[members[k]].name, seed) & (slots.size() - 1);
+                        placed = slots[positions[k]] == 0;
+                        for (std::size_t l = 0; l < k && placed; ++l) placed = positions[l] != positions[k];
+                    }
+                    if (placed) break;
+                }
+                if (seed == max_seed) throw std::logic_error("完全ハッシュを構築できませんでした");
+                seeds[b] = seed;
+                for (std::size_t k = 0; k < members.size(); ++k) slots[positions[k]] = static_cast<std::uint32_t>(members[k] + 1);
+            }
+        }
+    };
+
+    /// <summary>
+    /// コンパイル時に構築するoptionの定義表
+    /// </summary>
+    /// <typeparam name="N">optionの数(別名と名前なしオプションを含む)</typeparam>
+    /// <remarks>
+    /// option名の完全ハッシュをコンパイル時に構築し、実行時にはAddOptionsによる登録や動的確保を行わずに1回のハッシュ計算と1回の比較でoptionを検索する。
+    /// 不正な仕様はAddOptionsで登録したときに例外となるものと同じくコンパイルエラーとなる。
+    /// parseはOptionMap::parseと同じ規則でトークンを区切り、同じコマンドライン引数に対してOptionMap::parseが各optionに与える引数を同じ順に通知する。
+    /// 型変換、制約、デフォルト値、必須の検査および資源の上限は扱わないため、通知された引数に対して呼び出し側で行う
+    /// </remarks>
+    template <std::size_t N>
+    class StaticSchema : public StaticSchemaBase {
+        static_assert(N > 0, "optionを1つ以上定義する必要があります");
+
+    public:
+        /// <summary>
+        /// バケットの数
+        /// </summary>
+        static constexpr std::size_t bucket_num = bucket_count(N);
+        /// <summary>
+        /// ハッシュ表の大きさ
+        /// </summary>
+        static constexpr std::size_t slot_num = table_size(N);
+
+    private:
+        std::array<StaticOption, N> _options{};
+        /// <summary>
+        /// バケットごとのハッシュの種
+        /// </summary>
+        std::array<std::uint32_t, bucket_num> _seeds{};
+        /// <summary>
+        /// ハッシュ表(同じ名前をもつ先頭の定義のインデックス+1、空きは0)
+        /// </summary>
+        std::array<std::uint32_t, slot_num> _slots{};
+        /// <summary>
+        /// 同じ名前をもつ次の定義のインデックス+1(末尾は0)
+        /// </summary>
+        std::array<std::uint32_t, N> _next{};
+        /// <summary>
+        /// 名前なしオプションのインデックス(定義順)
+        /// </summary>
+        std::array<std::uint32_t, N> _unnamed{};
+        std::size_t _unnamed_num = 0;
+
+        /// <summary>
+        /// 接頭辞と残りを連結した名前をもつ先頭の定義の検索
+        /// </summary>
+        /// <param name="prefix">接頭辞</param>
+        /// <param name="rest">残りの文字列</param>
+        /// <returns>定義のインデックス(該当しないときはnpos)</returns>
+        constexpr std::size_t lookup(std::string_view prefix, std::string_view rest) const noexcept {
+            const auto seed = this->_seeds[hash(prefix, rest, 0) % bucket_num];
+            const auto slot = this->_slots[hash(prefix, rest, seed) & (slot_num - 1)];
+            if (slot == 0) return npos;
+            const auto name = this->_options[slot - 1].name;
+            return name.size() == prefix.size() + rest.size() && name.starts_with(prefix) && name.substr(prefix.size()) == rest ? slot - 1 : npos;
+        }
+
+        /// <summary>
+        /// ハッシュ表を検証し、同じ名前をもつ定義の連結と名前なしオプションの一覧を構築する
+        /// </summary>
+        constexpr void link() {
+            std::array<std::uint32_t, N> tails{};
+            for (std::size_t i = 0; i < N; ++i) {
+                if (this->_options[i].kind == KIND::UNNAMED) {
+                    this->_unnamed[this->_unnamed_num++] = static_cast<std::uint32_t>(i);
+                    continue;
+                }
+                const auto head = this->lookup("", this->_options[i].name);
+                if (head == npos || head > i) throw std::invalid_argument("完全ハッシュの表がoptionの定義と一致しません");
+                if (head != i) this->_next[tails[head]] = static_cast<std::uint32_t>(i + 1);
+                tails[head] = static_cast<std::uint32_t>(i);
+            }
+        }
+
+        /// <summary>
+        /// optionに続くトークンを引数として通知する(OptionValueBase::append_following_valuesと同じ規則)
+        /// </summary>
+        template <class F>
+        static void notify_following(std::size_t i, std::size_t& held, int& offset, int argc, const char* argv[], std::size_t limit, F& f) {
+            for (; held < limit && offset < argc; ++offset) {
+                const char* token = argv[offset];
+                if (Option::is_option(token) || LongOption::is_long_option(token)) {
+                    // 次のトークンがoptionかlong optionの時は中断
+                    break;
+                }
+                if (OptionBase::is_dash(token)) {
+                    // 先読みを行ってそれが「-」から始まるならそれをパラメータとして扱う
+                    if (++offset < argc && argv[offset][0] == '-') {
+                        token = argv[offset];
+                    }
+                    else {
+                        break;
+                    }
+                }
+                f(i, std::string_view(token));
+                ++held;
+            }
+        }
+
+        /// <summary>
+        /// 1つの定義としてトークンを解析する(OptionBase::parseの各実装と同じ規則)
+        /// </summary>
+        /// <param name="i">解析するoptionのインデックス(別名は解決済み)</param>
+        /// <param name="negated">「--no-」を除いた名前で検索したときにtrue</param>
+        /// <returns>解析を実行したときにtrue</returns>
+        template <class F>
+        bool parse_one(std::size_t i, bool negated, int& offset, int argc, const char* argv[], std::array<std::size_t, N>& held, F& f) const {
+            using ARG_PATTERN = OptionHasValueBase::ARG_PATTERN;
+            const auto& o = this->_options[i];
+            const std::string_view token = argv[offset];
+            const auto eq = token.find('=');
+            switch (o.kind) {
+            case KIND::FLAG:
+            case KIND::COUNT:
+                if (negated || eq != std::string_view::npos) return false;
+                f(i, std::string_view());
+                ++offset;
+                return true;
+            case KIND::NEGATABLE:
+                if (eq != std::string_view::npos) return false;
+                f(i, negated ? std::string_view("false") : std::string_view("true"));
+                ++offset;
+                return true;
+            default:
+                break;
+            }
+            if (negated) return false;
+            int offset2 = offset + 1;
+            if (!o.name.starts_with("--")) {
+                // optionの1回の指定につき引数は1つまで
+                if (eq != std::string_view::npos) return false;
+                const std::size_t before = held[i];
+                const std::size_t limit = std::min(before + 1, o.limit);
+                if (before == limit) {
+                    throw std::runtime_error(DescriptionCatalog::message("error.too_many_option_arguments", "option {0} でこれ以上の引数を指定することはできません", o.name));
+                }
+                notify_following(i, held[i], offset2, argc, argv, limit, f);
+                if (held[i] == before) {
+                    throw std::runtime_error(DescriptionCatalog::message("error.option_argument_required", "option {0} には引数を指定する必要があります", o.name));
+                }
+            }
+            else if (eq != std::string_view::npos) {
+                // 「=」による指定では1つのみ指定可能
+                if ((o.arg_pattern & ARG_PATTERN::ASSIGN) != ARG_PATTERN::ASSIGN) return false;
+                if (held[i] == o.limit) {
+                    throw std::runtime_error(DescriptionCatalog::message("error.too_many_option_arguments", "option {0} でこれ以上の引数を指定することはできません", o.name));
+                }
+                f(i, token.substr(eq + 1));
+                ++held[i];
+            }
+            else {
+                if ((o.arg_pattern & ARG_PATTERN::SPACE) != ARG_PATTERN::SPACE) return false;
+                if (held[i] == o.limit) {
+                    throw std::runtime_error(DescriptionCatalog::message("error.too_many_option_arguments", "option {0} でこれ以上の引数を指定することはできません", o.name));
+                }
+                notify_following(i, held[i], offset2, argc, argv, o.limit, f);
+                if (held[i] == 0) {
+                    throw std::runtime_error(DescriptionCatalog::message("error.option_argument_required", "option {0} には引数を指定する必要があります", o.name));
+                }
+            }
+            offset = offset2;
+            return true;
+        }
+
+        /// <summary>
+        /// 名前に該当する定義を前方から順に解析を試みる(OptionMap::parse_indexedと同じ規則)
+        /// </summary>
+        /// <returns>解析を実行したときにtrue</returns>
+        template <class F>
+        bool parse_named(std::string_view prefix, std::string_view key, bool negated, int& offset, int argc, const char* argv[], std::array<std::size_t, N>& held, F& f) const {
+            for (auto i = this->lookup(prefix, key); i != npos; i = static_cast<std::size_t>(this->_next[i]) - 1) {
+                const auto target = this->_options[i].kind == KIND::ALIAS ? this->_options[i].target : i;
+                if (this->parse_one(target, negated, offset, argc, argv, held, f)) return true;
+            }
+            return false;
+        }
+
+    public:
+        /// <summary>
+        /// optionの定義表の構築(完全ハッシュをコンパイル時に探索する)
+        /// </summary>
+        /// <param name="options">optionの仕様の配列</param>
+        consteval StaticSchema(const StaticOption (&options)[N]) {
+            std::copy(options, options + N, this->_options.begin());
+            build(this->_options, this->_seeds, this->_slots);
+            this->link();
+        }
+
+        /// <summary>
+        /// 構築済みの完全ハッシュの表を用いた定義表の構築(tools/schema_compiler.cppの出力で用いる)
+        /// </summary>
+        /// <param name="options">optionの仕様の配列</param>
+        /// <param name="seeds">StaticSchemaBase::buildで構築したバケットごとのハッシュの種</param>
+        /// <param name="slots">StaticSchemaBase::buildで構築したハッシュ表</param>
+        /// <remarks>
+        /// 種の探索を行わないためoptionの数が多くてもコンパイル時間はoptionの数に比例する。表がoptionの定義と一致しないときはコンパイルエラーとなる
+        /// </remarks>
+        consteval StaticSchema(const StaticOption (&options)[N], std::span<const std::uint32_t, bucket_num> seeds, std::span<const std::uint32_t, slot_num> slots) {
+            std::copy(options, options + N, this->_options.begin());
+            check(this->_options);
+            std::copy(seeds.begin(), seeds.end(), this->_seeds.begin());
+            std::copy(slots.begin(), slots.end(), this->_slots.begin());
+            this->link();
+        }
+
+        /// <summary>
+        /// 接頭辞付きのoption名もしくは別名からoptionのインデックスを検索する
+        /// </summary>
+        /// <param name="name">接頭辞付きのoption名もしくは別名</param>
+        /// <returns>optionのインデックス(別名は対象のoption、同じ名前のoptionが複数あるときは前方のもの、該当しないときはnpos)</returns>
+        constexpr std::size_t find(std::string_view name) const noexcept {
+            const auto i = this->lookup("", name);
+            return i != npos && this->_options[i].kind == KIND::ALIAS ? this->_options[i].target : i;
+        }
+
+        /// <summary>
+        /// optionの数
+        /// </summary>
+        /// <returns></returns>
+        static constexpr std::size_t size() noexcept { return N; }
+
+        /// <summary>
+        /// optionの仕様の取得
+        /// </summary>
+        /// <param name="i">optionのインデックス</param>
+        /// <returns></returns>
+        constexpr const StaticOption& operator[](std::size_t i) const noexcept { return this->_options[i]; }
+
+        /// <summary>
+        /// コマンドライン引数を解析し、optionのインデックスと引数の組を順に通知する
+        /// </summary>
+        /// <typeparam name="F">void(std::size_t, std::string_view)の形式の関数の型</typeparam>
+        /// <param name="argc">コマンドライン引数の数</param>
+        /// <param name="argv">コマンドライン引数を示す配列</param>
+        /// <param name="f">通知先</param>
+        /// <returns>解析後のオフセット</returns>
+        /// <remarks>
+        /// 別名は対象のoptionのインデックス、名前なしオプションの引数はその定義のインデックスで通知する。
+        /// 引数のないoptionの引数は空、否定可能なoptionの引数は「true」もしくは「--no-」による指定の「false」とする。
+        /// 解析のエラーはOptionMap::parseと同じ条件で同じ例外を投げる
+        /// </remarks>
+        template <class F>
+        int parse(int argc, const char* argv[], F&& f) const {
+            // 先読みでは任意の要素を参照するため事前にnullptrを含まないことを確認する
+            for (int i = 0; i < argc; ++i) {
+                if (argv[i] == nullptr) {
+                    throw std::invalid_argument(MessageFormat::format("{0} 番目のコマンドライン引数がnullptrです", i));
+                }
+            }
+            // optionごとの引数の数
+            std::array<std::size_t, N> held{};
+            int offset = 0;
+            // 引数を受け付ける名前なしオプションの位置(上限に達したものは再度参照しない)
+            std::size_t slot = 0;
+            while (offset < argc) {
+                const std::string_view token = argv[offset];
+                if (Option::is_option(argv[offset])) {
+                    if (!this->parse_named("-", token.substr(1), false, offset, argc, argv, held, f)) {
+                        throw std::runtime_error(DescriptionCatalog::message("error.unknown_option", "{0} に該当するoptionは存在しません", token));
+                    }
+                }
+                else if (LongOption::is_long_option(argv[offset])) {
+                    auto key = token.substr(2);
+                    key = key.substr(0, key.find('='));
+                    // --no-から始まるときは否定可能なoptionとしても検索する
+                    if (!this->parse_named("--", key, false, offset, argc, argv, held, f) &&
+                        !(key.starts_with("no-") && this->parse_named("--", key.substr(3), true, offset, argc, argv, held, f))) {
+                        throw std::runtime_error(DescriptionCatalog::message("error.unknown_long_option", "{0} に該当するlong optionは存在しません", token));
+                    }
+                }
+                else {
+                    if (OptionBase::is_dash(argv[offset])) {
+                        // 次の要素が存在するならばそれを名前なしのoptionとして扱う
+                        ++offset;
+                        if (offset >= argc) {
+                            continue;
+                        }
+                    }
+                    if (this->_unnamed_num == 0) {
+                        throw std::runtime_error(DescriptionCatalog::message("error.unnamed_option", "名前なしオプションの設定はできません"));
+                    }
+                    while (slot < this->_unnamed_num && held[this->_unnamed[slot]] >= this->_options[this->_unnamed[slot]].limit) {
+                        ++slot;
+                    }
+                    if (slot == this->_unnamed_num) {
+                        throw std::runtime_error(DescriptionCatalog::message("error.too_many_unnamed_options", "これ以上の名前なしオプション {0} は設定不可です", argv[offset]));
+                    }
+                    const std::size_t i = this->_unnamed[slot];
+                    f(i, std::string_view(argv[offset]));
+                    ++offset;
+                    if (++held[i] == this->_options[i].limit && this->_options[i].pause) {
+                        // 中断をする場合はその旨を設定する
+                        argc = offset;
+                    }
+                }
+            }
+            return offset;
+        }
+    };
+}
@@ -0,0 +1,144 @@
+﻿#pragma once
+
+#include "CommandLineOption.hpp"
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/uio.h>
+#endif
+
+COMMAND_LINE_OPTION_EXPORT namespace option {
+
+    /// <summary>
+    /// 端末の列数の取得
+    /// </summary>
+    class TerminalWidth {
+    public:
+        /// <summary>
+        /// 端末の列数を取得する
+        /// </summary>
+        /// <param name="fd">出力先のファイルディスクリプタ</param>
+        /// <returns>列数(不明なときは0)</returns>
+        static std::size_t of(int fd) {
+#ifndef _WIN32
+            winsize ws{};
+            if (::isatty(fd) && ::ioctl(fd, TIOCGWINSZ, &ws) == 0 && ws.ws_col != 0) return ws.ws_col;
+            const char* columns = std::getenv("COLUMNS");
+            return columns ? std::strtoul(columns, nullptr, 10) : 0;
+#else
+            (void)fd;
+            char* columns = nullptr;
+            std::size_t size = 0;
+            if (::_dupenv_s(&columns, &size, "COLUMNS") != 0 || columns == nullptr) return 0;
+            std::size_t result = std::strtoul(columns, nullptr, 10);
+            std::free(columns);
+            return result;
+#endif
+        }
+
+        /// <summary>
+        /// 端末の列数を取得する
+        /// </summary>
+        /// <param name="fp">出力先</param>
+        /// <returns>列数(不明なときは0)</returns>
+        static std::size_t of(std::FILE* fp) {
+#ifdef _WIN32
+            return of(::_fileno(fp));
+#else
+            return of(::fileno(fp));
+#endif
+        }
+    };
+
+    /// <summary>
+    /// ファイルディスクリプタへ出力するDescriptionSink
+    /// </summary>
+    /// <remarks>
+    /// 名前や説明の文字列は複製せずに参照として溜め込み、POSIX環境ではwritevにより一括して書き込む。
+    /// writeで渡された文字列は内部の領域に複製してから溜め込む
+    /// </remarks>
+    class FdDescriptionSink : public DescriptionSink {
+        /// <summary>
+        /// 1度に書き込む参照の最大数
+        /// </summary>
+        static constexpr std::size_t max_chunks = 64;
+        /// <summary>
+        /// 一時的な文字列の複製先の容量(この容量を超えて再確保しないため溜め込んだ参照は無効にならない)
+        /// </summary>
+        static constexpr std::size_t copy_capacity = 4096;
+
+        int _fd;
+        std::string_view _chunks[max_chunks];
+        std::size_t _chunk_num = 0;
+        std::string _copy;
+
+        /// <summary>
+        /// 溜め込んだ参照をすべて書き込む
+        /// </summary>
+        void drain() {
+#ifndef _WIN32
+            iovec iov[max_chunks];
+            std::size_t first = 0;
+            for (std::size_t i = 0; i < this->_chunk_num; ++i) {
+                iov[i].iov_base = const_cast<char*>(this->_chunks[i].data());
+                iov[i].iov_len = this->_chunks[i].size();
+            }
+            while (first < this->_chunk_num) {
+                auto written = ::writev(this->_fd, iov + first, static_cast<int>(this->_chunk_num - first));
+                if (written < 0) {
+                    if (errno == EINTR) continue;
+                    throw std::runtime_error(DescriptionCatalog::message("error.write_description", "説明の出力に失敗しました"));
+                }
+                // 部分的な書き込みのときは残りから再開する
+                auto rest = static_cast<std::size_t>(written);
+                for (; first < this->_chunk_num && rest >= iov[first].iov_len; ++first) rest -= iov[first].iov_len;
+                if (first < this->_chunk_num) {
+                    iov[first].iov_base = static_cast<char*>(iov[first].iov_base) + rest;
+                    iov[first].iov_len -= rest;
+                }
+            }
+#else
+            for (std::size_t i = 0; i < this->_chunk_num; ++i) {
+                for (auto str = this->_chunks[i]; !str.empty();) {
+                    auto written = ::_write(this->_fd, str.data(), static_cast<unsigned int>(std::min<std::size_t>(str.size(), std::numeric_limits<int>::max())));
+                    if (written < 0) throw std::runtime_error(DescriptionCatalog::message("error.write_description", "説明の出力に失敗しました"));
+                    str.remove_prefix(static_cast<std::size_t>(written));
+                }
+            }
+#endif
+            this->_chunk_num = 0;
+            this->_copy.clear();
+        }
+    public:
+        explicit FdDescriptionSink(int fd) : _fd(fd) { this->_copy.reserve(copy_capacity); }
+        ~FdDescriptionSink() {
+            try { this->drain(); }
+            catch (...) {}
+        }
+
+    protected:
+        void write_stable(std::string_view str) override {
+            if (str.empty()) return;
+            if (this->_chunk_num == max_chunks) this->drain();
+            this->_chunks[this->_chunk_num++] = str;
+        }
+
+    public:
+        void write(std::string_view str) override {
+            if (str.size() > copy_capacity) {
+                // 複製先に収まらないときはその場で書き込む
+                this->write_stable(str);
+                this->drain();
+                return;
+            }
+            if (this->_chunk_num == max_chunks || this->_copy.size() + str.size() > copy_capacity) this->drain();
+            auto offset = this->_copy.size();
+            this->_copy.append(str);
+            this->write_stable(std::string_view(this->_copy).substr(offset));
+        }
+        void flush() override { this->drain(); }
+    };
+}
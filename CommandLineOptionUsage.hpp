@@ -0,0 +1,258 @@
+﻿#pragma once
+
+#include "CommandLineOption.hpp"
+
+#include <atomic>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+COMMAND_LINE_OPTION_EXPORT namespace option {
+
+    /// <summary>
+    /// プロセス間で共有するoptionの使用回数
+    /// </summary>
+    /// <remarks>
+    /// 使用回数はoptionの定義から求めた指紋をキーとする共有メモリに保持され、同じ定義をもつ全プロセスで集計される。
+    /// 更新はoptionの一致ごとに1回のrelaxedなアトミック加算のみであり、ロックを取らない。
+    /// 共有メモリを利用できないとき(Windowsを含む)はプロセス内の領域で計測する
+    /// </remarks>
+    class UsageCounters : public UsageRecorder {
+        /// <summary>
+        /// 共有メモリの先頭に置く識別子
+        /// </summary>
+        static constexpr std::uint64_t magic = 0x31454741'53554F4Cull;
+        /// <summary>
+        /// 使用回数の前に置く見出しの要素数(識別子, 指紋, 使用回数の数)
+        /// </summary>
+        static constexpr std::size_t header_size = 3;
+
+    public:
+        /// <summary>
+        /// 共有メモリを作成するときの既定のアクセス権(所有者のみ読み書き可能)
+        /// </summary>
+        static constexpr unsigned int DEFAULT_MODE = 0600;
+
+    private:
+        std::uint64_t _fingerprint;
+        std::size_t _size;
+        std::string _name;
+        /// <summary>
+        /// 見出しと使用回数の領域
+        /// </summary>
+        std::uint64_t* _data = nullptr;
+        /// <summary>
+        /// 共有メモリにマップしているときにtrue
+        /// </summary>
+        bool _shared = false;
+        /// <summary>
+        /// 共有メモリを利用できないときの領域
+        /// </summary>
+        std::vector<std::uint64_t> _local;
+
+        /// <summary>
+        /// 共有メモリを開いてマップする(既存の領域の大きさや見出しが一致しないときは失敗とする)
+        /// </summary>
+        /// <param name="mode">共有メモリを作成するときのアクセス権</param>
+        /// <returns>マップできたときにtrue</returns>
+        bool map_shared([[maybe_unused]] unsigned int mode) {
+#ifndef _WIN32
+            const std::size_t bytes = (header_size + this->_size) * sizeof(std::uint64_t);
+            const int fd = ::shm_open(this->_name.c_str(), O_RDWR | O_CREAT, static_cast<mode_t>(mode));
+            if (fd < 0) return false;
+            struct stat st{};
+            bool sized = ::fstat(fd, &st) == 0 &&
+                (static_cast<std::size_t>(st.st_size) == bytes || (st.st_size == 0 && ::ftruncate(fd, static_cast<off_t>(bytes)) == 0));
+            void* p = sized ? ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+            ::close(fd);
+            if (p == MAP_FAILED) return false;
+
+            // 同時に作成したプロセスは同じ見出しを書き込むため識別子を最後に公開すればよい
+            auto data = static_cast<std::uint64_t*>(p);
+            std::atomic_ref<std::uint64_t> header(data[0]);
+            if (header.load(std::memory_order_acquire) != magic) {
+                std::atomic_ref<std::uint64_t>(data[1]).store(this->_fingerprint, std::memory_order_relaxed);
+                std::atomic_ref<std::uint64_t>(data[2]).store(this->_size, std::memory_order_relaxed);
+                header.store(magic, std::memory_order_release);
+            }
+            if (std::atomic_ref<std::uint64_t>(data[1]).load(std::memory_order_relaxed) != this->_fingerprint ||
+                std::atomic_ref<std::uint64_t>(data[2]).load(std::memory_order_relaxed) != this->_size) {
+                ::munmap(p, bytes);
+                return false;
+            }
+            this->_data = data;
+            return true;
+#else
+            return false;
+#endif
+        }
+
+    public:
+        /// <summary>
+        /// optionの定義の指紋を計算する
+        /// </summary>
+        /// <param name="map">optionの定義</param>
+        /// <returns>定義順の接頭辞付きのoption名と別名によるFNV-1aハッシュ</returns>
+        static std::uint64_t fingerprint_of(const OptionMap& map) {
+            std::uint64_t h = 14695981039346656037ull;
+            auto mix = [&h](std::string_view str) {
+                for (char c : str) {
+                    h ^= static_cast<unsigned char>(c);
+                    h *= 1099511628211ull;
+                }
+                h ^= 0xFF;
+                h *= 1099511628211ull;
+            };
+            for (auto p : map.schema().options()) {
+                mix(p->name().empty() ? std::string_view() : std::string_view(p->full_name()));
+                for (const auto& alias : p->aliases()) mix(alias);
+            }
+            return h;
+        }
+
+        /// <summary>
+        /// 使用回数の領域の確保
+        /// </summary>
+        /// <param name="fingerprint">optionの定義の指紋</param>
+        /// <param name="size">optionの数</param>
+        /// <param name="mode">共有メモリを作成するときのアクセス権(umaskが適用される)</param>
+        UsageCounters(std::uint64_t fingerprint, std::size_t size, unsigned int mode = DEFAULT_MODE) : _fingerprint(fingerprint), _size(size), _name(segment_name(fingerprint)) {
+            this->_shared = this->map_shared(mode);
+            if (!this->_shared) {
+                this->_local.assign(header_size + size, 0);
+                this->_data = this->_local.data();
+            }
+        }
+        UsageCounters(const UsageCounters&) = delete;
+        UsageCounters& operator=(const UsageCounters&) = delete;
+        ~UsageCounters() {
+#ifndef _WIN32
+            if (this->_shared) ::munmap(this->_data, (header_size + this->_size) * sizeof(std::uint64_t));
+#endif
+        }
+
+        /// <summary>
+        /// 指紋に対応する共有メモリの名前
+        /// </summary>
+        /// <param name="fingerprint">optionの定義の指紋</param>
+        /// <returns></returns>
+        static std::string segment_name(std::uint64_t fingerprint) {
+            char buf[32];
+            std::snprintf(buf, sizeof(buf), "/clo-usage-%016llx", static_cast<unsigned long long>(fingerprint));
+            return buf;
+        }
+
+        /// <summary>
+        /// 指紋に対応する共有メモリを削除する(マップ済みのプロセスは引き続き計測できる)
+        /// </summary>
+        /// <param name="fingerprint">optionの定義の指紋</param>
+        /// <returns>削除できたときにtrue</returns>
+        static bool remove(std::uint64_t fingerprint) {
+#ifndef _WIN32
+            return ::shm_unlink(segment_name(fingerprint).c_str()) == 0;
+#else
+            return false;
+#endif
+        }
+
+        /// <summary>
+        /// 使用回数を1つ増やす
+        /// </summary>
+        /// <param name="i">optionの定義順のインデックス</param>
+        void add(std::size_t i) noexcept override {
+            std::atomic_ref<std::uint64_t>(this->_data[header_size + i]).fetch_add(1, std::memory_order_relaxed);
+        }
+
+        /// <summary>
+        /// 使用回数の取得
+        /// </summary>
+        /// <param name="i">optionの定義順のインデックス</param>
+        /// <returns></returns>
+        std::uint64_t count(std::size_t i) const noexcept {
+            return std::atomic_ref<std::uint64_t>(this->_data[header_size + i]).load(std::memory_order_relaxed);
+        }
+
+        /// <summary>
+        /// optionの数
+        /// </summary>
+        /// <returns></returns>
+        std::size_t size() const noexcept { return this->_size; }
+
+        /// <summary>
+        /// optionの定義の指紋
+        /// </summary>
+        /// <returns></returns>
+        std::uint64_t fingerprint() const noexcept { return this->_fingerprint; }
+
+        /// <summary>
+        /// プロセス間で共有しているかの判定
+        /// </summary>
+        /// <returns>共有メモリにマップしているときにtrue</returns>
+        bool shared() const noexcept { return this->_shared; }
+
+        /// <summary>
+        /// optionの使用回数をPrometheusのテキスト形式で出力する
+        /// </summary>
+        /// <param name="map">計測を開始したoptionの定義</param>
+        /// <param name="out">出力先</param>
+        /// <remarks>
+        /// 名前をもつoptionごとにcommand_line_option_usage_total{schema="指紋",option="接頭辞付きの名前"}を出力する
+        /// </remarks>
+        static void write_prometheus(const OptionMap& map, std::string& out) {
+            const auto usage = map.usage_counters<UsageCounters>();
+            if (!usage) {
+                throw std::logic_error("使用回数を計測していません");
+            }
+            char schema[17];
+            std::snprintf(schema, sizeof(schema), "%016llx", static_cast<unsigned long long>(usage->fingerprint()));
+            out += "# HELP command_line_option_usage_total Number of times each option was matched by OptionMap::parse.\n";
+            out += "# TYPE command_line_option_usage_total counter\n";
+            for (auto p : map.schema().options()) {
+                if (p->name().empty()) continue;
+                out.append("command_line_option_usage_total{schema=\"").append(schema).append("\",option=\"");
+                // ラベル値のエスケープ
+                for (char c : p->full_name()) {
+                    if (c == '\\' || c == '"') out += '\\';
+                    if (c == '\n') out += "\\n";
+                    else out += c;
+                }
+                out.append("\"} ").append(std::to_string(usage->count(p->order()))).append("\n");
+            }
+        }
+
+        /// <summary>
+        /// optionの使用回数をPrometheusのテキスト形式でファイルへ書き出す
+        /// </summary>
+        /// <param name="map">計測を開始したoptionの定義</param>
+        /// <param name="path">出力先のファイルパス</param>
+        /// <returns>書き出せたときにtrue</returns>
+        /// <remarks>
+        /// 収集側が書きかけのファイルを読まないように一時ファイルへ書き込んでから置き換える
+        /// </remarks>
+        static bool export_prometheus(const OptionMap& map, const std::string& path) {
+            std::string text;
+            write_prometheus(map, text);
+            const std::string temp = path + ".tmp";
+#ifdef _WIN32
+            std::FILE* fp = nullptr;
+            if (::fopen_s(&fp, temp.c_str(), "wb") != 0) fp = nullptr;
+#else
+            std::FILE* fp = std::fopen(temp.c_str(), "wb");
+#endif
+            if (fp == nullptr) return false;
+            const bool written = std::fwrite(text.data(), 1, text.size(), fp) == text.size();
+            if (std::fclose(fp) != 0 || !written) {
+                std::remove(temp.c_str());
+                return false;
+            }
+#ifdef _WIN32
+            std::remove(path.c_str());
+#endif
+            return std::rename(temp.c_str(), path.c_str()) == 0;
+        }
+    };
+}
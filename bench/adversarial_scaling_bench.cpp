@@ -0,0 +1,168 @@
+// 解析時間が入力の大きさに対して線形であることの計測(敵対的な入力)
+//   g++ -std=c++20 -O2 -I. bench/adversarial_scaling_bench.cpp && ./a.out
+// 各入力を大きさn, 2n, 4n, 8nで解析し、log(時間)のlog(n)に対する傾きが1.2を超えたとき(超線形)は失敗として1で終了する(3回計測し直しても超えたとき)
+#include "CommandLineOption.hpp"
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iostream>
+
+namespace {
+    /// <summary>
+    /// log-logの傾きの上限(線形は1、n log nはこの範囲の大きさで約1.1、n^1.5は1.5)
+    /// </summary>
+    constexpr double max_slope = 1.2;
+
+    struct Input {
+        std::vector<std::string> tokens;
+        std::vector<const char*> argv;
+
+        void push(std::string token) { this->tokens.push_back(std::move(token)); }
+        const std::vector<const char*>& finish() {
+            this->argv.clear();
+            for (const auto& token : this->tokens) this->argv.push_back(token.c_str());
+            return this->argv;
+        }
+    };
+
+    /// <summary>
+    /// 大きさnの入力に対する1回の処理の時間(9回の最小値)
+    /// </summary>
+    double measure(const std::function<void(std::size_t)>& run, std::size_t n) {
+        double best = std::numeric_limits<double>::max();
+        for (int i = 0; i < 9; ++i) {
+            const auto begin = std::chrono::steady_clock::now();
+            run(n);
+            best = std::min(best, std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count());
+        }
+        return best;
+    }
+
+    /// <summary>
+    /// n, 2n, 4n, 8nの時間からlog(時間)とlog(n)の最小二乗の傾きを求める(各倍増の時間の比(2n/n)も表示する)
+    /// </summary>
+    double slope(const std::function<void(std::size_t)>& run, std::size_t base) {
+        std::vector<double> xs, ys;
+        double previous = 0;
+        for (std::size_t n = base; n <= base * 8; n *= 2) {
+            const double time = std::max(measure(run, n), 1.0);
+            std::cout << " n=" << n << " " << time << "us";
+            if (previous > 0) std::cout << " (x" << time / previous << ")";
+            previous = time;
+            xs.push_back(std::log(static_cast<double>(n)));
+            ys.push_back(std::log(time));
+        }
+        double mx = 0, my = 0;
+        for (std::size_t i = 0; i < xs.size(); ++i) { mx += xs[i]; my += ys[i]; }
+        mx /= xs.size();
+        my /= ys.size();
+        double sxy = 0, sxx = 0;
+        for (std::size_t i = 0; i < xs.size(); ++i) {
+            sxy += (xs[i] - mx) * (ys[i] - my);
+            sxx += (xs[i] - mx) * (xs[i] - mx);
+        }
+        return sxy / sxx;
+    }
+
+    /// <summary>
+    /// 傾きが上限以下であることを確認する
+    /// </summary>
+    /// <remarks>
+    /// 計測の揺らぎは時間を増やす向きにしか働かないため、上限を超えたときは3回まで計測し直し、すべてで超えたときに失敗とする(本当に超線形なら毎回超える)
+    /// </remarks>
+    bool check(const char* name, std::size_t base, const std::function<void(std::size_t)>& run) {
+        for (int attempt = 0; attempt < 3; ++attempt) {
+            std::cout << name << ":";
+            const double value = slope(run, base);
+            const bool ok = value <= max_slope;
+            std::cout << " slope=" << value << (ok ? " ok" : " SUPERLINEAR") << "\n";
+            if (ok) return true;
+        }
+        return false;
+    }
+
+    /// <summary>
+    /// 構築済みの定義でargvを解析する(解析の前に初期化する)
+    /// </summary>
+    void parse(option::CommandLineOption& clo, Input& input) {
+        const auto& argv = input.finish();
+        clo.map().init();
+        clo.parse(static_cast<int>(argv.size()), const_cast<const char**>(argv.data()), false);
+    }
+}
+
+int main() {
+    bool ok = true;
+
+    // 同じoptionの繰り返し(引数の数の上限の確認が繰り返しごとに全体を数え直さないこと)
+    ok &= check("repeated short option", 20000, [](std::size_t n) {
+        option::CommandLineOption clo;
+        clo.add_options().o("k", option::Value<int>().unlimited(), "k");
+        Input input;
+        for (std::size_t i = 0; i < n; ++i) { input.push("-k"); input.push("1"); }
+        parse(clo, input);
+    });
+    ok &= check("repeated long option values", 20000, [](std::size_t n) {
+        option::CommandLineOption clo;
+        clo.add_options().l("k", option::Value<int>().unlimited(), "k").o("v", option::Counter(), "v");
+        Input input;
+        input.push("--k");
+        for (std::size_t i = 0; i < n; ++i) input.push("1");
+        for (std::size_t i = 0; i < n; ++i) input.push("-v");
+        parse(clo, input);
+    });
+
+    // ハイフンのみのトークンの連続(先読みの連鎖)
+    ok &= check("dash runs", 20000, [](std::size_t n) {
+        option::CommandLineOption clo;
+        clo.add_options().l("k", option::Value<std::string>().unlimited(), "k").u(option::Value<std::string>().unlimited(), "rest");
+        Input input;
+        input.push("--k");
+        for (std::size_t i = 0; i < n; ++i) input.push(i % 2 == 0 ? "-" : "--");
+        parse(clo, input);
+    });
+    // 1トークンの長さを伸ばす計測は8nでもキャッシュに収まる大きさにする(収まらないと文字あたりの複製の時間が増え、傾きが計算量と無関係に上がる)
+    ok &= check("long dash token", 50000, [](std::size_t n) {
+        option::CommandLineOption clo;
+        clo.add_options().l("k", option::Value<std::string>().unlimited(), "k").u(option::Value<std::string>().unlimited(), "rest");
+        Input input;
+        input.push("--k");
+        input.push(std::string(n, '-'));
+        input.push("-x");
+        parse(clo, input);
+    });
+
+    // 等号を含むトークン
+    ok &= check("many = tokens", 20000, [](std::size_t n) {
+        option::CommandLineOption clo;
+        clo.add_options().l("k=", option::Value<std::string>().unlimited(), "k");
+        Input input;
+        for (std::size_t i = 0; i < n; ++i) input.push("--k=a=b=c");
+        parse(clo, input);
+    });
+    ok &= check("long = value", 50000, [](std::size_t n) {
+        option::CommandLineOption clo;
+        clo.add_options().l("k=", option::Value<std::string>(), "k");
+        Input input;
+        input.push("--k=" + std::string(n, '='));
+        parse(clo, input);
+    });
+
+    // 巨大な定義(定義の構築と全optionを1回ずつ指定した解析)
+    // 数千を超えると定義全体がキャッシュから溢れ、optionあたりの時間が計算量と無関係に増えるため、nは500から始める
+    ok &= check("huge schema", 500, [](std::size_t n) {
+        option::CommandLineOption clo;
+        auto builder = clo.add_options();
+        Input input;
+        for (std::size_t i = 0; i < n; ++i) {
+            const auto name = "opt" + std::to_string(i);
+            builder.l(name, option::Value<int>(), "v");
+            input.push("--" + name);
+            input.push("1");
+        }
+        parse(clo, input);
+    });
+
+    std::cout << (ok ? "ok" : "failed") << "\n";
+    return ok ? 0 : 1;
+}
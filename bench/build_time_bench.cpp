@@ -0,0 +1,141 @@
+// ヘッダの取り込み方によるビルド時間の計測
+//   g++ -std=c++20 -O2 bench/build_time_bench.cpp -o build_time_bench && ./build_time_bench [翻訳単位の数]
+// リポジトリの最上位で実行する。コンパイラは環境変数CXX(既定はg++)、追加のフラグはCXXFLAGSで指定する
+// 同じ内容の翻訳単位を以下の方法でそれぞれコンパイルし、1翻訳単位あたりの時間の最小値と平均を出力する
+//   baseline: 分割と機能追加の前のCommandLineOption.hpp(git show 75ffb0dで取り出し、GCCで通るようにto_value_typeのみを修正する)を取り込む
+//   core:   CommandLineOption.hppのみを取り込む
+//   all:    分割した全てのヘッダを取り込む(分割前の単一のヘッダに相当する)
+//   extern: allにCOMMAND_LINE_OPTION_EXTERN_TEMPLATEを定義する(インスタンス化はCommandLineOption.cppで1度だけ行う)
+// 翻訳単位の内容は引数を持たないoptionのみのflagsと、引数付きのoptionを含むvaluesの2種類とする(baselineでも利用できる機能のみを用いる)
+// コンパイルに失敗した組み合わせはfailedと出力する
+// モジュール(CommandLineOption.ixx)はGCC 12ではインタフェースのコンパイルが内部エラーとなるため計測しない
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+    struct Mode {
+        const char* name;
+        const char* prologue;
+        const char* flags;
+    };
+
+    constexpr Mode modes[] = {
+        { "baseline", "#include \"baseline/CommandLineOption.hpp\"\n", "" },
+        { "core", "#include \"CommandLineOption.hpp\"\n", "" },
+        { "all",
+          "#include \"CommandLineOption.hpp\"\n#include \"CommandLineOptionCatalog.hpp\"\n#include \"CommandLineOptionJson.hpp\"\n"
+          "#include \"CommandLineOptionPattern.hpp\"\n#include \"CommandLineOptionPath.hpp\"\n#include \"CommandLineOptionTerminal.hpp\"\n"
+          "#include \"CommandLineOptionUsage.hpp\"\n#include \"CommandLineOptionEditable.hpp\"\n#include \"CommandLineOptionStatic.hpp\"\n", "" },
+        { "extern",
+          "#include \"CommandLineOption.hpp\"\n#include \"CommandLineOptionCatalog.hpp\"\n#include \"CommandLineOptionJson.hpp\"\n"
+          "#include \"CommandLineOptionPattern.hpp\"\n#include \"CommandLineOptionPath.hpp\"\n#include \"CommandLineOptionTerminal.hpp\"\n"
+          "#include \"CommandLineOptionUsage.hpp\"\n#include \"CommandLineOptionEditable.hpp\"\n#include \"CommandLineOptionStatic.hpp\"\n",
+          " -DCOMMAND_LINE_OPTION_EXTERN_TEMPLATE" },
+    };
+
+    struct Body {
+        const char* name;
+        const char* code;
+    };
+
+    // coreとbaselineはJSONのヘッダを取り込まないため解析結果はoptionの利用の有無と引数で確認する
+    constexpr Body bodies[] = {
+        { "flags",
+          "int main(int argc, const char* argv[]) {\n"
+          "    option::CommandLineOption clo;\n"
+          "    clo.add_options().o(\"v\", \"v\").o(\"f\", \"f\").l(\"color\", \"c\");\n"
+          "    clo.parse(argc, argv);\n"
+          "    return clo.map().use(\"v\") ? 1 : 0;\n"
+          "}\n" },
+        { "values",
+          "int main(int argc, const char* argv[]) {\n"
+          "    option::CommandLineOption clo;\n"
+          "    clo.add_options().o(\"v\", \"v\").l(\"jobs\", option::Value<int>(1), \"j\").l(\"ratio\", option::Value<double>().limit(2), \"r\");\n"
+          "    clo.parse(argc, argv);\n"
+          "    return clo.map().use(\"jobs\").as<int>() > 1 ? 1 : 0;\n"
+          "}\n" },
+    };
+
+    double seconds_of(const std::string& command) {
+        const auto begin = std::chrono::steady_clock::now();
+        const int status = std::system(command.c_str());
+        const auto end = std::chrono::steady_clock::now();
+        return status == 0 ? std::chrono::duration<double>(end - begin).count() : -1;
+    }
+
+    std::string getenv_or(const char* name, const char* fallback) {
+        const char* value = std::getenv(name);
+        return value != nullptr ? value : fallback;
+    }
+
+    // baselineのヘッダを取り出してGCCが受け付けないクラス内の明示的特殊化を部分特殊化の条件に置き換える
+    bool extract_baseline(const std::filesystem::path& repo, const std::filesystem::path& dir) {
+        std::filesystem::create_directories(dir);
+        const auto header = dir / "CommandLineOption.hpp";
+        if (std::system(("git -C \"" + repo.string() + "\" show 75ffb0d:CommandLineOption.hpp > \"" + header.string() + "\"").c_str()) != 0) return false;
+        std::stringstream stream;
+        stream << std::ifstream(header).rdbuf();
+        std::string text = stream.str();
+        const std::string partial = "struct to_value_type<T, std::void_t<typename T::value_type>> {";
+        const std::string full = "        // std::stringは例外\n        template <>\n        struct to_value_type<std::string> {\n            using type = std::string;\n        };\n";
+        const auto p = text.find(partial), f = text.find(full);
+        if (p == std::string::npos || f == std::string::npos) return false;
+        text.erase(f, full.size());
+        text.replace(p, partial.size(), "struct to_value_type<T, std::enable_if_t<!std::is_same_v<T, std::string>, std::void_t<typename T::value_type>>> {");
+        std::ofstream(header) << text;
+        return true;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const int tu_num = argc > 1 ? std::atoi(argv[1]) : 8;
+    const auto repo = std::filesystem::current_path();
+    if (!std::filesystem::exists(repo / "CommandLineOption.hpp")) {
+        std::cerr << "リポジトリの最上位で実行してください" << std::endl;
+        return 2;
+    }
+    const auto work = std::filesystem::temp_directory_path() / "clo-build-time-bench";
+    std::filesystem::remove_all(work);
+    std::filesystem::create_directories(work);
+    const std::string compiler = getenv_or("CXX", "g++") + " -std=c++20 -O2 " + getenv_or("CXXFLAGS", "") + " -I\"" + repo.string() + "\"";
+    const std::string in_work = "cd \"" + work.string() + "\" && ";
+    const std::string quiet = " > /dev/null 2>&1";
+
+    const bool baseline = extract_baseline(repo, work / "baseline");
+    if (!baseline) std::cout << "baseline: failed to extract 75ffb0d\n";
+
+    // 計測環境の負荷の変動が特定の方法に偏らないよう、方法を1巡ずつ交互にコンパイルする
+    constexpr std::size_t body_num = std::size(bodies), mode_num = std::size(modes);
+    double total[body_num][mode_num] = {}, fastest[body_num][mode_num] = {};
+    bool failed[body_num][mode_num] = {};
+    for (std::size_t b = 0; b < body_num; ++b) {
+        for (std::size_t m = 0; m < mode_num; ++m) failed[b][m] = std::string_view(modes[m].name) == "baseline" && !baseline;
+    }
+    for (int i = 0; i < tu_num; ++i) {
+        for (std::size_t b = 0; b < body_num; ++b) {
+            for (std::size_t m = 0; m < mode_num; ++m) {
+                if (failed[b][m]) continue;
+                const auto source = work / (std::string(bodies[b].name) + "_" + modes[m].name + "_" + std::to_string(i) + ".cpp");
+                std::ofstream(source) << modes[m].prologue << bodies[b].code;
+                const double t = seconds_of(in_work + compiler + modes[m].flags + " -c \"" + source.string() + "\" -o \"" + source.string() + ".o\"" + quiet);
+                if (t < 0) failed[b][m] = true;
+                total[b][m] += t;
+                if (i == 0 || t < fastest[b][m]) fastest[b][m] = t;
+            }
+        }
+    }
+    for (std::size_t b = 0; b < body_num; ++b) {
+        for (std::size_t m = 0; m < mode_num; ++m) {
+            std::cout << bodies[b].name << " " << modes[m].name << ": ";
+            if (failed[b][m]) std::cout << "failed\n";
+            else std::cout << fastest[b][m] << " s/TU (min), " << total[b][m] / tu_num << " s/TU (mean)\n";
+        }
+    }
+    std::filesystem::remove_all(work);
+}
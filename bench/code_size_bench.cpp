@@ -0,0 +1,48 @@
+// 値の型ごとに生成されるコードの量と、起動時の定義と最初の解析の時間の計測
+//   g++ -std=c++20 -O2 -I. bench/code_size_bench.cpp && size a.out && ./a.out
+// COMMAND_LINE_OPTION_VALUE_TYPESの8つの型それぞれについて引数付きのshort optionとlong optionを定義して解析する
+// 生成されるコードの量はsizeの出力のtextで比較する
+#include "CommandLineOption.hpp"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+    template <class T>
+    void add(option::CommandLineOption& clo, char short_name, const char* long_name) {
+        clo.add_options()
+            .o(std::string(1, short_name), option::Value<T>().unlimited(), "short")
+            .l(long_name, option::Value<T>().unlimited(), "long");
+    }
+
+    std::size_t startup() {
+        option::CommandLineOption clo;
+        add<std::string>(clo, 's', "string");
+        add<int>(clo, 'i', "int");
+        add<long>(clo, 'l', "long");
+        add<long long>(clo, 'L', "long-long");
+        add<unsigned long long>(clo, 'u', "unsigned-long-long");
+        add<float>(clo, 'f', "float");
+        add<double>(clo, 'd', "double");
+        add<long double>(clo, 'D', "long-double");
+        const char* argv[] = {
+            "-s", "a", "-i", "1", "-l", "2", "-L", "3", "-u", "4", "-f", "0.5", "-d", "0.25", "-D", "0.125",
+            "--string", "b", "c", "--int=5", "--long", "6", "--long-long", "7", "--unsigned-long-long", "8",
+            "--float", "1.5", "--double", "2.5", "--long-double", "3.5",
+        };
+        clo.parse(static_cast<int>(std::size(argv)), argv);
+        return clo.map().use("string").as<std::vector<std::string>>().size();
+    }
+}
+
+int main() {
+    constexpr int iterations = 10000;
+    std::size_t checksum = 0;
+    const auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        checksum += startup();
+    }
+    const auto end = std::chrono::steady_clock::now();
+    std::cout << "define+parse us/iter=" << std::chrono::duration<double, std::micro>(end - begin).count() / iterations << " checksum=" << checksum << "\n";
+}
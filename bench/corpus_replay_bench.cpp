@@ -0,0 +1,89 @@
+// fuzz/corpusの各入力の定義の構築と解析の時間の計測(性能の退行の検出)
+//   g++ -std=c++20 -O2 -I. bench/corpus_replay_bench.cpp && ./a.out fuzz/corpus
+// 入力の形式はfuzz/parse_input.hppを参照。各入力を5回構築して解析した最小の時間を表示し、
+// 1つでもコマンドライン引数とoptionの数に比例する予算を超えたとき(もしくは定義が受け付けられないとき)は失敗として1で終了する
+#include "CommandLineOption.hpp"
+#include "fuzz/parse_input.hpp"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+    /// <summary>
+    /// 1入力の予算(固定分とコマンドライン引数もしくはoptionの1個あたりの分)
+    /// </summary>
+    /// <remarks>
+    /// sanitizerなしの最適化ビルドで線形な処理の数倍とし、fuzzerの予算より厳しくする
+    /// </remarks>
+    constexpr double base_budget_ms = 5;
+    constexpr double unit_budget_us = 1;
+
+    struct Timing {
+        double build = std::numeric_limits<double>::max();
+        double parse = std::numeric_limits<double>::max();
+    };
+
+    /// <summary>
+    /// 入力の定義の構築と解析の時間(5回の最小値)
+    /// </summary>
+    Timing measure(const parse_input::Input& input) {
+        std::vector<const char*> argv;
+        for (const auto& token : input.tokens) argv.push_back(token.c_str());
+        Timing best;
+        for (int i = 0; i < 5; ++i) {
+            const auto begin = std::chrono::steady_clock::now();
+            option::CommandLineOption clo;
+            parse_input::build(clo, input);
+            const auto built = std::chrono::steady_clock::now();
+            try {
+                clo.parse(static_cast<int>(argv.size()), argv.data());
+            }
+            catch (const std::runtime_error&) {
+            }
+            const auto end = std::chrono::steady_clock::now();
+            best.build = std::min(best.build, std::chrono::duration<double, std::milli>(built - begin).count());
+            best.parse = std::min(best.parse, std::chrono::duration<double, std::milli>(end - built).count());
+        }
+        return best;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const std::filesystem::path directory = argc > 1 ? argv[1] : "fuzz/corpus";
+    std::vector<std::filesystem::path> inputs;
+    for (const auto& entry : std::filesystem::directory_iterator(directory)) inputs.push_back(entry.path());
+    std::sort(inputs.begin(), inputs.end());
+
+    bool ok = !inputs.empty();
+    for (const auto& path : inputs) {
+        std::ifstream file(path, std::ios::binary);
+        const std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        parse_input::Input input;
+        std::cout << path.filename().string() << ":";
+        if (!parse_input::decode(reinterpret_cast<const std::uint8_t*>(bytes.data()), bytes.size(), input)) {
+            std::cout << " too short FAILED\n";
+            ok = false;
+            continue;
+        }
+        try {
+            const auto timing = measure(input);
+            const double budget = parse_input::budget_ms(input, base_budget_ms, unit_budget_us);
+            const bool within = timing.build + timing.parse <= budget;
+            std::cout << " tokens=" << input.tokens.size() << " options=" << input.generated << " build=" << timing.build << "ms parse=" << timing.parse
+                << "ms budget=" << budget << "ms" << (within ? " ok" : " OVER BUDGET") << "\n";
+            ok &= within;
+        }
+        catch (const std::invalid_argument& e) {
+            std::cout << " rejected schema (" << e.what() << ") FAILED\n";
+            ok = false;
+        }
+    }
+
+    std::cout << (ok ? "ok" : "failed") << "\n";
+    return ok ? 0 : 1;
+}
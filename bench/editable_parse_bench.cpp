@@ -0,0 +1,52 @@
+// EditableParseの編集1回あたりの時間の計測(行の長さに対する変化)
+//   g++ -std=c++20 -O2 -I. bench/editable_parse_bench.cpp && ./a.out
+// n個のlong option(--opt0 1 --opt1 1 ...)を定義して全てを指定した行に対し、行の中央と先頭で引数を書き換える編集を繰り返す
+// 再解析するトークンの数は行の長さによらないため、編集1回あたりの時間もnによらないことを確認する
+#include "CommandLineOption.hpp"
+#include "CommandLineOptionEditable.hpp"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+    /// <summary>
+    /// 位置positionの引数を書き換える編集をiterations回繰り返した1回あたりの時間
+    /// </summary>
+    double measure(option::EditableParse& session, std::size_t position, int iterations) {
+        const auto begin = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            session.edit(position, position + 1, { i % 2 == 0 ? "2" : "3" });
+        }
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count() / iterations;
+    }
+}
+
+int main() {
+    constexpr int iterations = 2000;
+    for (std::size_t n = 1000; n <= 64000; n *= 4) {
+        option::CommandLineOption clo;
+        auto builder = clo.add_options();
+        std::vector<std::string> tokens;
+        for (std::size_t i = 0; i < n; ++i) {
+            const auto name = "opt" + std::to_string(i);
+            builder.l(name, option::Value<int>(), "v");
+            tokens.push_back("--" + name);
+            tokens.push_back("1");
+        }
+        auto session = clo.parse_editable();
+        session.edit(0, 0, tokens.begin(), tokens.end());
+
+        const double middle = measure(session, n + 1, iterations);
+        const std::size_t reparsed = session.reparsed();
+        // 中央と先頭を交互に編集するときは間隙を行の半分ずつ移す
+        const auto begin = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations / 20; ++i) {
+            session.edit(i % 2 == 0 ? 1 : n + 1, (i % 2 == 0 ? 1 : n + 1) + 1, { "4" });
+        }
+        const double alternating = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count() / (iterations / 20);
+        const double head = measure(session, 1, iterations);
+        std::cout << "tokens=" << tokens.size() << " reparsed=" << reparsed << " middle us/edit=" << middle << " head us/edit=" << head
+            << " alternating us/edit=" << alternating << "\n";
+    }
+}
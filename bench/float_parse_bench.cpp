@@ -0,0 +1,59 @@
+// 浮動小数点数の引数の変換の速度と往復変換の正確さの計測
+//   g++ -std=c++20 -O2 -I. bench/float_parse_bench.cpp && ./a.out
+// 無作為なビット列のdouble(有限値)100万個を最短の往復可能な10進表記にし、
+// Cロケールのistringstreamによる変換とValue<double>::transformによる変換のMB/sとビット単位で一致しない値の数を出力する
+#include "CommandLineOption.hpp"
+#include <bit>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+namespace {
+    template <class F>
+    double mb_per_s(const std::vector<std::string>& inputs, std::size_t bytes, F&& f) {
+        const auto begin = std::chrono::steady_clock::now();
+        for (const auto& input : inputs) f(input);
+        const auto end = std::chrono::steady_clock::now();
+        return bytes / std::chrono::duration<double, std::micro>(end - begin).count();
+    }
+}
+
+int main() {
+    constexpr std::size_t count = 1000000;
+    std::mt19937_64 rng(69);
+    std::vector<double> expected;
+    std::vector<std::string> inputs;
+    std::size_t bytes = 0;
+    while (expected.size() < count) {
+        const auto x = std::bit_cast<double>(rng());
+        if (!std::isfinite(x)) continue;
+        char buf[64];
+        const auto [ptr, ec] = std::to_chars(buf, buf + sizeof(buf), x);
+        expected.push_back(x);
+        inputs.emplace_back(buf, ptr);
+        bytes += inputs.back().size();
+    }
+
+    std::vector<double> results;
+    results.reserve(count);
+    const auto stream = mb_per_s(inputs, bytes, [&](const std::string& input) {
+        std::istringstream s(input);
+        s.imbue(std::locale::classic());
+        double x = 0;
+        s >> x;
+        results.push_back(x);
+    });
+    std::size_t stream_mismatches = 0;
+    for (std::size_t i = 0; i < count; ++i) stream_mismatches += std::bit_cast<std::uint64_t>(results[i]) != std::bit_cast<std::uint64_t>(expected[i]);
+
+    results.clear();
+    option::Value<double> value;
+    const auto transform = mb_per_s(inputs, bytes, [&](const std::string& input) { results.push_back(value.transform(input)); });
+    std::size_t transform_mismatches = 0;
+    for (std::size_t i = 0; i < count; ++i) transform_mismatches += std::bit_cast<std::uint64_t>(results[i]) != std::bit_cast<std::uint64_t>(expected[i]);
+
+    std::cout << "values=" << count << " istringstream MB/s=" << stream << " mismatches=" << stream_mismatches << "\n";
+    std::cout << "values=" << count << " Value::transform MB/s=" << transform << " mismatches=" << transform_mismatches << "\n";
+}
@@ -0,0 +1,52 @@
+// Value::one_ofの許可された値の集合による検査の1値あたりの時間の計測
+//   g++ -std=c++20 -O2 -I. bench/one_of_bench.cpp && ./a.out
+// 5000個の許可された値に対して50000個の引数を検査し、OneOfのfind_missingと線形探索のstd::findを比較する
+// 文字列は"SKU-"に6桁の番号を続けた識別子とする
+#include "CommandLineOption.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+
+namespace {
+    constexpr std::size_t allowed_num = 5000;
+    constexpr std::size_t value_num = 50000;
+    constexpr int repeat = 20;
+
+    template <class F>
+    double ns_per_value(F&& f) {
+        const auto begin = std::chrono::steady_clock::now();
+        for (int r = 0; r < repeat; ++r) f();
+        const auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::nano>(end - begin).count() / (repeat * value_num);
+    }
+}
+
+int main() {
+    std::mt19937_64 rng(73);
+    std::size_t checksum = 0;
+    {
+        std::vector<long long> allowed(allowed_num);
+        for (auto& x : allowed) x = static_cast<long long>(rng() >> 1);
+        std::vector<long long> values(value_num);
+        for (auto& x : values) x = allowed[rng() % allowed_num];
+        const option::OneOf<long long> set(allowed);
+
+        const auto one_of = ns_per_value([&] { checksum += set.find_missing(values); });
+        const auto linear = ns_per_value([&] {
+            for (auto x : values) checksum += std::find(allowed.begin(), allowed.end(), x) - allowed.begin();
+        });
+        std::cout << "long long: one_of ns/value=" << one_of << " std::find ns/value=" << linear << "\n";
+    }
+    {
+        std::vector<std::string> allowed(allowed_num);
+        for (auto& s : allowed) s = "SKU-" + std::to_string(100000 + rng() % 900000);
+        std::vector<std::string> values(value_num);
+        for (auto& s : values) s = allowed[rng() % allowed_num];
+        const option::OneOf<std::string> set(allowed);
+
+        const auto one_of = ns_per_value([&] { checksum += set.find_missing(values); });
+        std::cout << "string: one_of ns/value=" << one_of << "\n";
+    }
+    std::cout << "checksum=" << checksum << "\n";
+}
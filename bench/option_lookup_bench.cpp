@@ -0,0 +1,188 @@
+// option名の検索方法の比較と、OptionMap::parseにおける1トークンあたりの時間の計測
+//   g++ -std=c++20 -O2 -I. bench/option_lookup_bench.cpp && ./a.out
+// 前半は3から12文字の乱数の名前(shared=1では共通の接頭辞"feature-"付き)n個に対するハッシュ表、整列済み配列の二分探索、
+// 節点ごとに子の文字を連続して並べたトライ、OptionLookupと同じ署名の線形探索の1回あたりの時間を比較する
+// 後半はn個のlong optionを定義して1000トークンを解析し、選ばれた検索方法と1トークンあたりの時間を出力する
+#include "CommandLineOption.hpp"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+    // OptionLookup::signatureと同じ署名
+    std::uint64_t signature(std::string_view key) noexcept {
+        std::uint32_t head = 0, tail = 0;
+        if (key.size() >= 4) {
+            std::memcpy(&head, key.data(), 4);
+            std::memcpy(&tail, key.data() + key.size() - 4, 4);
+        }
+        else {
+            std::memcpy(&head, key.data(), key.size());
+        }
+        return (std::uint64_t(head) | (std::uint64_t(tail) << 32)) ^ (std::uint64_t(key.size()) << 59) ^ key.size();
+    }
+
+    // 節点の子の文字と子の節点を連続した配列に並べたトライ
+    class Trie {
+        struct Node {
+            std::uint32_t first = 0;
+            std::uint32_t count = 0;
+            int value = -1;
+        };
+        std::vector<Node> _nodes;
+        std::vector<char> _labels;
+        std::vector<std::uint32_t> _children;
+
+        // 整列済みの名前の範囲[lo, hi)のdepth文字目以降を表す節点を構築する
+        std::uint32_t build(const std::vector<std::pair<std::string_view, int>>& names, std::size_t lo, std::size_t hi, std::size_t depth) {
+            const auto node = static_cast<std::uint32_t>(this->_nodes.size());
+            this->_nodes.emplace_back();
+            if (names[lo].first.size() == depth) this->_nodes[node].value = names[lo++].second;
+            std::vector<std::size_t> bounds;
+            for (std::size_t i = lo; i < hi; ++i) {
+                if (i == lo || names[i].first[depth] != names[i - 1].first[depth]) bounds.push_back(i);
+            }
+            bounds.push_back(hi);
+            const auto first = static_cast<std::uint32_t>(this->_labels.size());
+            this->_nodes[node].first = first;
+            this->_nodes[node].count = static_cast<std::uint32_t>(bounds.size() - 1);
+            for (std::size_t k = 0; k + 1 < bounds.size(); ++k) {
+                this->_labels.push_back(names[bounds[k]].first[depth]);
+                this->_children.push_back(0);
+            }
+            for (std::size_t k = 0; k + 1 < bounds.size(); ++k) {
+                const auto child = this->build(names, bounds[k], bounds[k + 1], depth + 1);
+                this->_children[first + k] = child;
+            }
+            return node;
+        }
+
+    public:
+        explicit Trie(const std::vector<std::string>& names) {
+            std::vector<std::pair<std::string_view, int>> sorted;
+            for (std::size_t i = 0; i < names.size(); ++i) sorted.emplace_back(names[i], static_cast<int>(i));
+            std::sort(sorted.begin(), sorted.end());
+            this->build(sorted, 0, sorted.size(), 0);
+        }
+
+        int find(std::string_view key) const noexcept {
+            std::uint32_t node = 0;
+            for (char c : key) {
+                const auto& n = this->_nodes[node];
+                const char* labels = this->_labels.data() + n.first;
+                std::uint32_t k = 0;
+                while (k < n.count && labels[k] != c) ++k;
+                if (k == n.count) return -1;
+                node = this->_children[n.first + k];
+            }
+            return this->_nodes[node].value;
+        }
+    };
+
+    template <class F>
+    double ns_per_lookup(const std::vector<std::string>& queries, F&& find, long& checksum) {
+        constexpr int repeat = 5;
+        const auto begin = std::chrono::steady_clock::now();
+        for (int r = 0; r < repeat; ++r) {
+            for (const auto& query : queries) {
+                checksum += find(std::string_view(query));
+            }
+        }
+        const auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::nano>(end - begin).count() / (repeat * queries.size());
+    }
+
+    void compare_strategies() {
+        std::mt19937 rng(3);
+        long checksum = 0;
+        for (int shared : { 0, 1 }) {
+            for (std::size_t n : { 2, 4, 8, 12, 16, 24, 32, 48, 64, 128, 256, 1024 }) {
+                std::vector<std::string> names;
+                std::set<std::string> seen;
+                while (names.size() < n) {
+                    std::string name = shared ? "feature-" : "";
+                    const int length = 3 + rng() % 10;
+                    for (int i = 0; i < length; ++i) name += static_cast<char>('a' + rng() % 26);
+                    if (seen.insert(name).second) names.push_back(name);
+                }
+                std::unordered_map<std::string_view, int> hash;
+                for (std::size_t i = 0; i < n; ++i) hash[names[i]] = static_cast<int>(i);
+                std::vector<std::string_view> sorted(names.begin(), names.end());
+                std::sort(sorted.begin(), sorted.end());
+                const Trie trie(names);
+                std::vector<std::uint64_t> signatures;
+                for (const auto& name : names) signatures.push_back(signature(name));
+                std::vector<std::string> queries;
+                for (int i = 0; i < 200000; ++i) queries.push_back(names[rng() % n]);
+
+                const double hash_ns = ns_per_lookup(queries, [&](std::string_view key) {
+                    const auto it = hash.find(key);
+                    return it == hash.end() ? -1 : it->second;
+                }, checksum);
+                const double sorted_ns = ns_per_lookup(queries, [&](std::string_view key) {
+                    const auto it = std::lower_bound(sorted.begin(), sorted.end(), key);
+                    return (it != sorted.end() && *it == key) ? static_cast<int>(it - sorted.begin()) : -1;
+                }, checksum);
+                const double trie_ns = ns_per_lookup(queries, [&](std::string_view key) { return trie.find(key); }, checksum);
+                const double linear_ns = ns_per_lookup(queries, [&](std::string_view key) {
+                    const auto sig = signature(key);
+                    const std::size_t size = signatures.size();
+                    for (std::size_t base = 0; base < size; base += 64) {
+                        std::uint64_t mask = 0;
+                        const std::size_t end = std::min(size, base + 64);
+                        for (std::size_t i = base; i < end; ++i) mask |= std::uint64_t(signatures[i] == sig) << (i - base);
+                        while (mask) {
+                            const std::size_t i = base + std::countr_zero(mask);
+                            if (names[i] == key) return static_cast<int>(i);
+                            mask &= mask - 1;
+                        }
+                    }
+                    return -1;
+                }, checksum);
+                std::cout << "shared=" << shared << " n=" << n << " hash=" << hash_ns << "ns sorted=" << sorted_ns << "ns trie=" << trie_ns << "ns linear=" << linear_ns << "ns\n";
+            }
+        }
+        std::cout << "checksum=" << checksum << "\n";
+    }
+
+    void measure_parse() {
+        constexpr int token_num = 1000;
+        constexpr int iterations = 200;
+        for (int n : { 4, 16, 17, 200 }) {
+            option::CommandLineOption clo;
+            auto builder = clo.add_options();
+            std::vector<std::string> names;
+            for (int i = 0; i < n; ++i) names.push_back("opt" + std::to_string(i * 7919 % 1000));
+            for (const auto& name : names) builder.l(name, option::Counter(), "c");
+            std::vector<std::string> tokens;
+            for (int i = 0; i < token_num; ++i) tokens.push_back("--" + names[(i * 31) % n]);
+            std::vector<const char*> argv;
+            for (const auto& token : tokens) argv.push_back(token.c_str());
+            clo.parse(static_cast<int>(argv.size()), argv.data());
+
+            const auto begin = std::chrono::steady_clock::now();
+            for (int i = 0; i < iterations; ++i) {
+                clo.map().init();
+                clo.parse(static_cast<int>(argv.size()), argv.data(), false);
+            }
+            const auto end = std::chrono::steady_clock::now();
+            const auto strategy = clo.map().long_option_lookup().strategy() == option::OptionLookup::STRATEGY::LINEAR ? "linear" : "hash";
+            std::cout << "options=" << n << " strategy=" << strategy
+                << " parse ns/token=" << std::chrono::duration<double, std::nano>(end - begin).count() / (iterations * token_num) << "\n";
+        }
+    }
+}
+
+int main() {
+    compare_strategies();
+    measure_parse();
+}
@@ -0,0 +1,31 @@
+// 全optionを走査するvalidateとinitの時間の計測
+//   g++ -std=c++20 -O2 -I. bench/schema_scan_bench.cpp && ./a.out
+// 4000個のoption(引数付き1000、計数1000、引数なし2000)を定義し、1回の解析の後にvalidateとinitを繰り返す
+#include "CommandLineOption.hpp"
+#include <chrono>
+#include <iostream>
+
+int main() {
+    constexpr int option_num = 4000;
+    constexpr int iterations = 2000;
+
+    option::CommandLineOption clo;
+    auto builder = clo.add_options();
+    for (int i = 0; i < option_num; ++i) {
+        const auto name = "opt" + std::to_string(i);
+        if (i % 4 == 0) builder.l(name, option::Value<int>(i), "v");
+        else if (i % 4 == 1) builder.l(name, option::Counter(), "c");
+        else builder.l(name, "f");
+    }
+    const char* argv[] = { "--opt4", "7", "--opt1", "--opt2" };
+    clo.parse(4, argv);
+
+    auto& map = clo.map();
+    const auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        map.validate();
+        map.init();
+    }
+    const auto end = std::chrono::steady_clock::now();
+    std::cout << "options=" << option_num << " validate+init us/iter=" << std::chrono::duration<double, std::micro>(end - begin).count() / iterations << "\n";
+}
@@ -0,0 +1,93 @@
+// CommandLineOption::parseのfuzzer
+//   clang++ -std=c++20 -g -O1 -fsanitize=fuzzer,address,undefined -I. fuzz/parse_fuzzer.cpp && ./a.out -max_len=65536 fuzz/corpus
+// libFuzzerを使わずにcorpusを再生するときはPARSE_FUZZER_MAINを定義して入力のファイルもしくはディレクトリを指定する
+//   g++ -std=c++20 -O2 -DPARSE_FUZZER_MAIN -I. fuzz/parse_fuzzer.cpp && ./a.out fuzz/corpus
+//
+// 入力の形式はfuzz/parse_input.hppを参照(定義の種類、記載パターン、引数の数の上限、中断、同じ名前のoptionも入力から作る)
+// 定義の構築と解析はParseLimitsの範囲で行い、受け付けられない定義として投げられるstd::invalid_argumentと入力の誤りとして投げられるstd::runtime_error以外の例外はそのまま伝播させる
+// 定義の構築と解析の時間がコマンドライン引数とoptionの数に比例する予算を超えたときは超線形な入力としてabortする
+#include "CommandLineOption.hpp"
+#include "CommandLineOptionJson.hpp"
+#include "fuzz/parse_input.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef PARSE_FUZZER_MAIN
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#endif
+
+// 1回の解析の時間の予算(固定分とコマンドライン引数もしくはoptionの1個あたりの分)
+// 線形な解析に対してはsanitizerを有効にしたビルドでも超えない程度の値とする
+#ifndef PARSE_FUZZER_BASE_BUDGET_MS
+#define PARSE_FUZZER_BASE_BUDGET_MS 50
+#endif
+#ifndef PARSE_FUZZER_UNIT_BUDGET_US
+#define PARSE_FUZZER_UNIT_BUDGET_US 5
+#endif
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size) {
+    parse_input::Input input;
+    if (!parse_input::decode(data, size, input)) {
+        return 0;
+    }
+    std::vector<const char*> argv;
+    argv.reserve(input.tokens.size());
+    for (const auto& token : input.tokens) argv.push_back(token.c_str());
+
+    // 大量のoptionの定義の構築も超線形になり得るため、解析と合わせて予算に含める
+    const auto begin = std::chrono::steady_clock::now();
+    option::CommandLineOption clo;
+    try {
+        parse_input::build(clo, input);
+    }
+    catch (const std::invalid_argument&) {
+        return 0;
+    }
+    const auto built = std::chrono::steady_clock::now();
+    try {
+        clo.parse(static_cast<int>(argv.size()), argv.data());
+        const auto json = clo.map().to_json();
+        if (json.empty()) std::abort();
+    }
+    catch (const std::runtime_error&) {
+    }
+    const auto end = std::chrono::steady_clock::now();
+    const auto elapsed = std::chrono::duration<double, std::milli>(end - begin).count();
+
+    const double budget = parse_input::budget_ms(input, PARSE_FUZZER_BASE_BUDGET_MS, PARSE_FUZZER_UNIT_BUDGET_US);
+    if (elapsed > budget) {
+        std::fprintf(stderr, "build took %.1f ms and parse %.1f ms (budget %.1f ms) for %zu tokens and %zu generated options\n",
+            std::chrono::duration<double, std::milli>(built - begin).count(), std::chrono::duration<double, std::milli>(end - built).count(), budget, argv.size(), input.generated);
+        std::abort();
+    }
+    return 0;
+}
+
+#ifdef PARSE_FUZZER_MAIN
+int main(int argc, char* argv[]) {
+    std::vector<std::filesystem::path> inputs;
+    for (int i = 1; i < argc; ++i) {
+        if (std::filesystem::is_directory(argv[i])) {
+            for (const auto& entry : std::filesystem::directory_iterator(argv[i])) inputs.push_back(entry.path());
+        }
+        else {
+            inputs.emplace_back(argv[i]);
+        }
+    }
+    for (const auto& input : inputs) {
+        std::ifstream file(input, std::ios::binary);
+        const std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        LLVMFuzzerTestOneInput(reinterpret_cast<const std::uint8_t*>(bytes.data()), bytes.size());
+    }
+    std::cout << "ok" << std::endl;
+}
+#endif
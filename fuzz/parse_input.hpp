@@ -0,0 +1,156 @@
+#pragma once
+
+// fuzz/parse_fuzzer.cppとbench/corpus_replay_bench.cppで共有する、入力のバイト列からの定義とコマンドライン引数の生成
+//
+// 入力の形式
+//   0バイト目: 固定の定義に追加するlong option(--g0, --g1, ...)の数を64で割った値
+//   1バイト目: 名前なしオプションの定義
+//              bit0-1: 1個目の引数の数の上限(1, 2, 3, 上限なし)  bit2: 1個目の後で解析を中断する
+//              bit3-4: 2個目の引数の数の上限(なし, 1, 2, 上限なし)  bit5: 2個目の後で解析を中断する
+//   2バイト目: 追加するlong optionの記述子の数L
+//   続くLバイト: 記述子(i番目のlong optionはi % L番目を使い、L == 0なら引数なしとする)
+//              bit0-2: 種類(引数なし, 計数, long long, string, 否定可能(既定true), 否定可能(既定false), double, int)
+//              bit3-4: 引数付きのときの記載パターン(空白と等号, 等号のみ, 空白のみ, 空白と等号)
+//              bit5-6: 引数の数の上限(1, 2, 3かつ1個必須, 上限なし)
+//              bit7:   直前のlong optionと同じ名前にする
+//   残り: '\0'で区切ったコマンドライン引数の列
+//         ただし'\x01'で始まる3バイト以上の引数は直前の引数を後続の2バイト(ビッグエンディアン)の回数だけ繰り返す
+#include "CommandLineOption.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace parse_input {
+    constexpr std::size_t generated_per_unit = 64;
+    constexpr std::size_t max_tokens = std::size_t(1) << 16;
+    constexpr std::size_t header_size = 3;
+
+    /// <summary>
+    /// 入力のバイト列を分解した結果
+    /// </summary>
+    struct Input {
+        /// <summary>
+        /// 追加するlong optionの数
+        /// </summary>
+        std::size_t generated = 0;
+        /// <summary>
+        /// 名前なしオプションの定義
+        /// </summary>
+        std::uint8_t unnamed = 0;
+        /// <summary>
+        /// long optionの記述子
+        /// </summary>
+        std::vector<std::uint8_t> descriptors;
+        /// <summary>
+        /// コマンドライン引数の列
+        /// </summary>
+        std::vector<std::string> tokens;
+    };
+
+    /// <summary>
+    /// 記述子の上限のビットから引数の情報を設定する
+    /// </summary>
+    template <class T>
+    option::Value<T> limited(option::Value<T> value, std::uint8_t bits) {
+        switch (bits & 0b11) {
+        case 0: return value.limit(1);
+        case 1: return value.limit(2);
+        case 2: return value.limit(3).required(1);
+        default: return value.unlimited();
+        }
+    }
+
+    /// <summary>
+    /// コマンドライン引数の列の分解
+    /// </summary>
+    inline std::vector<std::string> split(const std::uint8_t* data, std::size_t size) {
+        std::vector<std::string> tokens;
+        std::size_t begin = 0;
+        while (begin < size && tokens.size() < max_tokens) {
+            std::size_t end = begin;
+            while (end < size && data[end] != '\0') ++end;
+            std::string token(reinterpret_cast<const char*>(data + begin), end - begin);
+            if (token.size() >= 3 && token[0] == '\x01') {
+                if (!tokens.empty()) {
+                    const std::size_t count = (std::size_t(std::uint8_t(token[1])) << 8) | std::uint8_t(token[2]);
+                    const std::string previous = tokens.back();
+                    for (std::size_t i = 0; i < count && tokens.size() < max_tokens; ++i) tokens.push_back(previous);
+                }
+            }
+            else {
+                tokens.push_back(std::move(token));
+            }
+            begin = end + 1;
+        }
+        return tokens;
+    }
+
+    /// <summary>
+    /// 入力のバイト列の分解
+    /// </summary>
+    /// <returns>ヘッダに満たない入力はfalse</returns>
+    inline bool decode(const std::uint8_t* data, std::size_t size, Input& input) {
+        if (size < header_size) return false;
+        input.generated = data[0] * generated_per_unit;
+        input.unnamed = data[1];
+        const std::size_t count = std::min<std::size_t>(data[2], size - header_size);
+        input.descriptors.assign(data + header_size, data + header_size + count);
+        input.tokens = split(data + header_size + count, size - header_size - count);
+        return true;
+    }
+
+    /// <summary>
+    /// 入力の定義の構築
+    /// </summary>
+    /// <remarks>
+    /// 定義として受け付けられない組み合わせ(同じ名前で同じ記載パターンのoptionや、上限のない名前なしオプションの後の名前なしオプションなど)はstd::invalid_argumentを投げる
+    /// </remarks>
+    inline void build(option::CommandLineOption& clo, const Input& input) {
+        auto builder = clo.add_options();
+        builder.o("v", option::Counter(), "v").o("o", option::Value<int>().limit(3), "o").o("f", "f")
+            .l("out", option::Value<std::string>().unlimited(), "out").l("one=", option::Value<int>(), "one").l("two ", option::Value<double>().limit(2), "two")
+            .l("color", option::Negatable(true), "color").a("-O", "--out");
+
+        static constexpr const char* suffixes[] = { "", "=", " ", "" };
+        std::string name;
+        for (std::size_t i = 0; i < input.generated; ++i) {
+            const std::uint8_t d = input.descriptors.empty() ? 0 : input.descriptors[i % input.descriptors.size()];
+            if (i == 0 || (d & 0x80) == 0) name = "g" + std::to_string(i);
+            const std::string with_suffix = name + suffixes[(d >> 3) & 0b11];
+            const std::uint8_t bits = d >> 5;
+            switch (d & 0b111) {
+            case 0: builder.l(name, "g"); break;
+            case 1: builder.l(name, option::Counter(), "g"); break;
+            case 2: builder.l(with_suffix, limited(option::Value<long long>(), bits), "g"); break;
+            case 3: builder.l(with_suffix, limited(option::Value<std::string>(), bits), "g"); break;
+            case 4: builder.l(name, option::Negatable(true), "g"); break;
+            case 5: builder.l(name, option::Negatable(false), "g"); break;
+            case 6: builder.l(with_suffix, limited(option::Value<double>(), bits), "g"); break;
+            default: builder.l(with_suffix, limited(option::Value<int>(0), bits), "g"); break;
+            }
+        }
+
+        if ((input.unnamed >> 2) & 1) builder.u.pause();
+        builder.u(limited(option::Value<int>(), input.unnamed), "a");
+        if (const std::uint8_t second = (input.unnamed >> 3) & 0b11; second != 0) {
+            if ((input.unnamed >> 5) & 1) builder.u.pause();
+            builder.u(limited(option::Value<std::string>(), second - 1 + (second == 3)), "rest");
+        }
+
+        option::ParseLimits limits;
+        limits.tokens = max_tokens;
+        limits.bytes = std::size_t(1) << 22;
+        limits.values_per_option = max_tokens;
+        limits.values = max_tokens * 2;
+        clo.set_limits(limits);
+    }
+
+    /// <summary>
+    /// 構築と解析の時間の予算(固定分とコマンドライン引数もしくはoptionの1個あたりの分)
+    /// </summary>
+    inline double budget_ms(const Input& input, double base_ms, double unit_us) {
+        return base_ms + unit_us * 1e-3 * (input.tokens.size() + input.generated);
+    }
+}
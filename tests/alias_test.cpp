@@ -0,0 +1,55 @@
+// optionの別名のテスト
+//   g++ -std=c++20 -I. tests/alias_test.cpp && ./a.out
+#include "CommandLineOption.hpp"
+#include "test_util.hpp"
+#include <iostream>
+
+namespace {
+    // 別名の定義のエラーメッセージ(エラーとならないときは空)
+    std::string alias_error_of(const char* alias, const char* target) {
+        option::CommandLineOption clo;
+        clo.add_options()
+            .o("v", "v")
+            .l("jobs", option::Value<int>().unlimited(), "jobs")
+            .a("-j", "--jobs");
+        try {
+            clo.add_options().a(alias, target);
+        }
+        catch (const std::invalid_argument& e) {
+            return e.what();
+        }
+        return "";
+    }
+}
+
+int main() {
+    {
+        // 別名は対象のoptionと同じ引数の列に値を追加する
+        option::CommandLineOption clo;
+        clo.add_options()
+            .l("jobs", option::Value<int>().unlimited(), "jobs")
+            .a("-j", "--jobs")
+            .a("--parallel", "--jobs");
+        std::vector<const char*> argv = { "-j", "4", "--jobs=5", "--parallel", "6" };
+        clo.parse(static_cast<int>(argv.size()), argv.data());
+        expect(clo.map().luse("jobs").as<std::vector<int>>() == std::vector<int>{ 4, 5, 6 }, "-j, --jobs= and --parallel accumulate into one vector");
+        expect(clo.map().ouse("j").as<std::vector<int>>() == std::vector<int>{ 4, 5, 6 }, "the alias reads the same storage");
+    }
+    {
+        // 別名の定義の拒否
+        expect(alias_error_of("-k", "--jobs").empty(), "a new short alias is accepted");
+        expect(alias_error_of("--threads", "-j").empty(), "an alias of an alias resolves to the target");
+        expect(alias_error_of("-v", "--jobs") == "-v は既に定義されています", "an alias with the name of an option is rejected");
+        expect(alias_error_of("--jobs", "-v") == "--jobs は既に定義されています", "an alias with the name of a long option is rejected");
+        expect(alias_error_of("-j", "-v") == "-j は既に定義されています", "a duplicate alias is rejected");
+        expect(alias_error_of("-x", "--unknown") == "--unknown というoptionは存在しません", "an unknown target is rejected");
+        expect(alias_error_of("-x", "jobs") == "jobs というoptionは存在しません", "a target without a prefix is rejected");
+        expect(alias_error_of("--a=b", "--jobs") == "別名 --a=b に等号や空白スペースを含めることはできません", "an alias with = is rejected");
+        expect(alias_error_of("--a b", "--jobs") == "別名 --a b に等号や空白スペースを含めることはできません", "an alias with a space is rejected");
+        for (const char* bad : { "j", "-", "--", "---j" }) {
+            expect(alias_error_of(bad, "--jobs") == std::string("別名 ") + bad + " はoptionもしくはlong optionの形式である必要があります", std::string("an alias with a bad prefix is rejected: ") + bad);
+        }
+    }
+
+    return report();
+}
@@ -0,0 +1,93 @@
+// FileDescriptionCatalogによる説明とエラーメッセージの書式の置き換えのテスト
+//   g++ -std=c++20 -I. tests/catalog_test.cpp && ./a.out
+#include "CommandLineOptionCatalog.hpp"
+#include "test_util.hpp"
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace {
+    // マップ済みのファイルを書き換えないように、別のファイルに書き込んでから置き換える
+    void write_file(const std::filesystem::path& path, std::string_view content) {
+        auto temp = path;
+        temp += ".tmp";
+        std::ofstream(temp, std::ios::binary) << content;
+        std::filesystem::rename(temp, path);
+    }
+}
+
+int main() {
+    const auto path = std::filesystem::temp_directory_path() / ("catalog_test_" + std::to_string(::getpid()) + ".txt");
+    std::filesystem::remove(path);
+    {
+        // 構築時にはファイルを読み込まず、最初に参照したときの内容を用いる
+        auto en = std::make_shared<option::FileDescriptionCatalog>(path.string(), "en");
+        auto ja = std::make_shared<option::FileDescriptionCatalog>(path.string(), "ja");
+        write_file(path,
+            "\xEF\xBB\xBF# comment\r\n"
+            "common.desc=shared by all languages\r\n"
+            "[ja]\n"
+            "help.desc=ヘルプを表示する\n"
+            "[en]\n"
+            "help.desc=Show help\n"
+            "error.unknown_long_option=unknown option: {0}\n"
+            "error.unknown_option=broken {\n");
+        expect(en->find("help.desc", "") == "Show help", "the catalog is read on the first lookup");
+        write_file(path, "[en]\nhelp.desc=changed\n");
+        expect(en->find("help.desc", "") == "Show help" && en->size() == 4, "the catalog is read only once");
+
+        // 言語は節ごとに選択し、節より前の行は全言語で共通となる
+        expect(ja->find("help.desc", "none") == "none", "each catalog reads the file as it is on its own first lookup");
+        auto ja2 = std::make_shared<option::FileDescriptionCatalog>(path.string(), "ja");
+        write_file(path, "common.desc=common\n[ja]\nhelp.desc=ヘルプ\n[en]\nhelp.desc=Help\n");
+        expect(ja2->find("help.desc", "") == "ヘルプ" && ja2->find("common.desc", "") == "common", "the requested language and the common lines are indexed");
+        expect(en->find("common.desc", "") == "shared by all languages", "common lines are shared by every language");
+
+        // 該当しないキーと読み込めないファイルは指定した文字列とする
+        expect(en->find("missing", "fallback") == "fallback", "a missing key returns the fallback");
+        option::FileDescriptionCatalog none((path.string() + ".none"), "en");
+        expect(none.find("help.desc", "fallback") == "fallback" && none.size() == 0, "a missing file is an empty catalog");
+
+        option::CommandLineOption clo;
+        clo.add_options()
+            .l("help", "help.desc")
+            .l("plain", "not a key");
+        option::DescriptionCatalog::use(en);
+        const auto description = clo.description();
+        expect(description.find("Show help") != std::string::npos && description.find("help.desc") == std::string::npos, "descriptions given as keys are replaced");
+        expect(description.find("not a key") != std::string::npos, "descriptions without a key are shown as given");
+
+        // エラーメッセージはカタログの書式を用い、書式が不正なときは元の書式とする
+        const char* unknown_long[] = { "--nothing" };
+        try {
+            clo.parse(1, unknown_long);
+            expect(false, "an unknown long option throws");
+        }
+        catch (const std::runtime_error& e) {
+            expect(std::string_view(e.what()) == "unknown option: --nothing", "error messages use the catalog template");
+        }
+        const char* unknown_short[] = { "-z" };
+        try {
+            clo.parse(1, unknown_short);
+            expect(false, "an unknown option throws");
+        }
+        catch (const std::runtime_error& e) {
+            expect(std::string_view(e.what()) == "-z に該当するoptionは存在しません", "a malformed template falls back to the original template");
+        }
+        option::DescriptionCatalog::use(nullptr);
+    }
+    std::filesystem::remove(path);
+    {
+        // 置換フィールドは{}と{n}のみで、書式指定や範囲外の番号を含む書式はそのまま返す
+        using option::MessageFormat;
+        expect(MessageFormat::format("{} and {}", "a", 1) == "a and 1", "automatic numbering fills the arguments in order");
+        expect(MessageFormat::format("{1}{0}{1}", 'x', true) == "truextrue", "numbered fields may repeat and reorder");
+        expect(MessageFormat::format("{{{0}}}", 2.5) == "{2.5}", "doubled braces are escapes");
+        expect(MessageFormat::format("{0:>4}", 1) == "{0:>4}", "a format spec is rejected");
+        expect(MessageFormat::format("{} {0}", 1) == "{} {0}", "mixed numbering is rejected");
+        expect(MessageFormat::format("{1}", 1) == "{1}", "an index out of range is rejected");
+        expect(MessageFormat::format("a } b", 1) == "a } b", "an unmatched brace is rejected");
+    }
+
+    return report();
+}
@@ -0,0 +1,53 @@
+// DescriptionSinkによる説明の出力のテスト
+//   g++ -std=c++20 -I. tests/description_sink_test.cpp && ./a.out
+#include "CommandLineOption.hpp"
+#include "CommandLineOptionTerminal.hpp"
+#include "test_util.hpp"
+#include <iostream>
+
+namespace {
+    std::string read_all(std::FILE* fp) {
+        std::fflush(fp);
+        std::rewind(fp);
+        std::string result;
+        char buf[4096];
+        for (std::size_t n; (n = std::fread(buf, 1, sizeof(buf), fp)) > 0;) result.append(buf, n);
+        return result;
+    }
+}
+
+int main() {
+    {
+        // writeに渡した一時的な文字列はflushを待たずに破棄してよい
+        std::FILE* fp = std::tmpfile();
+        std::string expected;
+        {
+            option::FdDescriptionSink sink(fileno(fp));
+            for (int i = 0; i < 1000; ++i) {
+                std::string temp = std::to_string(i) + (i % 7 == 0 ? std::string(5000, 'x') : std::string(","));
+                sink.write(temp);
+                expected += temp;
+                temp.assign(temp.size(), '?');
+            }
+            sink.spaces(3);
+            expected += "   ";
+            sink.flush();
+        }
+        expect(read_all(fp) == expected, "temporaries written to FdDescriptionSink survive until flush");
+        std::fclose(fp);
+    }
+    {
+        // 逐次出力は文字列として構築した説明と一致する
+        option::CommandLineOption clo;
+        clo.add_options()
+            .l("help", "ヘルプ")
+            .o("o", option::Value<std::string>("out.txt").name("out"), "出力ファイル名")
+            .l("k", option::Value<int>().unlimited(), std::string(200, 'k'));
+        std::FILE* fp = std::tmpfile();
+        clo.print_description(fileno(fp));
+        expect(read_all(fp) == clo.description(), "print_description(fd) matches description()");
+        std::fclose(fp);
+    }
+
+    return report();
+}
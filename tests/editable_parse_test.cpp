@@ -0,0 +1,109 @@
+// EditableParseとOptionMap::parseの解析結果の一致のテスト(ランダムな編集の列の各段階で比較する)
+//   g++ -std=c++20 -I. tests/editable_parse_test.cpp && ./a.out
+#include "CommandLineOption.hpp"
+#include "CommandLineOptionEditable.hpp"
+#include "CommandLineOptionJson.hpp"
+#include "test_util.hpp"
+#include <iostream>
+#include <random>
+
+namespace {
+    void build(option::CommandLineOption& clo) {
+        clo.add_options()
+            .o("v", option::Counter(), "v")
+            .o("o", option::Value<int>().limit(3), "o")
+            .o("f", "f")
+            .l("out", option::Value<std::string>().unlimited(), "out")
+            .l("one=", option::Value<int>(), "one")
+            .l("two ", option::Value<int>().limit(2), "two")
+            .l("color", option::Negatable(true), "color")
+            .a("-O", "--out")
+            .u(option::Value<int>().limit(2), "a")
+            .u.pause()(option::Value<std::string>().limit(2), "p");
+    }
+
+    template <class Tokens>
+    std::string parse_full(const Tokens& tokens) {
+        option::CommandLineOption clo;
+        build(clo);
+        std::vector<const char*> argv;
+        for (const auto& token : tokens) argv.push_back(token.c_str());
+        try {
+            clo.parse(static_cast<int>(argv.size()), argv.data());
+            return clo.map().to_json();
+        }
+        catch (const std::exception& e) {
+            return std::string("E:") + e.what();
+        }
+    }
+
+}
+
+int main() {
+    const char* pool[] = { "-v", "-o", "1", "2", "-f", "--out", "--out=x", "-O", "a", "--one=3", "--one", "--two", "4",
+        "--color", "--no-color", "-", "--", "-5", "7" };
+    std::mt19937 rng(7);
+    for (int run = 0; run < 300; ++run) {
+        option::CommandLineOption clo;
+        build(clo);
+        auto session = clo.parse_editable();
+        for (int step = 0; step < 40; ++step) {
+            const std::size_t size = session.tokens().size();
+            std::size_t first = size != 0 ? rng() % (size + 1) : 0;
+            std::size_t last = first + (first < size ? rng() % std::min<std::size_t>(3, size - first + 1) : 0);
+            if (rng() % 3 == 0) first = last = size;
+            std::vector<std::string> inserted(rng() % 3);
+            for (auto& token : inserted) token = pool[rng() % std::size(pool)];
+            session.edit(first, last, inserted.begin(), inserted.end());
+
+            const auto edited = session.error().empty() ? clo.map().to_json() : "E:" + std::string(session.error());
+            const auto full = parse_full(session.tokens());
+            if (edited != full && ++failures <= 5) {
+                std::cout << "FAILED:";
+                for (const auto& token : session.tokens()) std::cout << " '" << token << "'";
+                std::cout << "\n  parse: " << full << "\n  editable: " << edited << "\n";
+            }
+        }
+    }
+
+    {
+        // 末尾への追加は追加したトークンのみを再解析する
+        option::CommandLineOption clo;
+        build(clo);
+        auto session = clo.parse_editable();
+        for (int i = 0; i < 1000; ++i) session.edit(session.tokens().size(), session.tokens().size(), { "-v" });
+        expect(session.reparsed() == 1, "appending reparses only the appended token");
+        expect(clo.map().use("v").count() == 1000, "appended counters are all applied");
+
+        // 再解析した範囲のoptionが後ろで再び現れるときは合流できず行末まで再解析する
+        session.edit(0, 1, { "-f" });
+        expect(session.reparsed() == 1000, "an edit of an option repeated later reparses to the end of the line");
+    }
+
+    {
+        // 先頭の編集は後ろの区切りで編集前の解析の状態と合流し、編集したトークンのみを再解析する
+        option::CommandLineOption clo;
+        build(clo);
+        auto session = clo.parse_editable();
+        std::vector<std::string> tokens = { "-o", "1", "--two", "4" };
+        for (int i = 0; i < 1000; ++i) tokens.push_back("-v");
+        tokens.push_back("7");
+        session.edit(0, 0, tokens.begin(), tokens.end());
+
+        session.edit(1, 2, { "2" });
+        expect(session.reparsed() == 2, "replacing the argument of the first option reparses only that option");
+        session.edit(0, 0, { "--one=3", "-f" });
+        expect(session.reparsed() == 2, "inserting options at the start reparses only the inserted tokens");
+        session.edit(2, 6, { "--no-color" });
+        expect(session.reparsed() == 1, "replacing options at the start reparses only the replacement");
+        expect(clo.map().to_json() == parse_full(session.tokens()), "the merged parse matches a full parse");
+        expect(clo.map().use("v").count() == 1000 && clo.map().unnamed_options(0).as<int>() == 7, "the options after the merge keep their values");
+
+        // 後ろの名前なしの引数が受け付けられる名前なしオプションが変わり得るときは合流しない
+        session.edit(0, 0, { "8" });
+        expect(session.reparsed() > 1000, "inserting an unnamed argument before later ones reparses to the end");
+        expect(clo.map().to_json() == parse_full(session.tokens()), "the unmerged parse matches a full parse");
+    }
+
+    return report();
+}
@@ -0,0 +1,69 @@
+// 計数optionと否定可能なoptionのテスト
+//   g++ -std=c++20 -I. tests/flag_option_test.cpp && ./a.out
+#include "CommandLineOption.hpp"
+#include "test_util.hpp"
+#include <iostream>
+
+namespace {
+    // 解析のエラーメッセージ(エラーとならないときは空)
+    std::string error_of(option::CommandLineOption& clo, std::initializer_list<const char*> args) {
+        std::vector<const char*> argv(args);
+        try {
+            clo.parse(static_cast<int>(argv.size()), argv.data());
+        }
+        catch (const std::runtime_error& e) {
+            return e.what();
+        }
+        return "";
+    }
+
+    void define(option::CommandLineOption& clo) {
+        clo.add_options()
+            .o("v", option::Counter(), "v")
+            .l("verbose", option::Counter(), "verbose")
+            .l("color", option::Negatable(true), "color")
+            .l("pager", option::Negatable(false), "pager")
+            .l("out", option::Value<std::string>(), "out")
+            .l("no-cache", "no-cache")
+            .a("--colour", "--color");
+    }
+}
+
+int main() {
+    constexpr auto max = std::numeric_limits<std::uint32_t>::max();
+    {
+        // 出現回数は上限で飽和する
+        option::CommandLineOption clo;
+        define(clo);
+        auto marks = clo.map().mark();
+        marks[0].state = max - 1;
+        marks[1].state = max - 1;
+        clo.map().rewind(marks);
+        expect(error_of(clo, { "-v", "-v", "-v", "--verbose", "--verbose" }).empty(), "counters parse");
+        expect(clo.map().use("v").count() == max && clo.map().luse("verbose").count() == max, "counters saturate at the maximum");
+        expect(clo.map().mark()[0].state == max, "a saturated counter is recorded as the maximum");
+    }
+    {
+        // initは出現回数を0に、否定可能なoptionをデフォルト値に戻す
+        option::CommandLineOption clo;
+        define(clo);
+        expect(error_of(clo, { "-v", "--no-colour", "--pager", "--verbose" }).empty(), "flags parse");
+        expect(clo.map().use("v").count() == 1 && !clo.map().luse("color").as<bool>() && clo.map().luse("pager").as<bool>(), "flags take the parsed values");
+        clo.map().init();
+        expect(clo.map().use("v").count() == 0 && clo.map().luse("verbose").count() == 0, "init clears counters");
+        expect(clo.map().luse("color").as<bool>() && !clo.map().luse("pager").as<bool>(), "init restores the negatable defaults");
+        expect(error_of(clo, { "--color", "--no-pager", "--no-color" }).empty() && !clo.map().luse("color").as<bool>() && !clo.map().luse("pager").as<bool>(), "the last of --X and --no-X wins");
+    }
+    {
+        // --no-は否定可能なoptionにのみ一致し、名前がno-から始まるoptionはそのまま一致する
+        option::CommandLineOption clo;
+        define(clo);
+        expect(error_of(clo, { "--no-verbose" }) == "--no-verbose に該当するlong optionは存在しません", "--no- does not negate a counter");
+        expect(error_of(clo, { "--no-out" }) == "--no-out に該当するlong optionは存在しません", "--no- does not negate an option with a value");
+        expect(error_of(clo, { "--no-colors" }) == "--no-colors に該当するlong optionは存在しません", "--no- requires the whole name");
+        expect(error_of(clo, { "--no-" }) == "--no- に該当するlong optionは存在しません", "--no- alone is unknown");
+        expect(error_of(clo, { "--no-cache" }).empty() && clo.map().luse("no-cache"), "an option named no-X matches as is");
+    }
+
+    return report();
+}
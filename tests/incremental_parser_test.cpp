@@ -0,0 +1,72 @@
+// IncrementalParserとOptionMap::parseの解析結果の一致のテスト(ランダムに生成したコマンドラインで比較する)
+//   g++ -std=c++20 -I. tests/incremental_parser_test.cpp && ./a.out
+#include "CommandLineOption.hpp"
+#include "CommandLineOptionIncremental.hpp"
+#include "CommandLineOptionJson.hpp"
+#include "test_util.hpp"
+#include <iostream>
+#include <random>
+
+namespace {
+    void build(option::CommandLineOption& clo, bool pause) {
+        auto ao = clo.add_options();
+        ao.o("v", option::Counter(), "v")
+            .o("o", option::Value<int>().limit(3), "o")
+            .o("f", "f")
+            .l("out", option::Value<std::string>().unlimited(), "out")
+            .l("one=", option::Value<int>(), "one")
+            .l("two ", option::Value<int>().limit(2), "two")
+            .l("color", option::Negatable(true), "color")
+            .a("-O", "--out");
+        ao.u(option::Value<int>().limit(2), "a");
+        if (pause) ao.u.pause()(option::Value<std::string>().limit(2), "p");
+        else ao.u(option::Value<std::string>().unlimited(), "rest");
+    }
+
+    std::string parse_full(bool pause, std::vector<const char*> argv) {
+        option::CommandLineOption clo;
+        build(clo, pause);
+        try {
+            const int offset = clo.parse(static_cast<int>(argv.size()), argv.data());
+            return clo.map().to_json() + std::to_string(offset);
+        }
+        catch (const std::exception& e) {
+            return std::string("E:") + e.what();
+        }
+    }
+
+    std::string parse_incremental(bool pause, const std::vector<const char*>& argv) {
+        option::CommandLineOption clo;
+        build(clo, pause);
+        try {
+            auto parser = clo.parse_incremental();
+            for (auto token : argv) parser.push(token);
+            parser.finish(true);
+            return clo.map().to_json() + std::to_string(parser.stopped() ? parser.offset() : argv.size());
+        }
+        catch (const std::exception& e) {
+            return std::string("E:") + e.what();
+        }
+    }
+}
+
+int main() {
+    const char* pool[] = { "-v", "-o", "1", "2", "-f", "--out", "--out=x", "-O", "a", "--one=3", "--one", "--two", "4",
+        "--color", "--no-color", "-", "--", "---", "-5", "7" };
+    constexpr int total = 20000;
+    std::mt19937 rng(1);
+    for (int i = 0; i < total; ++i) {
+        std::vector<const char*> argv(rng() % 9);
+        for (auto& token : argv) token = pool[rng() % std::size(pool)];
+        const bool pause = rng() % 2 == 0;
+        const auto full = parse_full(pause, argv);
+        const auto incremental = parse_incremental(pause, argv);
+        if (full != incremental && ++failures <= 5) {
+            std::cout << "FAILED:";
+            for (auto token : argv) std::cout << " '" << token << "'";
+            std::cout << (pause ? " (pause)" : "") << "\n  parse: " << full << "\n  incremental: " << incremental << "\n";
+        }
+    }
+
+    return report();
+}
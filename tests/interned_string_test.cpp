@@ -0,0 +1,124 @@
+// InternedStringによる名前と説明の保持のテスト
+//   g++ -std=c++20 -I. tests/interned_string_test.cpp && ./a.out
+#include "CommandLineOption.hpp"
+#include "test_util.hpp"
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace {
+    std::size_t allocations = 0;
+
+    void add_with_local_strings(option::CommandLineOption& clo) {
+        // 自動変数の配列は関数を抜けた後も参照できなければならない
+        const char name[] = "local";
+        const char desc[] = "local description";
+        const char value_name[] = "FILE";
+        clo.add_options().l(std::string_view(name), option::Value<std::string>().name(value_name), std::string_view(desc));
+    }
+
+    constexpr char padded[16] = "padded";
+    constexpr char literal_description[] = "described by a literal";
+    static const char static_name[] = "static-name";
+    static const char static_description[] = "described by a static array";
+}
+
+// literalによる構築はコンパイル時に検証される
+static_assert(option::OptionName::literal("verbose").str().view() == "verbose");
+static_assert(option::LongOptionName::literal("out=").name().str().view() == "out");
+static_assert(option::LongOptionName::literal("out=").arg_pattern() == option::OptionHasValueBase::ARG_PATTERN::ASSIGN);
+
+// 呼び出し元へ展開されるとGCCはoperator newの戻り値をfreeに渡しているとして-Wmismatched-new-deleteを報告するため展開させない
+[[gnu::noinline]] void* operator new(std::size_t size) {
+    ++allocations;
+    if (void* p = std::malloc(size == 0 ? 1 : size)) return p;
+    throw std::bad_alloc();
+}
+[[gnu::noinline]] void operator delete(void* p) noexcept { std::free(p); }
+[[gnu::noinline]] void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+int main() {
+    {
+        option::CommandLineOption clo;
+        add_with_local_strings(clo);
+        // 自動変数の領域を上書きする
+        volatile char scratch[64];
+        for (auto& c : scratch) c = 'x';
+
+        const auto description = clo.description();
+        expect(description.find("local description") != std::string::npos, "description of a local array is copied");
+        expect(description.find("--local[ |=]<FILE>") != std::string::npos, "value name of a local array is copied");
+    }
+    {
+        // 大きさを指定した配列の余りのナル文字は含めない
+        static const char d[16] = "hi";
+        const option::InternedString s = d;
+        expect(s.view() == "hi" && s.view().size() == 2, "padding of a sized array is dropped");
+        constexpr auto l = option::InternedString::literal(padded);
+        expect(l.view() == "padded" && l.view().data() == padded, "literal refers to the constant without copying");
+    }
+    {
+        option::CommandLineOption clo;
+        clo.add_options()
+            .l(padded, "padded name")
+            .o("v", option::InternedString::literal("verbose"));
+        const char* argv[] = { "--padded", "-v" };
+        clo.parse(2, argv);
+        expect(bool(clo.map().luse("padded")), "option name of a sized array stops at the first NUL");
+        expect(clo.description().find("verbose") != std::string::npos, "literal description");
+    }
+    {
+        // 定数式でないconst char配列も実行時に検証してプールに複製する
+        option::CommandLineOption clo;
+        clo.add_options().l(static_name, static_description).l(static_name + std::string("-value"), option::Value<int>(), static_description);
+        const char* argv[] = { "--static-name" };
+        clo.parse(1, argv);
+        expect(bool(clo.map().luse("static-name")), "a static const char array names an option");
+        expect(clo.description().find("described by a static array") != std::string::npos, "a static const char array describes an option");
+        static const char bad_name[] = "-bad";
+        try {
+            clo.add_options().l(bad_name, "bad");
+            expect(false, "an invalid name in an array is rejected at run time");
+        }
+        catch (const std::invalid_argument&) {}
+    }
+    {
+        // literalで指定した説明はプールに複製せずに定数式の文字列を参照する
+        const auto before = allocations;
+        constexpr auto d = option::OptionDescription::literal(literal_description);
+        expect(allocations == before && d.str().view().data() == literal_description, "a literal description is not allocated or copied");
+
+        option::CommandLineOption clo;
+        clo.add_options().l("first", "x").l(option::OptionName::literal("second"), option::OptionDescription::literal(literal_description));
+        expect(clo.map().schema().option(1)->description().data() == literal_description, "options keep the literal description");
+
+        // 実行時の文字列はプールに複製する
+        const std::string runtime = "described at run time";
+        const option::OptionDescription r = runtime;
+        expect(r.str().view() == runtime && r.str().view().data() != runtime.data(), "a runtime description is interned");
+    }
+    {
+        // 80個のoptionの定義と解析で確保する回数(改修前は336回)
+        std::vector<std::string> names;
+        for (int i = 0; i < 80; ++i) names.push_back("option-name-" + std::to_string(i));
+        const auto before = allocations;
+        {
+            option::CommandLineOption clo;
+            auto adder = clo.add_options();
+            for (const auto& name : names) adder.l(name, "オプションの説明です。これは長い説明文です");
+            const char* argv[] = { "--option-name-3", "--option-name-70" };
+            clo.parse(2, argv);
+        }
+        const auto count = allocations - before;
+        expect(count <= 2 * names.size(), "defining 80 options allocates at most twice per option, got " + std::to_string(count));
+    }
+    {
+        // 同じ内容の文字列は1度だけ複製される
+        const std::string a = "shared", b = "shared";
+        expect(option::InternedString(a).view().data() == option::InternedString(b).view().data(), "equal strings share storage");
+    }
+
+    return report();
+}
@@ -0,0 +1,96 @@
+// JsonWriterとto_json、json_schemaのテスト
+//   g++ -std=c++20 -I. tests/json_test.cpp && ./a.out
+#include "CommandLineOption.hpp"
+#include "CommandLineOptionJson.hpp"
+#include "test_util.hpp"
+#include <iostream>
+
+namespace {
+    std::string escaped(std::string_view str) {
+        std::string out;
+        option::JsonWriter::escape(out, str);
+        return out;
+    }
+}
+
+int main() {
+    {
+        // エスケープの対象となる文字
+        expect(escaped("") == "\"\"", "an empty string");
+        expect(escaped("a\"b\\c") == "\"a\\\"b\\\\c\"", "quote and backslash");
+        expect(escaped("\b\f\n\r\t") == "\"\\b\\f\\n\\r\\t\"", "short escapes");
+        expect(escaped(std::string_view("\x00\x01\x1f\x7f", 4)) == "\"\\u0000\\u0001\\u001f\x7f\"", "control bytes use \\u00XX and DEL is copied");
+        expect(escaped("\xc3\xa9\xe3\x81\x82\xf0\x9f\x98\x80") == "\"\xc3\xa9\xe3\x81\x82\xf0\x9f\x98\x80\"", "valid UTF-8 is copied");
+        // 不正なUTF-8は1バイトごとに置き換える
+        expect(escaped("a\xff" "b") == "\"a\\ufffdb\"", "0xFF is replaced");
+        expect(escaped("\xc0\xaf") == "\"\\ufffd\\ufffd\"", "an overlong encoding is replaced");
+        expect(escaped("\xed\xa0\x80") == "\"\\ufffd\\ufffd\\ufffd\"", "a surrogate is replaced");
+        expect(escaped("\xf4\x90\x80\x80") == "\"\\ufffd\\ufffd\\ufffd\\ufffd\"", "a code point above U+10FFFF is replaced");
+        expect(escaped("\xe3\x81") == "\"\\ufffd\\ufffd\"", "a truncated sequence is replaced");
+    }
+    {
+        // SSE2で16バイトずつ検査するときの境界の前後の位置
+        const std::pair<std::string, std::string> cases[] = {
+            { "\"", "\\\"" }, { "\\", "\\\\" }, { "\x1f", "\\u001f" }, { "\n", "\\n" },
+            { "\xff", "\\ufffd" }, { "\xc3\xa9", "\xc3\xa9" }, { "\xe3\x81\x82", "\xe3\x81\x82" },
+        };
+        for (const auto& [raw, expected] : cases) {
+            for (std::size_t length = 0; length <= 40; ++length) {
+                for (std::size_t pos = 0; pos <= length; ++pos) {
+                    const std::string prefix(pos, 'a'), suffix(length - pos, 'b');
+                    if (escaped(prefix + raw + suffix) != "\"" + prefix + expected + suffix + "\"") {
+                        expect(false, "escape of byte " + std::to_string(static_cast<unsigned char>(raw[0])) + " at " + std::to_string(pos) + " of " + std::to_string(length));
+                    }
+                }
+            }
+        }
+    }
+    // 解析結果
+    auto define = [](option::CommandLineOption& clo) {
+        clo.add_options()
+            .o("v", option::Counter(), "v")
+            .l("color", option::Negatable(true), "color")
+            .l("s", option::Value<std::string>().unlimited(), "s")
+            .l("d", option::Value<double>().limit(3), "d")
+            .u(option::Value<int>().name("n"), "n");
+    };
+    {
+        option::CommandLineOption clo;
+        define(clo);
+        std::vector<const char*> argv = { "-v", "-v", "--no-color", "--s", "a\"b\x01\xff", "--d", "inf", "nan", "1.5", "7" };
+        clo.parse(static_cast<int>(argv.size()), argv.data());
+        expect(clo.map().to_json() ==
+            "{\"options\":[{\"index\":0,\"name\":\"-v\",\"value\":2},{\"index\":1,\"name\":\"--color\",\"value\":false},"
+            "{\"index\":2,\"name\":\"--s\",\"arg_pattern\":[\"space\",\"assign\"],\"value\":[\"a\\\"b\\u0001\\ufffd\"]},"
+            "{\"index\":3,\"name\":\"--d\",\"arg_pattern\":[\"space\",\"assign\"],\"value\":[null,null,1.5]}],\"unnamed\":[[7]]}",
+            "to_json: counts, negatables, escaping, inf/nan as null, positionals");
+    }
+    {
+        option::CommandLineOption clo;
+        define(clo);
+        std::vector<const char*> argv = { "--s", "x", "--color" };
+        clo.parse(static_cast<int>(argv.size()), argv.data());
+        expect(clo.map().to_json() ==
+            "{\"options\":[{\"index\":1,\"name\":\"--color\",\"value\":true},"
+            "{\"index\":2,\"name\":\"--s\",\"arg_pattern\":[\"space\",\"assign\"],\"value\":[\"x\"]}],\"unnamed\":[[]]}",
+            "to_json: unused options are omitted");
+    }
+    {
+        // optionの定義
+        option::CommandLineOption clo;
+        clo.add_options()
+            .o("v", option::Counter(), "v")
+            .l("color", option::Negatable(true), "\"color\"\n")
+            .l("d", option::Value<double>(0.5).limit(3).required(1).name("ratio"), "d")
+            .u(option::Value<int>().name("n"), "n")
+            .a("-c", "--color");
+        expect(clo.map().json_schema() ==
+            "{\"options\":[{\"name\":\"-v\",\"aliases\":[],\"description\":\"v\",\"kind\":\"count\"},"
+            "{\"name\":\"--color\",\"aliases\":[\"-c\"],\"description\":\"\\\"color\\\"\\n\",\"kind\":\"negatable\",\"default\":true},"
+            "{\"name\":\"--d\",\"aliases\":[],\"description\":\"d\",\"kind\":\"value\",\"arg_pattern\":[\"space\",\"assign\"],\"type\":\"double\",\"value_name\":\"ratio\",\"limit\":3,\"required\":1,\"default\":[0.5],\"constraint\":false},"
+            "{\"name\":null,\"aliases\":[],\"description\":\"n\",\"kind\":\"unnamed\",\"pause\":false,\"type\":\"int\",\"value_name\":\"n\",\"limit\":1,\"required\":0,\"default\":[],\"constraint\":false}]}",
+            "json_schema: kinds, aliases, escaping and value definitions");
+    }
+
+    return report();
+}
@@ -0,0 +1,98 @@
+// Value::one_ofによる許可された値の集合のテスト
+//   g++ -std=c++20 -I. tests/one_of_test.cpp && ./a.out
+#include "CommandLineOption.hpp"
+#include "test_util.hpp"
+#include <cmath>
+#include <iostream>
+#include <unordered_map>
+
+namespace {
+    template <class E, class F>
+    bool throws(F&& f) {
+        try {
+            f();
+        }
+        catch (const E&) {
+            return true;
+        }
+        return false;
+    }
+
+    // OneOfのハッシュ表がスロットに格納するハッシュ値の上位32ビット
+    std::uint64_t tag(std::string_view str) {
+        return (static_cast<std::uint64_t>(std::hash<std::string_view>{}(str)) * 0x9E3779B97F4A7C15ull) >> 32;
+    }
+}
+
+int main() {
+    {
+        // NaNは許可する値にできず、重複は取り除かれる
+        const double nan = std::nan("");
+        expect(throws<std::invalid_argument>([&] { option::OneOf<double>(std::vector<double>{ 1.0, nan }); }), "NaN in the allowed values is rejected");
+        expect(throws<std::invalid_argument>([] { option::OneOf<int>(std::vector<int>{}); }), "an empty set is rejected");
+        const option::OneOf<double> doubles(std::vector<double>{ 2.5, 1.0, 2.5, -0.0, 0.0 });
+        expect(doubles.size() == 3 && doubles.contains(0.0) && doubles.contains(-0.0) && !doubles.contains(nan), "duplicates are removed and NaN is never contained");
+        const option::OneOf<std::string> strings(std::vector<std::string>{ "b", "a", "b", "", "a" });
+        expect(strings.size() == 3 && strings.contains("") && strings.contains("b") && !strings.contains("c"), "duplicate strings are removed");
+
+        const std::vector<int> values = { 3, 1, 4, 1, 5, 9, 2, 6, 5, 3, 5, 8, 9, 7, 9 };
+        const option::OneOf<int> ints(values);
+        expect(ints.size() == 9, "duplicate numbers are removed");
+        std::vector<int> queries(20, 5);
+        queries[17] = 0;
+        expect(ints.find_missing(queries) == 17 && ints.find_missing(std::span<const int>(queries).first(17)) == 17, "find_missing reports the first value outside the set after the unrolled blocks");
+    }
+    {
+        // ハッシュ値の上位32ビットが一致する異なる文字列を見つけ、両方を含む集合と片方のみの集合で区別できることを確かめる
+        std::unordered_map<std::uint64_t, std::string> seen;
+        std::pair<std::string, std::string> collision;
+        for (std::size_t i = 0; collision.first.empty(); ++i) {
+            auto key = "sku-" + std::to_string(i);
+            auto [itr, inserted] = seen.emplace(tag(key), key);
+            if (!inserted) collision = { itr->second, key };
+        }
+        const option::OneOf<std::string> both(std::vector<std::string>{ collision.first, collision.second });
+        const option::OneOf<std::string> first(std::vector<std::string>{ collision.first });
+        const option::OneOf<std::string> second(std::vector<std::string>{ collision.second });
+        expect(both.contains(collision.first) && both.contains(collision.second), "strings whose hash tags collide are both contained");
+        expect(!first.contains(collision.second) && !second.contains(collision.first), "a colliding hash tag alone does not match");
+
+        // 探索の衝突が多い集合でも含まれる値と含まれない値を区別する
+        std::vector<std::string> keys;
+        for (int i = 0; i < 5000; ++i) keys.push_back("k" + std::to_string(i));
+        const option::OneOf<std::string> many(keys);
+        bool all = true;
+        for (int i = 0; i < 10000; ++i) all &= many.contains("k" + std::to_string(i)) == (i < 5000);
+        expect(all, "a large string set contains exactly its values");
+    }
+    {
+        // nullptrの集合とデフォルト引数を含まない集合は設定できない
+        expect(throws<std::invalid_argument>([] { option::Value<int>().one_of(std::shared_ptr<const option::OneOf<int>>()); }), "a null set is rejected");
+        expect(throws<std::logic_error>([] { option::Value<int>(4).one_of({ 1, 2, 3 }); }), "a default outside the set is a logic_error");
+        expect(!throws<std::logic_error>([] { option::Value<int>(2).one_of({ 1, 2, 3 }); }), "a default inside the set is accepted");
+    }
+    {
+        // 構築済みの集合は複数のoptionで共有し、集合外の引数は検証のエラーとなる
+        auto regions = std::make_shared<const option::OneOf<std::string>>(std::vector<std::string>{ "eu", "us", "jp" });
+        option::CommandLineOption clo;
+        clo.add_options()
+            .l("src", option::Value<std::string>().one_of(regions), "src")
+            .l("dst", option::Value<std::string>().one_of(regions).unlimited(), "dst");
+        const char* ok[] = { "--src", "eu", "--dst", "us", "--dst", "jp" };
+        clo.parse(6, ok);
+        expect(regions.use_count() == 3, "options share the prebuilt set");
+
+        option::CommandLineOption clo2;
+        clo2.add_options().l("dst", option::Value<std::string>().one_of(regions).unlimited(), "dst");
+        const char* bad[] = { "--dst", "us", "--dst", "cn" };
+        try {
+            clo2.parse(4, bad);
+            expect(false, "a value outside the set throws");
+        }
+        catch (const std::runtime_error& e) {
+            expect(std::string_view(e.what()).find("cn は許可された値ではありません") != std::string_view::npos, "the error names the value outside the set");
+        }
+    }
+
+    return report();
+}
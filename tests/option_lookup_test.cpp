@@ -0,0 +1,88 @@
+// OptionLookupによるoption名の検索のテスト
+//   g++ -std=c++20 -I. tests/option_lookup_test.cpp && ./a.out
+#include "CommandLineOption.hpp"
+#include "test_util.hpp"
+#include <iostream>
+
+namespace {
+    using option::OptionLookup;
+
+    // 索引の全ての名前がその名前の一覧として見つかり、索引に無い名前は見つからないこと
+    bool finds_all(const OptionLookup& lookup, const OptionLookup::Index& index, std::initializer_list<std::string_view> missing) {
+        for (std::size_t i = 0; i < index.size(); ++i) {
+            const auto found = lookup.find(index.key(i));
+            if (found.empty() || *found.begin() != *index.entries(i).begin()) return false;
+        }
+        for (auto key : missing) {
+            if (!lookup.find(key).empty()) return false;
+        }
+        return true;
+    }
+
+    // 名前の一覧から索引を構築する(名前はプールに格納して索引より長く保ち、optionは各名前で別のものとする)
+    OptionLookup::Index index_of(const std::vector<std::string>& names) {
+        OptionLookup::Index index;
+        for (const auto& name : names) index.add(option::InternedString::intern(name), std::make_shared<option::LongOption>(""));
+        return index;
+    }
+
+    std::vector<std::string> numbered(std::size_t n) {
+        std::vector<std::string> names;
+        for (std::size_t i = 0; i < n; ++i) names.push_back("option-" + std::to_string(i));
+        return names;
+    }
+}
+
+int main() {
+    {
+        // linear_limit個までは線形探索、それを超えるとハッシュ表
+        const auto names16 = numbered(OptionLookup::linear_limit), names17 = numbered(OptionLookup::linear_limit + 1);
+        const auto index16 = index_of(names16), index17 = index_of(names17);
+        OptionLookup lookup16, lookup17;
+        lookup16.build(index16);
+        lookup17.build(index17);
+        expect(lookup16.strategy() == OptionLookup::STRATEGY::LINEAR && lookup16.size() == 16, "16 names use the linear search");
+        expect(lookup17.strategy() == OptionLookup::STRATEGY::HASH && lookup17.size() == 17, "17 names use the hash table");
+        expect(finds_all(lookup16, index16, { "option-16", "option", "" }), "the linear search finds every name");
+        expect(finds_all(lookup17, index17, { "option-17", "option", "" }), "the hash table finds every name");
+    }
+    {
+        // 先頭と末尾の4バイトと長さが一致する(署名が重複する)名前も文字列で区別する
+        const auto index = index_of({ "abcdXXwxyz", "abcdYYwxyz", "output", "input", "verbose", "jobs", "color", "quiet" });
+        OptionLookup lookup;
+        lookup.build(index);
+        expect(lookup.strategy() == OptionLookup::STRATEGY::LINEAR, "a single signature collision keeps the linear search");
+        expect(finds_all(lookup, index, { "abcdZZwxyz", "abcdXXwxy", "abcdwxyz" }), "names with colliding signatures are told apart");
+    }
+    {
+        // 署名の重複が名前の数の1/4を超えるときはハッシュ表
+        std::vector<std::string> names;
+        for (char c = 'A'; c < 'A' + 8; ++c) names.push_back(std::string("abcd") + c + "wxyz");
+        const auto index = index_of(names);
+        OptionLookup lookup;
+        lookup.build(index);
+        expect(lookup.strategy() == OptionLookup::STRATEGY::HASH, "many signature collisions fall back to the hash table");
+        expect(finds_all(lookup, index, { "abcdZwxyz" }), "the fallback finds every name");
+    }
+    {
+        // 4バイト未満の名前と空の名前
+        const auto index = index_of({ "a", "ab", "abc", "abcd", "b" });
+        OptionLookup lookup;
+        lookup.build(index);
+        expect(lookup.strategy() == OptionLookup::STRATEGY::LINEAR, "short names use the linear search");
+        expect(finds_all(lookup, index, { "", "c", "ba", "abd", "abcde" }), "names shorter than 4 bytes are found exactly");
+
+        const auto with_empty = index_of({ "", "a", "ab" });
+        lookup.build(with_empty);
+        expect(finds_all(lookup, with_empty, { "b", "abc" }), "an empty name is found only by the empty key");
+    }
+    {
+        // 空の索引
+        const OptionLookup::Index index;
+        OptionLookup lookup;
+        lookup.build(index);
+        expect(lookup.size() == 0 && lookup.find("").empty() && lookup.find("a").empty(), "an empty index finds nothing");
+    }
+
+    return report();
+}
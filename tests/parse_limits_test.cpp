@@ -0,0 +1,136 @@
+// ParseLimitsによる解析の資源の上限のテスト
+//   g++ -std=c++20 -I. tests/parse_limits_test.cpp && ./a.out
+#include "CommandLineOption.hpp"
+#include "CommandLineOptionEditable.hpp"
+#include "test_util.hpp"
+#include <iostream>
+
+namespace {
+    void build(option::CommandLineOption& clo, std::size_t tokens, std::size_t bytes, std::size_t values_per_option, std::size_t values) {
+        clo.add_options()
+            .o("o", option::Value<int>().unlimited(), "o")
+            .l("x", option::Value<std::string>().unlimited(), "x")
+            .l("f", "f")
+            .u(option::Value<int>().unlimited().name("n"), "n");
+        option::ParseLimits limits;
+        limits.tokens = tokens;
+        limits.bytes = bytes;
+        limits.values_per_option = values_per_option;
+        limits.values = values;
+        clo.set_limits(limits);
+    }
+
+    // 解析のエラーメッセージ(エラーとならないときは空)
+    std::string error_of(option::CommandLineOption& clo, std::initializer_list<const char*> args) {
+        std::vector<const char*> argv(args);
+        try {
+            clo.parse(static_cast<int>(argv.size()), argv.data());
+        }
+        catch (const std::runtime_error& e) {
+            return e.what();
+        }
+        return "";
+    }
+
+    // 逐次的な解析でエラーとなったトークンの位置とメッセージ(finishでエラーとなったときの位置はトークンの数)
+    std::pair<std::size_t, std::string> incremental_error_of(option::CommandLineOption& clo, std::initializer_list<const char*> args) {
+        auto parser = clo.parse_incremental();
+        std::size_t i = 0;
+        try {
+            for (auto token : args) {
+                parser.push(token);
+                ++i;
+            }
+            parser.finish();
+        }
+        catch (const std::runtime_error& e) {
+            return { i, e.what() };
+        }
+        return { i, "" };
+    }
+
+    const std::string too_many_tokens = "コマンドライン引数の数が上限 5 を超えています";
+    const std::string too_many_bytes = "コマンドライン引数の合計バイト数が上限 20 を超えています";
+    const std::string too_many_x = "option --x の引数の数が上限 3 を超えています";
+    const std::string too_many_o = "option -o の引数の数が上限 3 を超えています";
+    const std::string too_many_n = "名前なしオプション #1 <n> の引数の数が上限 3 を超えています";
+    const std::string too_many_values = "引数の合計数が上限 4 を超えています";
+}
+
+int main() {
+    constexpr std::size_t unlimited = option::ParseLimits::UNLIMITED;
+    {
+        // トークンの数とバイト数は上限ちょうどまで受け付け、解析を始める前に検査する
+        option::CommandLineOption clo;
+        build(clo, 5, 20, unlimited, unlimited);
+        expect(error_of(clo, { "--f", "--f", "--f", "--f", "--f" }).empty(), "tokens up to the limit are accepted");
+        expect(error_of(clo, { "--f", "--f", "--f", "--f", "--f", "--f" }) == too_many_tokens, "one token over the limit is rejected");
+        expect(clo.map().budget_usage().tokens == 6 && clo.map().budget_usage().values == 0, "the token limit stops the parse before any value is stored");
+        expect(error_of(clo, { "--x=0123456789012345" }).empty(), "bytes up to the limit are accepted");
+        expect(error_of(clo, { "--x=01234567890123456" }) == too_many_bytes, "one byte over the limit is rejected");
+    }
+    {
+        // 1つのoptionの引数の数は記載パターンによらず上限の位置で打ち切る
+        option::CommandLineOption clo;
+        build(clo, unlimited, unlimited, 3, unlimited);
+        expect(error_of(clo, { "-o", "1", "-o", "2", "-o", "3" }).empty(), "short option values up to the limit are accepted");
+        clo.map().init();
+        expect(error_of(clo, { "-o", "1", "-o", "2", "-o", "3", "-o", "4" }) == too_many_o, "a fourth short option value is rejected");
+        expect(clo.map().use("o").as<std::vector<int>>() == std::vector<int>{ 1, 2, 3 }, "short option values stop at the limit");
+        clo.map().init();
+        expect(error_of(clo, { "--x=a", "--x=b", "--x=c", "--x=d" }) == too_many_x, "a fourth --x= value is rejected");
+        expect(clo.map().luse("x").as<std::vector<std::string>>().size() == 3, "--x= values stop at the limit");
+        clo.map().init();
+        expect(error_of(clo, { "--x", "a", "b", "c", "d" }) == too_many_x, "a fourth value after --x is rejected");
+        expect(clo.map().luse("x").as<std::vector<std::string>>() == std::vector<std::string>{ "a", "b", "c" }, "values after --x stop at the limit");
+        clo.map().init();
+        expect(error_of(clo, { "1", "2", "3", "4" }) == too_many_n, "a fourth positional value names the slot");
+        expect(clo.map().unnamed_options().as<std::vector<int>>() == std::vector<int>{ 1, 2, 3 }, "positional values stop at the limit");
+    }
+    {
+        // 全optionの引数の合計数は上限を超えた引数の位置で打ち切る
+        option::CommandLineOption clo;
+        build(clo, unlimited, unlimited, unlimited, 4);
+        expect(error_of(clo, { "-o", "1", "--x=a", "--x", "b", "7" }).empty(), "values up to the total limit are accepted");
+        clo.map().init();
+        expect(error_of(clo, { "-o", "1", "--x=a", "--x", "b", "c", "7" }) == too_many_values, "a fifth value is rejected");
+        expect(clo.map().use("o").as<std::vector<int>>().size() == 1 && clo.map().luse("x").as<std::vector<std::string>>().size() == 3 && !clo.map().unnamed_options(), "the total limit stops at the fifth value");
+    }
+    {
+        // 逐次的な解析はトークンの数とバイト数の超過をそのトークンのpushで、引数の超過を区切りが確定したときに報告する
+        option::CommandLineOption tokens;
+        build(tokens, 5, 20, unlimited, unlimited);
+        expect(incremental_error_of(tokens, { "--f", "--f", "--f", "--f", "--f", "--f" }) == std::pair<std::size_t, std::string>(5, too_many_tokens), "the sixth push exceeds the token limit");
+        option::CommandLineOption bytes;
+        build(bytes, 5, 20, unlimited, unlimited);
+        expect(incremental_error_of(bytes, { "--f", "--x=012345678901234567" }) == std::pair<std::size_t, std::string>(1, too_many_bytes), "the push over the byte limit fails");
+        option::CommandLineOption per_option;
+        build(per_option, unlimited, unlimited, 3, unlimited);
+        expect(incremental_error_of(per_option, { "--x", "a", "b", "c", "d", "--f" }) == std::pair<std::size_t, std::string>(5, too_many_x), "the per-option limit fails when --f ends the values");
+        option::CommandLineOption positional;
+        build(positional, unlimited, unlimited, 3, unlimited);
+        expect(incremental_error_of(positional, { "1", "2", "3", "4" }) == std::pair<std::size_t, std::string>(3, too_many_n), "the fourth positional push fails");
+        option::CommandLineOption values;
+        build(values, unlimited, unlimited, unlimited, 4);
+        expect(incremental_error_of(values, { "-o", "1", "-o", "2", "--x", "a", "b", "c" }) == std::pair<std::size_t, std::string>(8, too_many_values), "the total limit fails at finish");
+        expect(values.map().use("o").as<std::vector<int>>().size() == 2 && values.map().luse("x").as<std::vector<std::string>>().size() == 2, "the incremental parse stores values up to the total limit");
+    }
+    {
+        // 編集による解析は上限を超えた編集でエラーとなり、上限の範囲に戻す編集でエラーが解消する
+        option::CommandLineOption clo;
+        build(clo, 5, unlimited, 3, unlimited);
+        auto session = clo.parse_editable();
+        session.edit(0, 0, { "--x", "a", "b", "c" });
+        expect(session.error().empty(), "an edit within the limits parses");
+        session.edit(4, 4, { "d" });
+        expect(session.error() == too_many_x && clo.map().luse("x").as<std::vector<std::string>>().size() == 3, "an edit over the per-option limit fails at the fourth value");
+        session.edit(4, 5, {});
+        expect(session.error().empty() && clo.map().luse("x").as<std::vector<std::string>>().size() == 3, "removing the extra value clears the error");
+        session.edit(4, 4, { "--f", "--f" });
+        expect(session.error() == too_many_tokens, "an edit over the token limit fails");
+        session.edit(4, 6, { "--f" });
+        expect(session.error().empty() && clo.map().luse("f"), "an edit back to the token limit parses");
+    }
+
+    return report();
+}
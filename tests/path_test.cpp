@@ -0,0 +1,80 @@
+// Value::pathによるファイルパスの検査のテスト
+//   g++ -std=c++20 -I. tests/path_test.cpp -lpthread && ./a.out
+#include "CommandLineOption.hpp"
+#include "CommandLineOptionPath.hpp"
+#include "test_util.hpp"
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <unistd.h>
+
+namespace {
+    // 解析のエラーメッセージ(エラーとならないときは空)
+    std::string error_of(option::CommandLineOption& clo, std::initializer_list<std::string> args) {
+        std::vector<const char*> argv;
+        for (const auto& arg : args) argv.push_back(arg.c_str());
+        try {
+            clo.map().init();
+            clo.parse(static_cast<int>(argv.size()), argv.data());
+        }
+        catch (const std::runtime_error& e) {
+            return e.what();
+        }
+        return "";
+    }
+}
+
+int main() {
+    using CHECK = option::PathCheck::CHECK;
+    namespace fs = std::filesystem;
+    const fs::path root = fs::temp_directory_path() / ("path_test_" + std::to_string(::getpid()));
+    fs::create_directories(root / "dir");
+    std::ofstream(root / "file") << "x";
+    const std::string dir = (root / "dir").string(), file = (root / "file").string(), missing = (root / "missing").string();
+    const std::string created = (root / "dir" / "new").string(), orphan = (root / "missing" / "new").string();
+
+    {
+        option::CommandLineOption clo;
+        clo.add_options()
+            .l("exists", option::Value<std::string>().path(CHECK::EXISTS).unlimited(), "exists")
+            .l("dir", option::Value<std::string>().path(CHECK::DIRECTORY), "dir")
+            .l("in", option::Value<std::string>().path(CHECK::READABLE), "in")
+            .l("out", option::Value<std::string>().path(CHECK::WRITABLE), "out");
+
+        expect(error_of(clo, { "--exists", file, dir, "--dir", dir, "--in", file, "--out", file }).empty(), "existing paths pass every check");
+        expect(error_of(clo, { "--exists", file, missing }) == "option --exists に対する" + missing + " は存在しません", "EXISTS reports the missing path");
+        expect(error_of(clo, { "--dir", file }) == "option --dir に対する" + file + " はディレクトリではありません", "DIRECTORY rejects a file");
+        expect(error_of(clo, { "--dir", missing }) == "option --dir に対する" + missing + " は存在しません", "DIRECTORY requires the path to exist");
+        expect(error_of(clo, { "--in", missing }) == "option --in に対する" + missing + " は存在しません", "READABLE requires the path to exist");
+        expect(error_of(clo, { "--out", created }).empty(), "WRITABLE accepts a path to be created in a writable directory");
+        expect(error_of(clo, { "--out", orphan }) == "option --out に対する" + orphan + " は書き込むことができません", "WRITABLE checks the parent of a path to be created");
+        expect(error_of(clo, { "--in", missing, "--out", orphan }) == "option --in に対する" + missing + " は存在しません", "errors are reported in definition order");
+
+        // 権限による拒否はrootでは検査できない
+        if (::geteuid() != 0) {
+            fs::permissions(root / "file", fs::perms::none);
+            fs::permissions(root / "dir", fs::perms::owner_read | fs::perms::owner_exec);
+            expect(error_of(clo, { "--in", file }) == "option --in に対する" + file + " は読み込むことができません", "READABLE rejects an unreadable file");
+            expect(error_of(clo, { "--out", file }) == "option --out に対する" + file + " は書き込むことができません", "WRITABLE rejects an unwritable file");
+            expect(error_of(clo, { "--out", created }) == "option --out に対する" + created + " は書き込むことができません", "WRITABLE rejects a path in an unwritable directory");
+            fs::permissions(root / "file", fs::perms::owner_read | fs::perms::owner_write);
+            fs::permissions(root / "dir", fs::perms::owner_all);
+        }
+    }
+    {
+        // デフォルト引数も検査する
+        option::CommandLineOption clo;
+        clo.add_options().l("workdir", option::Value<std::string>(missing).path(CHECK::DIRECTORY), "workdir");
+        expect(error_of(clo, {}) == "option --workdir に対する" + missing + " は存在しません", "a default value is checked");
+        expect(error_of(clo, { "--workdir", dir }).empty(), "a given value replaces the default");
+    }
+    {
+        // 名前なしオプションの検査
+        option::CommandLineOption clo;
+        clo.add_options().u(option::Value<std::string>().path(CHECK::EXISTS).unlimited(), "files");
+        expect(error_of(clo, { file, missing }) == "名前なしオプションに対する引数 " + missing + " は存在しません", "positional paths are checked");
+    }
+
+    fs::remove_all(root);
+    return report();
+}
@@ -0,0 +1,111 @@
+// Patternの照合とstd::regex_matchの一致およびパターンのエラーのテスト
+//   g++ -std=c++20 -I. tests/pattern_test.cpp && ./a.out
+#include "CommandLineOptionPattern.hpp"
+#include "test_util.hpp"
+#include <iostream>
+#include <optional>
+#include <random>
+#include <regex>
+
+namespace {
+    // std::regexでも同じ意味となる構文のみから無作為なパターンを作る
+    // (std::regexはバックトラックで照合するため、グループには上限のない繰り返しを付けない)
+    std::string random_pattern(std::mt19937& rng, int depth) {
+        static const char* atoms[] = { "a", "b", "c", ".", "[ab]", "[^a]", "[a-c]", "\\d", "\\w", "\\s", "\\D", "\\W", "\\S", "\\.", "\\n", "[\\n.]", "1" };
+        static const char* repeats[] = { "", "", "", "?", "{2}", "{0,2}", "*", "+", "{1,}" };
+        std::string pattern;
+        const int length = 1 + static_cast<int>(rng() % 3);
+        for (int i = 0; i < length; ++i) {
+            if (depth > 0 && rng() % 4 == 0) {
+                pattern += "(" + random_pattern(rng, depth - 1);
+                if (rng() % 2 == 0) pattern += "|" + random_pattern(rng, depth - 1);
+                pattern += ")";
+                pattern += repeats[rng() % 6];
+            }
+            else {
+                pattern += atoms[rng() % std::size(atoms)];
+                pattern += repeats[rng() % std::size(repeats)];
+            }
+        }
+        return pattern;
+    }
+
+    std::string random_input(std::mt19937& rng) {
+        static const char chars[] = { 'a', 'b', 'c', '1', '.', '_', ' ', '\n', '\r' };
+        std::string input(rng() % 7, ' ');
+        for (auto& c : input) c = chars[rng() % std::size(chars)];
+        return input;
+    }
+
+    std::string error_of(std::string_view source) {
+        try {
+            option::Pattern pattern(source);
+        }
+        catch (const std::invalid_argument& e) {
+            return e.what();
+        }
+        return "";
+    }
+}
+
+int main() {
+    {
+        // 無作為なパターンと入力でstd::regex_matchと照合の結果が一致する
+        std::mt19937 rng(2028);
+        int mismatches = 0;
+        for (int round = 0; round < 1000; ++round) {
+            const auto source = random_pattern(rng, 2);
+            std::optional<option::Pattern> pattern;
+            try {
+                pattern.emplace(source);
+            }
+            catch (const std::invalid_argument&) {
+                // 状態数の上限を超えるものは比較しない
+                continue;
+            }
+            const std::regex regex(source);
+            for (int i = 0; i < 20; ++i) {
+                const auto input = random_input(rng);
+                if (pattern->match(input) != std::regex_match(input, regex) && ++mismatches <= 5) {
+                    std::cout << "mismatch: /" << source << "/ [" << input << "]\n";
+                }
+            }
+        }
+        expect(mismatches == 0, "Pattern agrees with std::regex_match on random patterns");
+    }
+    {
+        // 「.」は改行文字には一致しないが、U+2028とU+2029はUTF-8の3バイトのそれぞれに一致する
+        const option::Pattern dot(".");
+        expect(!dot.match("\n") && !dot.match("\r") && !std::regex_match("\n", std::regex(".")), "'.' does not match line terminators");
+        const option::Pattern three(".{3}");
+        for (const char* separator : { "\xE2\x80\xA8", "\xE2\x80\xA9" }) {
+            expect(!dot.match(separator) && three.match(separator), "'.' matches each byte of U+2028 and U+2029");
+            expect(std::regex_match(separator, std::regex(".{3}")), "std::regex over char agrees on U+2028 and U+2029");
+        }
+        expect(!std::regex_match(L"\u2028", std::wregex(L".")), "only std::wregex excludes U+2028 from '.'");
+    }
+    {
+        // 不正なパターンは不正な文字の位置(1始まり、末尾の不足は長さ+1)を報告する
+        const std::pair<const char*, int> malformed[] = {
+            { "*a", 1 }, { "a)", 2 }, { "(ab", 4 }, { "[ab", 4 }, { "[b-a]", 3 }, { "\\q", 2 }, { "a{2,1}", 6 },
+            { "a{1001}", 3 }, { "a{", 3 }, { "a|?", 3 }, { "\\", 2 },
+        };
+        for (const auto& [source, position] : malformed) {
+            const auto expected = option::MessageFormat::format("パターン {0} の{1}文字目が不正です", source, position);
+            if (error_of(source) != expected) {
+                std::cout << "  " << source << ": " << error_of(source) << "\n";
+                expect(false, "a malformed pattern reports the position of the error");
+            }
+        }
+    }
+    {
+        // 状態数がMAX_STATESを超えるパターンは複雑すぎるとして拒否する(NFAとDFAのそれぞれ)
+        const std::string nfa = "[ab]{1000}[ab]{1000}[ab]{1000}[ab]{1000}[ab]{1000}";
+        expect(error_of(nfa) == option::MessageFormat::format("パターン {0} は複雑すぎます", nfa), "a pattern with too many NFA states is too complex");
+        const std::string dfa = "(a|b)*a(a|b){12}";
+        expect(error_of(dfa) == option::MessageFormat::format("パターン {0} は複雑すぎます", dfa), "a pattern with too many DFA states is too complex");
+        expect(error_of("(a|b)*a(a|b){8}").empty(), "a pattern below the limit is accepted");
+    }
+
+    return report();
+}
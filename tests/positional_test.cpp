@@ -0,0 +1,90 @@
+// 名前なしオプションのテスト
+//   g++ -std=c++20 -I. tests/positional_test.cpp && ./a.out
+#include "CommandLineOption.hpp"
+#include "test_util.hpp"
+#include <iostream>
+
+namespace {
+    // 解析のエラーメッセージ(エラーとならないときは空)
+    std::string error_of(option::CommandLineOption& clo, std::initializer_list<const char*> args) {
+        std::vector<const char*> argv(args);
+        try {
+            clo.parse(static_cast<int>(argv.size()), argv.data());
+        }
+        catch (const std::runtime_error& e) {
+            return e.what();
+        }
+        return "";
+    }
+}
+
+int main() {
+    {
+        // 名前なしオプションの引数の検査は名前付きのoptionとは別のメッセージとなる
+        option::CommandLineOption clo;
+        clo.add_options()
+            .l("x", option::Value<int>(), "x")
+            .u(option::Value<int>().required(1), "n");
+        expect(error_of(clo, {}) == "名前なしオプションに対する引数 引数の数が少なすぎます", "a missing positional is reported as unnamed");
+        expect(error_of(clo, { "--x", "1" }) == "名前なしオプションに対する引数 引数の数が少なすぎます", "named options do not hide a missing positional");
+        expect(error_of(clo, { "3" }).empty() && clo.map().unnamed_options().as<int>() == 3, "a supplied positional validates");
+    }
+    {
+        // 名前なしオプションは定義順に上限まで引数を受け取り、各々の型へ変換する
+        option::CommandLineOption clo;
+        clo.add_options()
+            .u(option::Value<std::string>().name("src"), "src")
+            .u(option::Value<int>().limit(2).name("count"), "count")
+            .u(option::Value<double>().unlimited().name("rest"), "rest");
+        expect(error_of(clo, { "in.txt", "1", "2", "0.5", "1.5" }).empty(), "typed slots parse");
+        expect(clo.map().unnamed_options(0).as<std::string>() == "in.txt", "the first slot takes the first argument");
+        expect(clo.map().unnamed_options(1).as<std::vector<int>>() == std::vector<int>{ 1, 2 }, "the second slot takes arguments up to its limit");
+        expect(clo.map().unnamed_options(2).as<std::vector<double>>() == std::vector<double>{ 0.5, 1.5 }, "the last slot takes the rest");
+        clo.map().init();
+        expect(error_of(clo, { "in.txt", "1", "x" }) == "名前なしオプション #2 <count> に対する引数 x は型 int に変換することはできません", "a conversion error names the slot");
+        clo.map().init();
+        expect(error_of(clo, { "in.txt", "1", "2", "y" }) == "名前なしオプション #3 <rest> に対する引数 y は型 double に変換することはできません", "a conversion error names the later slot");
+    }
+    {
+        // 後の名前なしオプションのpauseは上限に達した位置で解析を中断する
+        option::CommandLineOption clo;
+        clo.add_options()
+            .u(option::Value<std::string>().name("tool"), "tool")
+            .u.pause()(option::Value<std::string>().name("command"), "command")
+            .l("x", "x");
+        const char* argv[] = { "git", "commit", "--x", "rest" };
+        int offset = -1;
+        try {
+            offset = clo.parse(4, argv);
+        }
+        catch (const std::runtime_error&) {}
+        expect(offset == 2, "parse returns the offset after the paused slot");
+        expect(clo.map().unnamed_options(1).as<std::string>() == "commit" && !clo.map().luse("x"), "arguments after the pause are not parsed");
+    }
+    {
+        // 上限のないもしくは中断する名前なしオプションの後には名前なしオプションを定義できない
+        const std::string terminated = "引数の数に上限のないもしくは中断する名前なしオプションの後に名前なしオプションは定義できません";
+        for (bool pause : { false, true }) {
+            option::CommandLineOption clo;
+            std::string error;
+            try {
+                if (pause) {
+                    clo.add_options()
+                        .u.pause()(option::Value<int>(), "a")
+                        .u(option::Value<int>(), "b");
+                }
+                else {
+                    clo.add_options()
+                        .u(option::Value<int>().unlimited(), "a")
+                        .u(option::Value<int>(), "b");
+                }
+            }
+            catch (const std::invalid_argument& e) {
+                error = e.what();
+            }
+            expect(error == terminated, pause ? "a slot after a paused slot is rejected" : "a slot after an unlimited slot is rejected");
+        }
+    }
+
+    return report();
+}
@@ -0,0 +1,135 @@
+// ParseServerとParseClientのテスト(POSIX環境のみ)
+//   g++ -std=c++20 -I. tests/server_test.cpp -lpthread && ./a.out
+#include "CommandLineOptionServer.hpp"
+#include "test_util.hpp"
+#include <iostream>
+#include <poll.h>
+
+namespace {
+    template <class F>
+    std::chrono::milliseconds elapsed(F f) {
+        const auto begin = std::chrono::steady_clock::now();
+        f();
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin);
+    }
+
+    /// <summary>
+    /// 受け付けた接続をhandlerへ順に渡す偽のサーバ(接続が300ms途絶えたら終了し、受信した要求の数を返す)
+    /// </summary>
+    template <class F>
+    int fake_server(int listener, F handler) {
+        int requests = 0;
+        for (int i = 0;; ++i) {
+            pollfd p{ listener, POLLIN, 0 };
+            if (::poll(&p, 1, 300) <= 0) break;
+            const int fd = ::accept(listener, nullptr, nullptr);
+            std::string frame;
+            requests += handler(i, fd, frame) ? 1 : 0;
+            ::close(fd);
+        }
+        return requests;
+    }
+
+    int listen_on(const std::string& path) {
+        const auto addr = option::ParseProtocol::address(path);
+        const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        ::unlink(path.c_str());
+        ::bind(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr));
+        ::listen(fd, 4);
+        return fd;
+    }
+}
+
+int main() {
+    const std::string path = "/tmp/clo-server-test-" + std::to_string(::getpid()) + ".sock";
+    option::CommandLineOption clo;
+    clo.add_options().o("v", option::Counter(), "v").l("out", option::Value<int>(), "o");
+
+    {
+        // ソケット以外のファイルは削除しない
+        std::FILE* fp = std::fopen(path.c_str(), "w");
+        std::fclose(fp);
+        option::ParseServer server(clo.map(), path, 1);
+        try {
+            server.run();
+            expect(false, "run refuses to replace a regular file");
+        }
+        catch (const std::runtime_error&) {}
+        struct stat st{};
+        expect(::stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode), "the regular file is left in place");
+        ::unlink(path.c_str());
+    }
+
+    option::ParseServer server(clo.map(), path, 1);
+    server.idle_timeout = std::chrono::milliseconds(200);
+    std::thread thread([&] { server.run(); });
+    for (int i = 0; i < 100 && ::access(path.c_str(), F_OK) != 0; ++i) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    struct stat st{};
+    expect(::stat(path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode) && (st.st_mode & 0777) == 0600, "the socket is owner-only");
+
+    std::string out;
+    const char* ok_args[] = { "-v", "--out", "3" };
+    const char* bad_args[] = { "--out", "x" };
+    {
+        // 唯一のワーカーを待機中の接続が占有しても、時間切れの後に他の接続が処理される
+        option::ParseClient idle(path);
+        expect(idle.request(option::ParseProtocol::OP::VALIDATE, 3, ok_args, out) == option::ParseProtocol::STATUS::OK, "validate succeeds");
+        option::ParseClient other(path);
+        std::uint8_t status = 0xFF;
+        const auto wait = elapsed([&] { status = other.request(option::ParseProtocol::OP::PARSE, 3, ok_args, out); });
+        expect(status == option::ParseProtocol::STATUS::OK && out.find("\"--out\"") != std::string::npos, "a waiting client is served");
+        expect(wait < std::chrono::seconds(2), "a waiting client is served after the idle timeout");
+
+        // 切断された接続のクライアントは接続し直す
+        expect(idle.request(option::ParseProtocol::OP::PARSE, 2, bad_args, out) == option::ParseProtocol::STATUS::ERROR, "the idle client reconnects");
+    }
+
+    server.stop();
+    thread.join();
+    expect(::access(path.c_str(), F_OK) != 0, "the socket is removed on stop");
+
+    {
+        // 要求を読まずに切断した接続には送り直す
+        const int listener = listen_on(path);
+        int requests = 0;
+        std::thread fake([&] {
+            requests = fake_server(listener, [](int i, int fd, std::string& frame) {
+                if (i == 0) return false;
+                const bool received = option::ParseProtocol::recv_frame(fd, frame, 1 << 20);
+                option::ParseProtocol::send_all(fd, std::string("\x01\0\0\0\0", 5));
+                return received;
+            });
+        });
+        option::ParseClient client(path);
+        expect(client.request(option::ParseProtocol::OP::VALIDATE, 3, ok_args, out) == option::ParseProtocol::STATUS::OK, "a request unread by the server is resent");
+        fake.join();
+        expect(requests == 1, "the resent request reaches the server once");
+        ::close(listener);
+    }
+    {
+        // 要求を読んだ後に応答の途中で切断した接続には送り直さない(サーバは解析を終えている場合がある)
+        const int listener = listen_on(path);
+        int requests = 0;
+        std::thread fake([&] {
+            requests = fake_server(listener, [](int, int fd, std::string& frame) {
+                const bool received = option::ParseProtocol::recv_frame(fd, frame, 1 << 20);
+                option::ParseProtocol::send_all(fd, std::string("\x01\0", 2));
+                return received;
+            });
+        });
+        option::ParseClient client(path);
+        try {
+            client.request(option::ParseProtocol::OP::VALIDATE, 3, ok_args, out);
+            expect(false, "a truncated response is an error");
+        }
+        catch (const std::runtime_error&) {}
+        fake.join();
+        expect(requests == 1, "a request the server has read is not resent");
+        ::close(listener);
+        ::unlink(path.c_str());
+    }
+
+    return report();
+}
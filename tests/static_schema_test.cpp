@@ -0,0 +1,170 @@
+// コンパイル時に構築するoptionの定義表(StaticSchema)とOptionMapの解析結果の一致のテスト
+//   g++ -std=c++20 -I. tests/static_schema_test.cpp && ./a.out
+#include "CommandLineOption.hpp"
+#include "CommandLineOptionStatic.hpp"
+#include "test_util.hpp"
+#include <iostream>
+#include <random>
+
+namespace {
+    using KIND = option::StaticOption::KIND;
+
+    // 別名の対象は前方にあればよいが、OptionMapと定義順のインデックスを揃えるため直後に置く
+    constexpr option::StaticOption defs[] = {
+        { "-v", KIND::COUNT },
+        { "-p", KIND::VALUE, 0, 2 },
+        { "-q" },
+        { "--quiet", KIND::ALIAS, 0, 1, false, 2 },
+        { "--out", KIND::VALUE, option::OptionHasValueBase::ARG_PATTERN::ASSIGN | option::OptionHasValueBase::ARG_PATTERN::SPACE, 3 },
+        { "--output", KIND::ALIAS, 0, 1, false, 4 },
+        { "--help" },
+        { "--help", KIND::VALUE, option::OptionHasValueBase::ARG_PATTERN::ASSIGN },
+        { "--color", KIND::NEGATABLE },
+        { "-c", KIND::ALIAS, 0, 1, false, 8 },
+        { "--verbose", KIND::COUNT },
+        { "--jobs", KIND::VALUE, option::OptionHasValueBase::ARG_PATTERN::SPACE },
+        { "-j", KIND::ALIAS, 0, 1, false, 11 },
+        { "", KIND::UNNAMED, 0, 2 },
+        { "", KIND::UNNAMED, 0, 1, true },
+    };
+    constexpr option::StaticSchema schema(defs);
+
+    static_assert(schema.find("--output") == 4 && schema.find("-j") == 11 && schema.find("--help") == 6);
+    static_assert(schema.find("--outpu") == option::StaticSchemaBase::npos && schema.find("") == option::StaticSchemaBase::npos);
+
+    // StaticSchemaBase::buildで構築した表はtools/schema_compiler.cppの出力と同じく構築済みの表として受け取れる
+    constexpr auto tables = [] {
+        std::pair<std::array<std::uint32_t, option::StaticSchemaBase::bucket_count(std::size(defs))>, std::array<std::uint32_t, option::StaticSchemaBase::table_size(std::size(defs))>> t{};
+        option::StaticSchemaBase::build(defs, t.first, t.second);
+        return t;
+    }();
+    constexpr option::StaticSchema<std::size(defs)> prebuilt(defs, tables.first, tables.second);
+    static_assert(prebuilt.find("--color") == 8 && prebuilt.find("-c") == 8);
+
+    void add_options(option::CommandLineOption& clo) {
+        clo.add_options()
+            .o("v", option::Counter(), "v")
+            .o("p", option::Value<std::string>().limit(2), "p")
+            .o("q", "q")
+            .a("--quiet", "-q")
+            .l("out", option::Value<std::string>().limit(3), "out")
+            .a("--output", "--out")
+            .l("help", "help")
+            .l("help=", option::Value<std::string>(), "help=")
+            .l("color", option::Negatable(), "color")
+            .a("-c", "--color")
+            .l("verbose", option::Counter(), "verbose")
+            .l("jobs ", option::Value<std::string>(), "jobs")
+            .a("-j", "--jobs")
+            .u(option::Value<std::string>().limit(2), "u1")
+            .u.pause()(option::Value<std::string>(), "u2");
+    }
+
+    // optionごとの解析結果(計数、真偽値、引数の列)とエラーメッセージと解析後のオフセット
+    struct Outcome {
+        std::vector<std::size_t> counts;
+        std::vector<std::vector<std::string>> values;
+        std::string error;
+        int offset = -1;
+
+        bool operator==(const Outcome&) const = default;
+    };
+
+    Outcome parse_map(int argc, const char* argv[]) {
+        option::CommandLineOption clo;
+        add_options(clo);
+        Outcome out;
+        try {
+            out.offset = clo.map().parse(argc, argv, false);
+        }
+        catch (const std::exception& e) {
+            out.error = e.what();
+            return out;
+        }
+        for (auto p : clo.map().schema().options()) {
+            std::size_t count = 0;
+            std::vector<std::string> values;
+            if (auto flag = dynamic_cast<const option::FlagOptionBase*>(p)) count = flag->count();
+            else if (auto value = dynamic_cast<const option::OptionValue<std::string>*>(p)) {
+                if (p->use()) values.assign(value->view().begin(), value->view().end());
+            }
+            else count = p->use();
+            out.counts.push_back(count);
+            out.values.push_back(std::move(values));
+        }
+        return out;
+    }
+
+    Outcome parse_static(int argc, const char* argv[]) {
+        Outcome out;
+        std::vector<std::size_t> counts(schema.size());
+        std::vector<std::vector<std::string>> values(schema.size());
+        try {
+            out.offset = schema.parse(argc, argv, [&](std::size_t i, std::string_view value) {
+                switch (schema[i].kind) {
+                case KIND::FLAG: counts[i] = 1; break;
+                case KIND::COUNT: ++counts[i]; break;
+                case KIND::NEGATABLE: counts[i] = value == "true"; break;
+                default: values[i].emplace_back(value); break;
+                }
+            });
+        }
+        catch (const std::exception& e) {
+            out.error = e.what();
+            return out;
+        }
+        for (std::size_t i = 0; i < schema.size(); ++i) {
+            if (schema[i].kind == KIND::ALIAS) continue;
+            out.counts.push_back(counts[i]);
+            out.values.push_back(std::move(values[i]));
+        }
+        return out;
+    }
+}
+
+int main() {
+    {
+        option::CommandLineOption clo;
+        add_options(clo);
+        expect(clo.map().schema().size() + 4 == schema.size(), "the static definitions mirror the registered options and aliases");
+    }
+
+    const char* fixed[] = { "-v", "--out", "a", "-", "-b", "--help=x", "--no-color", "u", "-", "--v", "w", "z" };
+    const auto expected = parse_map(std::size(fixed), fixed);
+    expect(expected.error.empty() && expected.offset == 11, "the fixed command line parses and pauses after the second unnamed option");
+    expect(parse_static(std::size(fixed), fixed) == expected, "StaticSchema agrees with OptionMap on the fixed command line");
+
+    // optionの先頭に現れやすいトークンと引数になりやすいトークンを混ぜた無作為なコマンドライン引数
+    const char* pool[] = {
+        "-v", "-p", "-q", "--quiet", "--quiet=1", "--out", "--out=o", "--output", "--output=", "--help", "--help=h", "--help=",
+        "--color", "--no-color", "--color=1", "--no-color=0", "-c", "--no-c", "--verbose", "--no-verbose", "--jobs", "--jobs=2",
+        "-j", "-x", "--xyz", "--no-xyz", "-p=1", "-", "--", "---", "a", "b", "-1", "--2", "",
+    };
+    std::mt19937 rng(12345);
+    int mismatches = 0;
+    for (int round = 0; round < 20000; ++round) {
+        const int argc = static_cast<int>(rng() % 9);
+        std::vector<const char*> argv(argc);
+        for (auto& token : argv) token = pool[rng() % std::size(pool)];
+        if (parse_map(argc, argv.data()) != parse_static(argc, argv.data()) && ++mismatches <= 5) {
+            std::cout << "mismatch:";
+            for (auto token : argv) std::cout << " [" << token << "]";
+            std::cout << "\n";
+        }
+    }
+    expect(mismatches == 0, "StaticSchema agrees with OptionMap on random command lines");
+
+    // 名前なしオプションのない定義表では名前なしの引数はOptionMapと同じエラーとなる
+    constexpr option::StaticOption named_only[] = { { "-a" }, { "--b", KIND::VALUE } };
+    constexpr option::StaticSchema small(named_only);
+    const char* stray[] = { "--b", "1", "2" };
+    try {
+        small.parse(3, stray, [](std::size_t, std::string_view) {});
+        expect(false, "an unnamed argument without unnamed options throws");
+    }
+    catch (const std::runtime_error& e) {
+        expect(std::string_view(e.what()) == "名前なしオプションの設定はできません", "the unnamed argument error matches OptionMap");
+    }
+
+    return report();
+}
@@ -0,0 +1,58 @@
+// 引数の列の参照(view)と取り出し(take)のテスト
+//   g++ -std=c++20 -I. tests/take_test.cpp && ./a.out
+#include "CommandLineOption.hpp"
+#include "CommandLineOptionJson.hpp"
+#include "test_util.hpp"
+#include <iostream>
+
+namespace {
+    template <class Map>
+    concept can_take = requires(Map& map) { map.use("x").template take<int>(); };
+}
+
+// constなOptionMapからは解析結果を取り出せない
+static_assert(!can_take<const option::OptionMap>);
+static_assert(can_take<option::OptionMap>);
+
+int main() {
+    option::CommandLineOption clo;
+    clo.add_options()
+        .l("weights", option::Value<double>({ 0.5, 0.25 }).unlimited(), "w")
+        .l("n", option::Value<int>(), "n")
+        .l("w", option::Value<double>().unlimited(), "w");
+
+    const char* argv[] = { "--weights", "1", "2", "3", "--w", "1", "2" };
+    clo.parse(7, argv);
+    const option::OptionMap& view_only = clo.map();
+    const auto values = view_only.use("weights").view<double>();
+    expect(values.size() == 3 && values[2] == 3.0, "view refers to the parsed values");
+
+    const double* data = values.data();
+    auto owned = clo.map().use("weights").take<double>();
+    expect(owned.size() == 3 && owned.data() == data, "take moves the parsed values without copying");
+    expect(view_only.use("weights").view<double>().size() == 2, "after take the option falls back to its defaults");
+    expect(!clo.map().use("weights"), "after take the option with defaults is unused");
+
+    // デフォルト値の無いoptionは取り出した後に引数が設定されていない状態となる
+    expect(clo.map().use("w").take<double>() == std::vector<double>{ 1, 2 }, "take returns the parsed values");
+    expect(!clo.map().use("w"), "after take the option is unused");
+    expect(clo.map().to_json().find("\"--w\"") == std::string::npos, "after take the option is not exported");
+    try {
+        clo.map().use("w").as<std::vector<double>>();
+        expect(false, "after take as throws for an option without defaults");
+    }
+    catch (const std::runtime_error&) {}
+
+    try {
+        clo.map().use("weights").take<int>();
+        expect(false, "take with a wrong type throws std::logic_error");
+    }
+    catch (const std::logic_error&) {}
+    try {
+        clo.map().use("n").take<int>();
+        expect(false, "take of an unset option without defaults throws std::runtime_error");
+    }
+    catch (const std::runtime_error&) {}
+
+    return report();
+}
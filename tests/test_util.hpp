@@ -0,0 +1,31 @@
+#pragma once
+
+// tests以下の各テストで共有する検査の補助
+#include <iostream>
+#include <string_view>
+
+/// <summary>
+/// 失敗した検査の数
+/// </summary>
+inline int failures = 0;
+
+/// <summary>
+/// 条件が満たされないときに失敗として記録する
+/// </summary>
+/// <param name="condition">検査する条件</param>
+/// <param name="what">失敗したときに表示する内容</param>
+inline void expect(bool condition, std::string_view what) {
+    if (!condition) {
+        std::cout << "FAILED: " << what << "\n";
+        ++failures;
+    }
+}
+
+/// <summary>
+/// 結果を表示してmainの戻り値を返す
+/// </summary>
+/// <returns>全ての検査が成功したときに0</returns>
+inline int report() {
+    std::cout << (failures == 0 ? "ok" : "failed") << "\n";
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,116 @@
+// UsageCountersによるプロセス間で共有するoptionの使用回数のテスト
+//   g++ -std=c++20 -I. tests/usage_counters_test.cpp -lrt && ./a.out
+#include "CommandLineOptionUsage.hpp"
+#include "test_util.hpp"
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace {
+    template <class E, class F>
+    bool throws(F&& f) {
+        try {
+            f();
+        }
+        catch (const E&) {
+            return true;
+        }
+        return false;
+    }
+
+    // テストごとに異なる指紋となるように、プロセスIDを含む名前のoptionを定義する
+    void define(option::CommandLineOption& clo) {
+        clo.add_options()
+            .l("out", option::Value<std::string>().unlimited(), "out")
+            .l("usage-test-" + std::to_string(::getpid()), "unique")
+            .o("v", "verbose");
+    }
+
+    // 共有メモリのアクセス権
+    unsigned int mode_of(std::uint64_t fingerprint) {
+        const int fd = ::shm_open(option::UsageCounters::segment_name(fingerprint).c_str(), O_RDONLY, 0);
+        if (fd < 0) return 0;
+        struct stat st{};
+        const bool ok = ::fstat(fd, &st) == 0;
+        ::close(fd);
+        return ok ? static_cast<unsigned int>(st.st_mode & 0777) : 0;
+    }
+}
+
+int main() {
+    // アクセス権を指定どおりに確かめるためumaskを外す
+    ::umask(0);
+    option::CommandLineOption first, second;
+    define(first);
+    define(second);
+    const auto fp = option::UsageCounters::fingerprint_of(first.map());
+    expect(fp == option::UsageCounters::fingerprint_of(second.map()), "the same definitions have the same fingerprint");
+    option::UsageCounters::remove(fp);
+    {
+        // 同じ指紋のoptionの定義は1つの共有メモリの使用回数を共有する
+        auto a = first.map().enable_usage_counters();
+        auto b = second.map().enable_usage_counters();
+        expect(a->shared() && b->shared(), "the counters are mapped into shared memory");
+        expect(mode_of(fp) == 0600, "the shared memory is created with mode 0600 by default");
+        const char* args1[] = { "--out", "a", "-v" };
+        const char* args2[] = { "--out", "b", "--out", "c" };
+        first.parse(3, args1);
+        second.parse(4, args2);
+        expect(a->count(0) == 3 && b->count(0) == 3 && a->count(2) == 1 && b->count(1) == 0, "counts from both maps are added together");
+
+        // 計測を開始した後はoptionを追加できない
+        expect(throws<std::logic_error>([&] { first.add_options().l("late", "late"); }), "adding an option after enabling is a logic_error");
+        expect(throws<std::invalid_argument>([&] { first.map().use("late"); }), "a rejected option is not left in the map");
+        expect(throws<std::logic_error>([&] { first.add_options().o("l", "late"); }), "adding a short option after enabling is a logic_error");
+        expect(throws<std::logic_error>([&] { first.add_options().u(option::Value<int>(), "late"); }), "adding an unnamed option after enabling is a logic_error");
+        // 別名は指紋に含まれるため、計測を開始した後は追加できない
+        expect(throws<std::logic_error>([&] { first.add_options().a("--output", "--out"); }), "adding an alias after enabling is a logic_error");
+        expect(option::UsageCounters::fingerprint_of(first.map()) == fp, "the fingerprint is unchanged after the rejected additions");
+
+        // 大きさが一致しない既存の共有メモリは用いず、プロセス内の領域で計測する
+        option::UsageCounters larger(fp, a->size() + 1);
+        larger.add(0);
+        expect(!larger.shared() && larger.count(0) == 1 && a->count(0) == 3, "a size mismatch falls back to local counters");
+
+        // Prometheusのテキスト形式の出力
+        const auto path = std::filesystem::temp_directory_path() / ("usage_counters_test_" + std::to_string(::getpid()) + ".prom");
+        expect(first.map().export_usage(path.string()), "export_usage writes the file");
+        std::stringstream text;
+        text << std::ifstream(path).rdbuf();
+        char schema[17];
+        std::snprintf(schema, sizeof(schema), "%016llx", static_cast<unsigned long long>(fp));
+        const auto label = "command_line_option_usage_total{schema=\"" + std::string(schema) + "\",";
+        expect(text.str().starts_with("# HELP command_line_option_usage_total ") && text.str().find("# TYPE command_line_option_usage_total counter\n") != std::string::npos, "the export has the HELP and TYPE lines");
+        expect(text.str().find(label + "option=\"--out\"} 3\n") != std::string::npos && text.str().find(label + "option=\"-v\"} 1\n") != std::string::npos, "each option is exported with its schema and count");
+        expect(!std::filesystem::exists(path.string() + ".tmp"), "the temporary file is renamed");
+        std::filesystem::remove(path);
+    }
+    option::UsageCounters::remove(fp);
+    {
+        // 見出しの指紋が一致しない既存の共有メモリは用いない
+        const auto other = fp ^ 1;
+        option::UsageCounters::remove(other);
+        const int fd = ::shm_open(option::UsageCounters::segment_name(other).c_str(), O_RDWR | O_CREAT, 0600);
+        const std::uint64_t header[] = { 0x31454741'53554F4Cull, fp, 3, 0, 0, 0 };
+        expect(fd >= 0 && ::write(fd, header, sizeof(header)) == static_cast<ssize_t>(sizeof(header)), "a segment with a foreign header is created");
+        ::close(fd);
+        option::UsageCounters counters(other, 3, 0640);
+        expect(!counters.shared() && counters.count(0) == 0, "a header mismatch falls back to local counters");
+        option::UsageCounters::remove(other);
+
+        // 指定したアクセス権で作成する
+        option::UsageCounters group(other, 3, 0640);
+        expect(group.shared() && mode_of(other) == 0640, "the shared memory is created with the given mode");
+        option::UsageCounters::remove(other);
+    }
+    {
+        // 計測していないときは出力できない
+        option::CommandLineOption clo;
+        define(clo);
+        std::string out;
+        expect(throws<std::logic_error>([&] { clo.map().write_usage_prometheus(out); }), "exporting without counters is a logic_error");
+    }
+
+    return report();
+}
@@ -0,0 +1,71 @@
+// Value<T>による引数の変換のテスト
+//   g++ -std=c++20 -I. tests/value_test.cpp && ./a.out
+#include "CommandLineOption.hpp"
+#include "test_util.hpp"
+#include <iostream>
+
+namespace {
+    template <class T>
+    void expect_value(const char* str, T expected) {
+        T result{};
+        if (!option::Value<T>::parse_floating(str, result) || !(result == expected || (result != result && expected != expected))) {
+            std::cout << "FAILED: \"" << str << "\" should be " << expected << "\n";
+            ++failures;
+        }
+    }
+
+    template <class T>
+    void expect_error(const char* str) {
+        T result{};
+        if (option::Value<T>::parse_floating(str, result)) {
+            std::cout << "FAILED: \"" << str << "\" should be rejected but was " << result << "\n";
+            ++failures;
+        }
+    }
+}
+
+int main() {
+    expect_value<double>("1.5", 1.5);
+    expect_value<double>("+2", 2.0);
+    expect_value<double>("-0.25", -0.25);
+    expect_value<double>("1e3", 1000.0);
+    expect_value<double>("inf", std::numeric_limits<double>::infinity());
+    expect_value<double>("-Infinity", -std::numeric_limits<double>::infinity());
+    expect_value<double>("nan", std::numeric_limits<double>::quiet_NaN());
+    expect_value<double>("0x1p3", 8.0);
+    expect_value<double>("-0X1.8p1", -3.0);
+    expect_value<double>("0x.8p1", 1.0);
+    expect_value<double>("0xA", 10.0);
+    expect_value<float>("0.1", 0.1f);
+
+    expect_error<double>("");
+    expect_error<double>("1e");
+    expect_error<double>("+-1");
+    expect_error<double>("--1");
+    expect_error<double>("1_");
+    expect_error<double>("1e400");
+    // 「0x」の後の符号や「inf」「nan」は16進数として扱わない
+    expect_error<double>("0x");
+    expect_error<double>("0x-1");
+    expect_error<double>("0x+1");
+    expect_error<double>("-0x-1");
+    expect_error<double>("0xinf");
+    expect_error<double>("0XNaN");
+    expect_error<double>("0x 1");
+    expect_error<double>("0xp1");
+
+    // コマンドライン引数としての変換
+    option::CommandLineOption clo;
+    clo.add_options().l("x", option::Value<double>(), "x");
+    for (const char* bad : { "0x-1", "0xinf" }) {
+        const char* argv[] = { "--x", bad };
+        try {
+            clo.parse(2, argv);
+            std::cout << "FAILED: --x " << bad << " should be rejected\n";
+            ++failures;
+        }
+        catch (const std::runtime_error&) {}
+    }
+
+    return report();
+}
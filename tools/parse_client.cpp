@@ -0,0 +1,45 @@
+// parse_daemonへ解析を要求するシェルスクリプト向けのクライアント(POSIX環境のみ)
+//   g++ -std=c++20 -I. tools/parse_client.cpp -o parse_client
+//   json=$(parse_client /run/myapp/options.sock -- "$@") || exit $?
+// 解析結果のJSONを標準出力へ、エラーメッセージを標準エラー出力へ書き出し、
+// 終了コードは成功で0、解析もしくは検証のエラーで1、不正な要求や通信の失敗で2となる。
+// 「--validate」を指定すると検証のみを行い何も出力しない
+#include "CommandLineOptionServer.hpp"
+#include <iostream>
+
+int main(int argc, const char* argv[]) {
+    // クライアント自身の引数は「--」までとし、以降はそのまま解析を要求する
+    int offset = 1;
+    const char* path = nullptr;
+    std::uint8_t op = option::ParseProtocol::OP::PARSE;
+    for (; offset < argc && std::string_view(argv[offset]) != "--"; ++offset) {
+        if (std::string_view(argv[offset]) == "--validate") op = option::ParseProtocol::OP::VALIDATE;
+        else if (path == nullptr) path = argv[offset];
+        else break;
+    }
+    if (offset < argc && std::string_view(argv[offset]) == "--") ++offset;
+    if (path == nullptr) {
+        std::cerr << "usage: parse_client SOCKET [--validate] [--] ARGS..." << std::endl;
+        return 2;
+    }
+
+    try {
+        option::ParseClient client(path);
+        std::string payload;
+        switch (client.request(op, argc - offset, argv + offset, payload)) {
+        case option::ParseProtocol::STATUS::OK:
+            if (!payload.empty()) std::cout << payload << std::endl;
+            return 0;
+        case option::ParseProtocol::STATUS::ERROR:
+            std::cerr << payload << std::endl;
+            return 1;
+        default:
+            std::cerr << payload << std::endl;
+            return 2;
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 2;
+    }
+}
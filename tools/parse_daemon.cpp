@@ -0,0 +1,80 @@
+// optionの定義を常駐させてUnixドメインソケットで解析要求に応答するデーモン(POSIX環境のみ)
+//   g++ -std=c++20 -I. tools/parse_daemon.cpp -lpthread -o parse_daemon
+//   ./parse_daemon --socket /run/myapp/options.sock
+// 常駐させるoptionの定義はbuild_schemaを書き換えて指定する
+#include "CommandLineOptionServer.hpp"
+#include "CommandLineOptionPattern.hpp"
+#include "CommandLineOptionTerminal.hpp"
+#include <csignal>
+#include <iostream>
+
+namespace {
+    /// <summary>
+    /// 常駐させるoptionの定義の構築
+    /// </summary>
+    /// <param name="clo">定義の追加先</param>
+    void build_schema(option::CommandLineOption& clo) {
+        clo.add_options()
+            .l("help", "ヘルプ")
+            .o("v", option::Counter(), "詳細な出力")
+            .o("o", option::Value<std::string>("out.txt").name("out"), "出力ファイル名")
+            .l("jobs", option::Value<int>(1).constraint([](int i) { return 0 < i; }), "並列数")
+            .l("color", option::Negatable(true), "色付きの出力")
+            .u(option::Value<std::string>().unlimited(), "入力ファイル");
+    }
+}
+
+int main(int argc, const char* argv[]) {
+    option::CommandLineOption daemon;
+    daemon.add_options()
+        .l("help", "ヘルプ")
+        .l("socket", option::Value<std::string>().required(), "Unixドメインソケットのパス")
+        .l("workers", option::Value<int>(0).constraint([](int i) { return 0 <= i; }), "ワーカーの数(0のときはハードウェアのスレッド数)")
+        .l("idle-timeout", option::Value<int>(5000).constraint([](int i) { return 0 <= i; }), "待機中の接続を切断するまでのミリ秒(0のときは無制限)")
+        .l("mode", option::Value<std::string>("0600").pattern("0?[0-7]{3}"), "ソケットファイルのアクセス権(8進数)");
+    try {
+        // 「--help」のときは必須の引数を検証しない
+        daemon.parse(argc - 1, argv + 1, false);
+        if (daemon.map().luse("help")) {
+            std::cout << "parse_daemon --socket PATH [--workers N] [--idle-timeout MS] [--mode MODE]" << std::endl;
+            daemon.print_description(stdout);
+            return 0;
+        }
+        daemon.map().validate();
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 2;
+    }
+
+    option::CommandLineOption clo;
+    build_schema(clo);
+    option::ParseServer server(clo.map(), daemon.map().luse("socket").as<std::string>(), static_cast<std::size_t>(daemon.map().luse("workers").as<int>()));
+    server.idle_timeout = std::chrono::milliseconds(daemon.map().luse("idle-timeout").as<int>());
+    server.socket_mode = static_cast<unsigned int>(std::stoul(daemon.map().luse("mode").as<std::string>(), nullptr, 8));
+
+    // SIGINTとSIGTERMは専用のスレッドで受け取って停止を要求する(以降に作成するスレッドはシグナルを受け取らない)
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+    std::thread waiter([&] {
+        int signal = 0;
+        sigwait(&signals, &signal);
+        server.stop();
+    });
+
+    int status = 0;
+    try {
+        server.run();
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        status = 1;
+    }
+    // runが先に終了したときは待機中のスレッドを起こす
+    pthread_kill(waiter.native_handle(), SIGTERM);
+    waiter.join();
+    return status;
+}
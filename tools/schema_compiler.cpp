@@ -0,0 +1,372 @@
+// OptionMap::json_schemaの出力からコンパイル時に構築するoptionの定義表(StaticSchema)のヘッダを生成する
+//   g++ -std=c++20 -I. tools/schema_compiler.cpp -o schema_compiler
+//   ./myapp --dump-schema | schema_compiler --namespace myapp_options -o myapp_options.hpp
+// 生成したヘッダは完全ハッシュの表を構築済みの値として含むため、optionの数が多くても種の探索をコンパイル時に行わない。
+// 別名は対象のoptionの直後に置き、parseはOptionMap::parseと同じ規則でトークンを区切って(optionのインデックス, 引数)を通知する。
+// 入力を省略したときは標準入力から、出力を省略したときは標準出力へ書き出す
+#include "CommandLineOption.hpp"
+#include "CommandLineOptionStatic.hpp"
+#include "CommandLineOptionTerminal.hpp"
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+namespace {
+    /// <summary>
+    /// json_schemaの出力を読むための最小限のJSONの値
+    /// </summary>
+    struct Json {
+        enum class TYPE { NUL, BOOL, NUMBER, STRING, ARRAY, OBJECT };
+        TYPE type = TYPE::NUL;
+        bool boolean = false;
+        double number = 0;
+        std::string string;
+        std::vector<Json> items;
+        std::vector<std::pair<std::string, Json>> members;
+
+        /// <summary>
+        /// オブジェクトのメンバの取得
+        /// </summary>
+        /// <param name="key">キー</param>
+        /// <returns>存在しないときはnullptr</returns>
+        const Json* find(std::string_view key) const {
+            for (const auto& [k, v] : this->members) {
+                if (k == key) return &v;
+            }
+            return nullptr;
+        }
+    };
+
+    /// <summary>
+    /// 再帰下降によるJSONの読み込み
+    /// </summary>
+    class JsonReader {
+        std::string_view _text;
+        std::size_t _pos = 0;
+
+        [[noreturn]] void fail(const char* what) const {
+            throw std::runtime_error(option::MessageFormat::format("JSONの {0} バイト目: {1}", this->_pos, what));
+        }
+
+        void skip() {
+            while (this->_pos < this->_text.size() && std::string_view(" \t\r\n").find(this->_text[this->_pos]) != std::string_view::npos) ++this->_pos;
+        }
+
+        bool consume(std::string_view token) {
+            if (this->_text.substr(this->_pos).starts_with(token)) {
+                this->_pos += token.size();
+                return true;
+            }
+            return false;
+        }
+
+        unsigned hex4() {
+            if (this->_pos + 4 > this->_text.size()) this->fail("\\uの後に16進数が4桁必要です");
+            unsigned v = 0;
+            auto r = std::from_chars(this->_text.data() + this->_pos, this->_text.data() + this->_pos + 4, v, 16);
+            if (r.ptr != this->_text.data() + this->_pos + 4) this->fail("\\uの後に16進数が4桁必要です");
+            this->_pos += 4;
+            return v;
+        }
+
+        std::string string() {
+            if (!this->consume("\"")) this->fail("文字列が必要です");
+            std::string out;
+            while (true) {
+                if (this->_pos >= this->_text.size()) this->fail("文字列が閉じられていません");
+                char c = this->_text[this->_pos++];
+                if (c == '"') return out;
+                if (c != '\\') {
+                    out.push_back(c);
+                    continue;
+                }
+                if (this->_pos >= this->_text.size()) this->fail("文字列が閉じられていません");
+                switch (c = this->_text[this->_pos++]) {
+                case '"': case '\\': case '/': out.push_back(c); break;
+                case 'b': out.push_back('\b'); break;
+                case 'f': out.push_back('\f'); break;
+                case 'n': out.push_back('\n'); break;
+                case 'r': out.push_back('\r'); break;
+                case 't': out.push_back('\t'); break;
+                case 'u': {
+                    char32_t cp = this->hex4();
+                    if (cp >= 0xD800 && cp < 0xDC00 && this->consume("\\u")) {
+                        const char32_t low = this->hex4();
+                        if (low < 0xDC00 || low >= 0xE000) this->fail("サロゲートペアが不正です");
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    if (cp < 0x80) out.push_back(static_cast<char>(cp));
+                    else if (cp < 0x800) {
+                        out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+                        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+                    }
+                    else if (cp < 0x10000) {
+                        out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+                        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+                        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+                    }
+                    else {
+                        out.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+                        out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+                        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+                        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+                    }
+                    break;
+                }
+                default:
+                    this->fail("不正なエスケープです");
+                }
+            }
+        }
+
+    public:
+        explicit JsonReader(std::string_view text) : _text(text) {}
+
+        Json value() {
+            this->skip();
+            Json v;
+            if (this->_pos >= this->_text.size()) this->fail("値が必要です");
+            const char c = this->_text[this->_pos];
+            if (c == '{') {
+                v.type = Json::TYPE::OBJECT;
+                ++this->_pos;
+                this->skip();
+                if (this->consume("}")) return v;
+                do {
+                    this->skip();
+                    auto key = this->string();
+                    this->skip();
+                    if (!this->consume(":")) this->fail("「:」が必要です");
+                    v.members.emplace_back(std::move(key), this->value());
+                    this->skip();
+                } while (this->consume(","));
+                if (!this->consume("}")) this->fail("「}」が必要です");
+            }
+            else if (c == '[') {
+                v.type = Json::TYPE::ARRAY;
+                ++this->_pos;
+                this->skip();
+                if (this->consume("]")) return v;
+                do {
+                    v.items.push_back(this->value());
+                    this->skip();
+                } while (this->consume(","));
+                if (!this->consume("]")) this->fail("「]」が必要です");
+            }
+            else if (c == '"') {
+                v.type = Json::TYPE::STRING;
+                v.string = this->string();
+            }
+            else if (this->consume("true") || this->consume("false")) {
+                v.type = Json::TYPE::BOOL;
+                v.boolean = c == 't';
+            }
+            else if (this->consume("null")) {
+                v.type = Json::TYPE::NUL;
+            }
+            else {
+                v.type = Json::TYPE::NUMBER;
+                auto r = std::from_chars(this->_text.data() + this->_pos, this->_text.data() + this->_text.size(), v.number);
+                if (r.ec != std::errc()) this->fail("値が不正です");
+                this->_pos = r.ptr - this->_text.data();
+            }
+            return v;
+        }
+
+        Json document() {
+            auto v = this->value();
+            this->skip();
+            if (this->_pos != this->_text.size()) this->fail("値の後に余分な文字があります");
+            return v;
+        }
+    };
+
+    /// <summary>
+    /// C++の文字列リテラルとして出力する(印字可能なASCII以外は8進数によるエスケープ)
+    /// </summary>
+    std::string literal(std::string_view str) {
+        std::string out = "\"";
+        for (unsigned char c : str) {
+            if (c == '"' || c == '\\') out.append(1, '\\').push_back(static_cast<char>(c));
+            else if (c >= 0x20 && c < 0x7F) out.push_back(static_cast<char>(c));
+            else out.append({ '\\', static_cast<char>('0' + (c >> 6)), static_cast<char>('0' + ((c >> 3) & 7)), static_cast<char>('0' + (c & 7)) });
+        }
+        return out.append("\"");
+    }
+
+    /// <summary>
+    /// 生成するoptionの定義
+    /// </summary>
+    struct Entry {
+        option::StaticOption spec;
+        std::string description;
+        std::string type;
+    };
+
+    const Json& member(const Json& object, std::string_view key) {
+        auto p = object.find(key);
+        if (p == nullptr) throw std::runtime_error(option::MessageFormat::format("optionの定義に \"{0}\" がありません", key));
+        return *p;
+    }
+
+    std::size_t limit_of(const Json& object) {
+        const auto& limit = member(object, "limit");
+        if (limit.type == Json::TYPE::NUL) return option::StaticOption::UNLIMITED;
+        return static_cast<std::size_t>(limit.number);
+    }
+
+    /// <summary>
+    /// json_schemaの出力からoptionの定義の列を構築する
+    /// </summary>
+    /// <param name="schema">json_schemaの出力</param>
+    /// <param name="names">option名の保持先(定義の列はこれを参照する)</param>
+    /// <returns></returns>
+    std::vector<Entry> entries(const Json& schema, std::deque<std::string>& names) {
+        using KIND = option::StaticOption::KIND;
+        using ARG_PATTERN = option::OptionHasValueBase::ARG_PATTERN;
+        std::vector<Entry> out;
+        for (const auto& o : member(schema, "options").items) {
+            Entry e;
+            const auto& name = member(o, "name");
+            const auto& kind = member(o, "kind").string;
+            e.spec.name = name.type == Json::TYPE::NUL ? std::string_view() : std::string_view(names.emplace_back(name.string));
+            e.description = member(o, "description").string;
+            if (auto type = o.find("type")) e.type = type->string;
+            if (kind == "flag") e.spec.kind = KIND::FLAG;
+            else if (kind == "count") e.spec.kind = KIND::COUNT;
+            else if (kind == "negatable") e.spec.kind = KIND::NEGATABLE;
+            else if (kind == "value") {
+                e.spec.kind = KIND::VALUE;
+                e.spec.arg_pattern = 0;
+                for (const auto& p : member(o, "arg_pattern").items) {
+                    e.spec.arg_pattern |= p.string == "assign" ? ARG_PATTERN::ASSIGN : p.string == "space" ? ARG_PATTERN::SPACE : 0;
+                }
+                e.spec.limit = limit_of(o);
+            }
+            else if (kind == "unnamed") {
+                e.spec.kind = KIND::UNNAMED;
+                e.spec.limit = limit_of(o);
+                e.spec.pause = member(o, "pause").boolean;
+            }
+            else throw std::runtime_error(option::MessageFormat::format("optionの種類 {0} は扱えません", kind));
+
+            const auto target = out.size();
+            out.push_back(std::move(e));
+            for (const auto& alias : member(o, "aliases").items) {
+                Entry a{ out[target] };
+                a.spec.name = names.emplace_back(alias.string);
+                a.spec.kind = KIND::ALIAS;
+                a.spec.target = target;
+                out.push_back(std::move(a));
+            }
+        }
+        return out;
+    }
+
+    const char* kind_name(std::uint8_t kind) {
+        static const char* names[] = { "FLAG", "COUNT", "NEGATABLE", "VALUE", "UNNAMED", "ALIAS" };
+        return names[kind];
+    }
+
+    std::string arg_pattern_name(std::size_t arg_pattern) {
+        using ARG_PATTERN = option::OptionHasValueBase::ARG_PATTERN;
+        std::string out;
+        if ((arg_pattern & ARG_PATTERN::ASSIGN) == ARG_PATTERN::ASSIGN) out = "option::OptionHasValueBase::ARG_PATTERN::ASSIGN";
+        if ((arg_pattern & ARG_PATTERN::SPACE) == ARG_PATTERN::SPACE) out.append(out.empty() ? "" : " | ").append("option::OptionHasValueBase::ARG_PATTERN::SPACE");
+        return out.empty() ? "0" : out;
+    }
+
+    /// <summary>
+    /// 定義表のヘッダを生成する
+    /// </summary>
+    std::string generate(const std::vector<Entry>& list, std::string_view ns) {
+        std::vector<option::StaticOption> specs;
+        for (const auto& e : list) specs.push_back(e.spec);
+        std::vector<std::uint32_t> seeds(option::StaticSchemaBase::bucket_count(specs.size()));
+        std::vector<std::uint32_t> slots(option::StaticSchemaBase::table_size(specs.size()));
+        option::StaticSchemaBase::build(specs, seeds, slots);
+
+        std::string out;
+        out.append("// tools/schema_compiler.cpp により生成したoptionの定義表(編集しないこと)\n");
+        out.append("#pragma once\n#include \"CommandLineOptionStatic.hpp\"\n\n");
+        out.append(option::MessageFormat::format("namespace {0} {{\n", ns));
+        out.append("    // optionの仕様(別名は対象のoptionの直後に置く)\n");
+        out.append("    inline constexpr option::StaticOption options[] = {\n");
+        for (const auto& e : list) {
+            const auto& s = e.spec;
+            out.append(option::MessageFormat::format("        {{ {0}, option::StaticOption::KIND::{1}, {2}, {3}, {4}, {5} }},\n", literal(s.name), kind_name(s.kind),
+                arg_pattern_name(s.arg_pattern), s.limit == option::StaticOption::UNLIMITED ? std::string("option::StaticOption::UNLIMITED") : std::to_string(s.limit),
+                s.pause ? "true" : "false", s.target));
+        }
+        out.append("    };\n\n    // 完全ハッシュの表(StaticSchemaBase::buildで構築済み)\n");
+        auto join = [](const std::vector<std::uint32_t>& values) {
+            std::string s;
+            for (auto v : values) s.append(s.empty() ? "" : ", ").append(std::to_string(v));
+            return s;
+        };
+        out.append(option::MessageFormat::format("    inline constexpr std::uint32_t seeds[] = {{ {0} }};\n", join(seeds)));
+        out.append(option::MessageFormat::format("    inline constexpr std::uint32_t slots[] = {{ {0} }};\n", join(slots)));
+        out.append(option::MessageFormat::format("    inline constexpr option::StaticSchema<{0}> schema(options, seeds, slots);\n\n", list.size()));
+        out.append("    // optionごとの説明と引数の型(引数のないoptionは空、別名は対象のoptionと同じ)\n");
+        out.append("    inline constexpr std::string_view descriptions[] = {\n");
+        for (const auto& e : list) out.append("        ").append(literal(e.description)).append(",\n");
+        out.append("    };\n    inline constexpr std::string_view types[] = {\n");
+        for (const auto& e : list) out.append("        ").append(literal(e.type)).append(",\n");
+        out.append("    };\n\n");
+        out.append("    /// <summary>\n");
+        out.append("    /// コマンドライン引数を解析し、optionのインデックスと引数の組を順に通知する(StaticSchema::parseを参照)\n");
+        out.append("    /// </summary>\n");
+        out.append("    template <class F>\n");
+        out.append("    int parse(int argc, const char* argv[], F&& f) { return schema.parse(argc, argv, std::forward<F>(f)); }\n");
+        out.append("}\n");
+        return out;
+    }
+}
+
+int main(int argc, const char* argv[]) {
+    option::CommandLineOption clo;
+    clo.add_options()
+        .l("namespace", option::Value<std::string>({ "generated_options" }).name("NS"), "生成する定義表の名前空間")
+        .o("o", option::Value<std::string>().name("OUTPUT"), "生成するヘッダのファイル")
+        .l("help", "この説明を表示する")
+        .u(option::Value<std::string>().name("INPUT"), "json_schemaの出力のファイル");
+
+    try {
+        clo.parse(argc - 1, argv + 1);
+        if (clo.map().luse("help")) {
+            std::cout << "usage: schema_compiler [--namespace NS] [-o OUTPUT] [INPUT]\n";
+            clo.print_description();
+            return 0;
+        }
+        std::string text;
+        if (!clo.map().unnamed_options(0)) {
+            text.assign(std::istreambuf_iterator<char>(std::cin), std::istreambuf_iterator<char>());
+        }
+        else {
+            const auto input = clo.map().unnamed_options(0).as<std::string>();
+            std::ifstream in(input, std::ios::binary);
+            if (!in) throw std::runtime_error(option::MessageFormat::format("{0} を開けません", input));
+            text.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        }
+
+        std::deque<std::string> names;
+        const auto list = entries(JsonReader(text).document(), names);
+        if (list.empty()) throw std::runtime_error("optionが定義されていません");
+        const auto header = generate(list, clo.map().luse("namespace").as<std::string>());
+
+        if (!clo.map().ouse("o")) {
+            std::cout << header;
+        }
+        else {
+            const auto output = clo.map().ouse("o").as<std::string>();
+            std::ofstream out(output, std::ios::binary);
+            if (!(out << header)) throw std::runtime_error(option::MessageFormat::format("{0} に書き込めません", output));
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}